@@ -367,6 +367,52 @@ public:
 		return shift(Direction::LEFT) | shift(Direction::RIGHT);
 	}
 
+	// The bits themselves and all the bits above them on the same files
+	CM_PURE constexpr BitBoard northFill() const noexcept {
+		u64 result = m_value;
+		result |= result << 8;
+		result |= result << 16;
+		result |= result << 32;
+
+		return result;
+	}
+
+	// The bits themselves and all the bits below them on the same files
+	CM_PURE constexpr BitBoard southFill() const noexcept {
+		u64 result = m_value;
+		result |= result >> 8;
+		result |= result >> 16;
+		result |= result >> 32;
+
+		return result;
+	}
+
+	// All the bits of the files that have at least one bit set
+	CM_PURE constexpr BitBoard fileFill() const noexcept {
+		return northFill() | southFill();
+	}
+
+	// The bits ahead of the bits from the side's POV (not including the bits themselves)
+	template<Color::Value Side>
+	CM_PURE constexpr BitBoard frontSpan() const noexcept {
+		if constexpr (Side == Color::WHITE) {
+			return northFill().shift(Direction::UP);
+		} else { // Black
+			return southFill().shift(Direction::DOWN);
+		}
+	}
+
+	// The bits behind the bits from the side's POV (not including the bits themselves)
+	template<Color::Value Side>
+	CM_PURE constexpr BitBoard rearSpan() const noexcept {
+		return frontSpan<Color(Side).getOpposite().value()>();
+	}
+
+	// The first rank bits for the files that have at least one bit set
+	CM_PURE constexpr u8 fileProjection() const noexcept {
+		return u8(southFill().m_value);
+	}
+
 	CM_PURE static BitBoard pawnAttacks(const Color color, const Square sq) noexcept {
 		return s_pawnAttacks[color][sq];
 	}
@@ -21,9 +21,11 @@
 
 #include "Utils/ConsoleColor.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Profiler.h"
 
 Board::Board() noexcept
 	: m_material { 0, 0 },
+	m_materialKey(0),
 	m_score { Score(), Score() },
 	m_moveCount(1),
 	m_side(Color::WHITE) {
@@ -46,6 +48,7 @@ Board::Board() noexcept
 Board::Board(Board&& other) noexcept
 	: m_states(std::move(other.m_states)),
 	m_material { other.m_material[0], other.m_material[1] },
+	m_materialKey(other.m_materialKey),
 	m_score { other.m_score[0], other.m_score[1] },
 	m_moveCount(other.moveCount()),
 	m_side(other.side()) {
@@ -73,6 +76,24 @@ void Board::operator=(Board&& other) noexcept {
 	memset(&other, 0, sizeof(Board));
 }
 
+Board Board::copy() const noexcept {
+	Board result;
+	result.m_states = m_states;
+	result.m_material[0] = m_material[0];
+	result.m_material[1] = m_material[1];
+	result.m_materialKey = m_materialKey;
+	result.m_score[0] = m_score[0];
+	result.m_score[1] = m_score[1];
+	result.m_moveCount = m_moveCount;
+	result.m_side = m_side;
+
+	memcpy(result.m_board, m_board, sizeof(m_board));
+	memcpy(result.m_pieces, m_pieces, sizeof(m_pieces));
+	memcpy(result.m_piecesByColor, m_piecesByColor, sizeof(m_piecesByColor));
+
+	return result;
+}
+
 Board Board::makeInitialPosition() noexcept {
 	bool _;
 	return fromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -", _);
@@ -105,6 +126,7 @@ Board Board::fromFEN(std::string_view fen, bool& success) {
 		result.byPiece(piece).set(sq);
 		result.byColor(piece.getColor()).set(sq);
 		result.materialByColor(piece.getColor()) += Material::materialOf(piece.getType());
+		result.materialKey() += Board::materialKeyOf(piece);
 		result.scoreByColor(piece.getColor()) += scores::PST[piece][sq];
 		result.hash() ^= zobrist::PIECE[piece][sq];
 
@@ -170,6 +192,43 @@ Board Board::fromFEN(std::string_view fen, bool& success) {
 	return result;
 }
 
+Board Board::fromPieces(const Piece* pieces, const Square* squares, const u8 count, const Color side) noexcept {
+	Board result;
+	result.setPieces(pieces, squares, count, side);
+
+	return result;
+}
+
+void Board::setPieces(const Piece* pieces, const Square* squares, const u8 count, const Color side) noexcept {
+	memset(m_board, 0, sizeof(m_board));
+	memset(m_pieces, 0, sizeof(m_pieces));
+	memset(m_piecesByColor, 0, sizeof(m_piecesByColor));
+	m_material[Color::WHITE] = m_material[Color::BLACK] = 0;
+	m_score[Color::WHITE] = m_score[Color::BLACK] = Score();
+	m_materialKey = 0;
+
+	m_states.resize(1);
+	m_states[0] = StateInfo();
+
+	for (u8 i = 0; i < count; i++) {
+		const Piece piece = pieces[i];
+		const Square sq = squares[i];
+
+		m_board[sq] = piece;
+		byPiece(piece).set(sq);
+		byColor(piece.getColor()).set(sq);
+		materialByColor(piece.getColor()) += Material::materialOf(piece.getType());
+		materialKey() += Board::materialKeyOf(piece);
+		scoreByColor(piece.getColor()) += scores::PST[piece][sq];
+		hash() ^= zobrist::PIECE[piece][sq];
+	}
+
+	m_side = side;
+	hash() ^= zobrist::SIDE[side];
+	moveCount() = side.getOpposite();
+	initInternalState();
+}
+
 std::string Board::toFEN() const noexcept {
 	std::string result;
 	result.reserve(72); // 72 is enough for almost any possible position, 87 would suffice for absolutely any position
@@ -284,6 +343,164 @@ Move Board::makeMoveFromString(std::string_view str) const noexcept {
 	return Move::makeNullMove();
 }
 
+Move Board::makeMoveFromSAN(std::string_view san) const noexcept {
+	// Check marks and annotations
+	while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+		san.remove_suffix(1);
+	}
+
+	if (san.size() < 2) {
+		return Move::makeNullMove(); // Corrupted move string
+	}
+
+	const Square kingSq = king(m_side);
+	const BitBoard occ = allPieces();
+
+	// Castlings
+	if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+		const Castle castle = san.size() == 3 ? Castle::KING_CASTLE : Castle::QUEEN_CASTLE;
+		if (isInCheck()
+			|| !Castle::hasCastleRight(state().castleRight, castle, m_side)
+			|| (BitBoard::castlingInternalSquares(m_side, castle) & occ) != 0) {
+			return Move::makeNullMove();
+		}
+
+		const File kingTo = castle == Castle::KING_CASTLE ? File::G : File::C;
+		const Move m = Move(kingSq, Square(kingTo, Rank::makeRelativeRank(m_side, Rank::R1)), MoveType::CASTLE);
+		return isLegal(m) ? m : Move::makeNullMove();
+	}
+
+	// Promotion, either as "e8=Q" or "e8Q"
+	PieceType promoted = PieceType::NONE;
+	if (const char last = san.back(); last >= 'A' && last <= 'Z') {
+		promoted = Piece::fromFENChar(last).getType();
+		san.remove_suffix(san[san.size() - 2] == '=' ? 2 : 1);
+
+		if (promoted == PieceType::NONE || promoted == PieceType::PAWN || promoted == PieceType::KING || san.size() < 2) {
+			return Move::makeNullMove();
+		}
+	}
+
+	// Moving piece type
+	PieceType pt = PieceType::PAWN;
+	if (san[0] >= 'A' && san[0] <= 'Z') {
+		pt = Piece::fromFENChar(san[0]).getType();
+		san.remove_prefix(1);
+
+		if (pt == PieceType::NONE || promoted != PieceType::NONE) {
+			return Move::makeNullMove();
+		}
+	}
+
+	// Target square
+	if (san.size() < 2) {
+		return Move::makeNullMove();
+	}
+
+	const char toFile = san[san.size() - 2];
+	const char toRank = san[san.size() - 1];
+	if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8') {
+		return Move::makeNullMove();
+	}
+
+	const Square to = Square::fromChars(toFile, toRank);
+	if (byColor(m_side).test(to)) {
+		return Move::makeNullMove();
+	}
+
+	// Disambiguation and the capture sign
+	BitBoard fromMask = ~BitBoard::EMPTY;
+	bool isCapture = false;
+	for (const char ch : san.substr(0, san.size() - 2)) {
+		if (ch >= 'a' && ch <= 'h') {
+			fromMask = fromMask.b_and(BitBoard::fromFile(File::fromFENChar(ch)));
+		} else if (ch >= '1' && ch <= '8') {
+			fromMask = fromMask.b_and(BitBoard::fromRank(Rank::fromFENChar(ch)));
+		} else if (ch == 'x' || ch == ':') {
+			isCapture = true;
+		} else {
+			return Move::makeNullMove();
+		}
+	}
+
+	// Candidates are the pieces of that type that could get to the target square
+	const Color opposite = m_side.getOpposite();
+	const bool isLastRank = to.getRank() == Rank::makeRelativeRank(m_side, Rank::R8);
+	MoveType mt = MoveType::SIMPLE;
+	BitBoard candidates = BitBoard::EMPTY;
+	if (pt == PieceType::PAWN) {
+		if (isLastRank != (promoted != PieceType::NONE)) {
+			return Move::makeNullMove();
+		}
+
+		if (isCapture || fromMask != ~BitBoard::EMPTY) {
+			if (to == state().ep) {
+				mt = MoveType::ENPASSANT;
+			} else if (!byColor(opposite).test(to)) {
+				return Move::makeNullMove();
+			}
+
+			candidates = BitBoard::pawnAttacks(opposite, to).b_and(pawns(m_side));
+		} else if (!occ.test(to)) {
+			const Square oneBack = m_side == Color::WHITE ? to.backward(8) : to.forward(8);
+			if (pawns(m_side).test(oneBack)) {
+				candidates = BitBoard::fromSquare(oneBack);
+			} else if (!occ.test(oneBack) && to.getRank() == Rank::makeRelativeRank(m_side, Rank::R4)) {
+				const Square twoBack = m_side == Color::WHITE ? to.backward(16) : to.forward(16);
+				candidates = pawns(m_side).b_and(BitBoard::fromSquare(twoBack));
+			}
+		}
+
+		if (promoted != PieceType::NONE) {
+			mt = MoveType::PROMOTION;
+		}
+	} else {
+		candidates = BitBoard::attacksOf(pt, to, occ).b_and(byPiece(Piece(m_side, pt)));
+	}
+
+	candidates = candidates.b_and(fromMask);
+
+	// The only legal move among the candidates
+	Move result = Move::makeNullMove();
+	BB_FOR_EACH(from, candidates) {
+		const Move m = mt == MoveType::PROMOTION
+			? Move(from, to, MoveType::PROMOTION, promoted)
+			: Move(from, to, mt);
+
+		if (isLegalEvasion(m)) {
+			if (!result.isNullMove()) {
+				return Move::makeNullMove(); // Ambiguous move
+			}
+
+			result = m;
+		}
+	}
+
+	return result;
+}
+
+bool Board::isLegalEvasion(const Move m) const noexcept {
+	if (!isLegal(m)) {
+		return false;
+	} else if (!isInCheck() || m_board[m.getFrom()].getType() == PieceType::KING) {
+		return true;
+	} else if (checkGivers().hasMoreThanOne()) {
+		return false; // Only the king can evade a double check
+	}
+
+	// The checking piece must be captured or the check blocked
+	const Square kingSq = king(m_side);
+	const Square checker = checkGivers().lsb();
+	if (m.getMoveType() == MoveType::ENPASSANT) {
+		const Square capturedSq = m_side == Color::WHITE ? m.getTo().backward(8) : m.getTo().forward(8);
+		if (capturedSq == checker) {
+			return true;
+		}
+	}
+
+	return BitBoard::betweenBits(kingSq, checker).test(m.getTo());
+}
+
 bool Board::isLegal(const Move m) const noexcept {
 	const Square from = m.getFrom();
 	const Square to = m.getTo();
@@ -327,6 +544,8 @@ bool Board::isLegal(const Move m) const noexcept {
 }
 
 void Board::makeMove(const Move m) noexcept {
+	PROFILE_ZONE(MAKE_MOVE);
+
 	return m_side == Color::BLACK
 		? makeMove<Color::BLACK>(m)
 		: makeMove<Color::WHITE>(m);
@@ -436,6 +655,8 @@ void Board::makeMove(const Move m) noexcept {
 }
 
 void Board::unmakeMove(const Move m) noexcept {
+	PROFILE_ZONE(UNMAKE_MOVE);
+
 	return m_side == Color::BLACK
 		? unmakeMove<Color::WHITE>(m)
 		: unmakeMove<Color::BLACK>(m);
@@ -474,6 +695,8 @@ void Board::unmakeMove(const Move m) noexcept  {
 
 template<movegen::GenerationMode Mode>
 void Board::generateMoves(MoveList& moves) const noexcept {
+	PROFILE_ZONE(MOVE_GENERATION);
+
 	if constexpr (Mode == movegen::QUIET_CHECKS) {
 		high_assert(!isInCheck());
 
@@ -694,6 +917,8 @@ std::ostream& operator<<(std::ostream& out, const Board& board) noexcept {
 }
 
 Value Board::SEE(const Move m) const noexcept {
+	PROFILE_ZONE(SEE);
+
 	const Square to = m.getTo();
 	Square from = m.getFrom();
 	BitBoard occ = allPieces();
@@ -64,6 +64,7 @@ private:
 	std::vector<StateInfo> m_states;
 
 	i32 m_material[Color::VALUES_COUNT];
+	u64 m_materialKey; // The count of every piece, 4 bits per piece (see materialKeyOf)
 	Score m_score[Color::VALUES_COUNT]; // Scores according to scores::PST
 	u32 m_moveCount;
 
@@ -79,6 +80,10 @@ public:
 
 	void operator=(Board&& other) noexcept;
 
+	// The board is not copied implicitly, as the states history makes it expensive
+	// The copy has the same history, so the repetitions are found in it as well
+	Board copy() const noexcept;
+
 
 	///  FEN  ///
 
@@ -86,6 +91,12 @@ public:
 
 	// Creates a board from the Forsyth-Edwards Notation
 	static Board fromFEN(std::string_view fen, bool& success);
+
+	// Creates a board with only the given pieces, without castling rights and en passant
+	static Board fromPieces(const Piece* pieces, const Square* squares, const u8 count, const Color side) noexcept;
+
+	// The same as fromPieces, but reuses the board's memory
+	void setPieces(const Piece* pieces, const Square* squares, const u8 count, const Color side) noexcept;
 	std::string toFEN() const noexcept;
 
 
@@ -94,6 +105,11 @@ public:
 	// Returns null move if the move is illegal
 	Move makeMoveFromString(std::string_view str) const noexcept;
 
+	// Parses a move in the standard algebraic notation (e.g. "Nbd7", "exd6", "e8=Q+", "O-O"), the moving piece
+	// is found among the attackers of the target square without generating the moves
+	// Returns null move if the move is illegal or ambiguous
+	Move makeMoveFromSAN(std::string_view san) const noexcept;
+
 
 	///  OPERATORS  ///
 
@@ -116,6 +132,9 @@ public:
 
 	// Checks if a pseudo-legal move is legal
 	bool isLegal(const Move m) const noexcept;
+
+	// Checks if a pseudo-legal move is legal, but unlike isLegal does not suppose that the move evades the check
+	bool isLegalEvasion(const Move m) const noexcept;
 	void makeMove(const Move m) noexcept;
 
 	template<Color::Value Side>
@@ -215,6 +234,20 @@ public:
 		return lowMaterialDraw() || fiftyRuleDraw() || repetitionDraw(ply);
 	}
 
+	// Checks if the side to move has at least one legal move (i.e. it is neither a mate nor a stalemate)
+	// It is slow, since it uses movegen and checks all the moves
+	CM_PURE bool hasLegalMoves() const noexcept {
+		MoveList ml;
+		generateMoves(ml);
+		for (Move m : ml) {
+			if (isLegal(m)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	// Checks if the game has reached an end
 	// Returns NONE if there is no result yet
 	// Note: this function is not supposed to be used in search
@@ -224,12 +257,8 @@ public:
 			return GameResult::DRAW;
 		}
 
-		MoveList ml;
-		generateMoves(ml);
-		for (Move m : ml) {
-			if (isLegal(m)) {
-				return GameResult::NONE; // There is a legal move
-			}
+		if (hasLegalMoves()) {
+			return GameResult::NONE;
 		}
 
 		// If the side has no legal moves, it is a game end
@@ -470,6 +499,19 @@ public:
 		return m_material[color];
 	}
 
+	CM_PURE constexpr u64& materialKey() noexcept {
+		return m_materialKey;
+	}
+
+	CM_PURE constexpr u64 materialKey() const noexcept {
+		return m_materialKey;
+	}
+
+	// The value added to the material key for a single piece
+	CM_PURE constexpr static u64 materialKeyOf(const Piece piece) noexcept {
+		return u64(1) << (4 * piece);
+	}
+
 	CM_PURE Hash computeHash() const noexcept {
 		return hash()
 			^ zobrist::SIDE[m_side]
@@ -606,6 +648,7 @@ private:
 		m_piecesByColor[Side].set(to);
 		m_score[Side] += scores::PST[piece][to];
 		m_material[Side] += Material::materialOf(piece.getType());
+		m_materialKey += materialKeyOf(piece);
 	}
 
 	// Removes a piece from the board
@@ -617,6 +660,7 @@ private:
 		m_piecesByColor[Side].clear(from);
 		m_score[Side] -= scores::PST[piece][from];
 		m_material[Side] -= Material::materialOf(piece.getType());
+		m_materialKey -= materialKeyOf(piece);
 	}
 
 	// Moves a piece on the board
@@ -652,6 +696,7 @@ private:
 			m_piecesByColor[OppositeSide].clear(to);
 			m_score[OppositeSide] -= scores::PST[captured][to];
 			m_material[OppositeSide] -= Material::materialOf(captured.getType());
+			m_materialKey -= materialKeyOf(captured);
 		}
 
 		return captured;
@@ -676,6 +721,7 @@ private:
 			m_piecesByColor[OppositeSide].set(to);
 			m_score[OppositeSide] += scores::PST[captured][to];
 			m_material[OppositeSide] += Material::materialOf(captured.getType());
+			m_materialKey += materialKeyOf(captured);
 		}
 	}
 
@@ -704,6 +750,7 @@ private:
 			m_piecesByColor[OppositeSide].clear(capturedSq);
 			m_score[OppositeSide] -= scores::PST[OppositePawn][capturedSq];
 			m_material[OppositeSide] -= Material::materialOf(PieceType::PAWN);
+			m_materialKey -= materialKeyOf(OppositePawn);
 		} else {
 			m_board[from] = OurPawn;
 			m_board[to] = Piece::NONE;
@@ -716,6 +763,7 @@ private:
 			m_piecesByColor[OppositeSide].set(capturedSq);
 			m_score[OppositeSide] += scores::PST[OppositePawn][capturedSq];
 			m_material[OppositeSide] += Material::materialOf(PieceType::PAWN);
+			m_materialKey += materialKeyOf(OppositePawn);
 		}
 	}
 
@@ -734,6 +782,7 @@ private:
 			m_piecesByColor[Side] = m_piecesByColor[Side].b_xor(change);
 			m_score[Side] += scores::PST[promoted][to] - scores::PST[OurPawn][from];
 			m_material[Side] += Material::materialOf(promoted.getType()) - Material::materialOf(PieceType::PAWN);
+			m_materialKey += materialKeyOf(promoted) - materialKeyOf(OurPawn);
 		} else {
 			m_board[to] = Piece::NONE;
 			m_board[from] = OurPawn;
@@ -742,6 +791,7 @@ private:
 			m_piecesByColor[Side] = m_piecesByColor[Side].b_xor(change);
 			m_score[Side] -= scores::PST[promoted][to] - scores::PST[OurPawn][from];
 			m_material[Side] -= Material::materialOf(promoted.getType()) - Material::materialOf(PieceType::PAWN);
+			m_materialKey -= materialKeyOf(promoted) - materialKeyOf(OurPawn);
 		}
 	}
 
@@ -762,12 +812,14 @@ private:
 		m_piecesByColor[Side] = m_piecesByColor[Side].b_xor(change);
 		m_score[Side] += scores::PST[promoted][to] - scores::PST[OurPawn][from];
 		m_material[Side] += Material::materialOf(promoted.getType()) - Material::materialOf(PieceType::PAWN);
+		m_materialKey += materialKeyOf(promoted) - materialKeyOf(OurPawn);
 
 		if (captured != Piece::NONE) {
 			m_pieces[captured].clear(to);
 			m_piecesByColor[OppositeSide].clear(to);
 			m_score[OppositeSide] -= scores::PST[captured][to];
 			m_material[OppositeSide] -= Material::materialOf(captured.getType());
+			m_materialKey -= materialKeyOf(captured);
 		}
 
 		return captured;
@@ -789,12 +841,14 @@ private:
 		m_piecesByColor[Side] = m_piecesByColor[Side].b_xor(change);
 		m_score[Side] -= scores::PST[promoted][to] - scores::PST[OurPawn][from];
 		m_material[Side] -= Material::materialOf(promoted.getType()) - Material::materialOf(PieceType::PAWN);
+		m_materialKey -= materialKeyOf(promoted) - materialKeyOf(OurPawn);
 
 		if (captured != Piece::NONE) {
 			m_pieces[captured].set(to);
 			m_piecesByColor[OppositeSide].set(to);
 			m_score[OppositeSide] += scores::PST[captured][to];
 			m_material[OppositeSide] += Material::materialOf(captured.getType());
+			m_materialKey += materialKeyOf(captured);
 		}
 	}
 
@@ -331,6 +331,11 @@ public:
 	CM_PURE constexpr Square mirrorByFile() const noexcept {
 		return Square(m_value ^ 0x7);
 	}
+
+	// Mirrors the square by the a1-h8 diagonal
+	CM_PURE constexpr Square mirrorByDiagonal() const noexcept {
+		return Square(((m_value & 0x7) << 3) | (m_value >> 3));
+	}
 	
 	// Advances the square for <value> positions forward
 	CM_PURE constexpr Square forward(const u8 value = 1) const noexcept {
@@ -25,6 +25,8 @@
 *	one for the opening/middlegame and the other for endgame.
 * 
 *	Score is expected to be used for temporary values during evaluetion.
+*	Both values are packed into a single 32-bit integer, so the operations on
+*	the scores cost as much as on plain integers.
 * 
 *	Additionally, there is an auxiliary class Material that allows to account
 *	the material for collapsing the Score. Generally, it just clamps the amount
@@ -72,76 +74,80 @@ public:
 
 class Score final {
 private:
-	union {
-		i32 m_asI32;
-		struct {
-			Value m_middlegameValue;
-			Value m_endgameValue;
-		};
-	};
+	// Both values are packed as (endgame << 16) + middlegame, so that the whole
+	// pair is added/subtracted with a single integer operation.
+	// The arithmetic is done on the unsigned integers so as to avoid signed overflow
+	i32 m_value;
+
+	CM_PURE constexpr static i32 pack(const Value middlegame, const Value endgame) noexcept {
+		return i32((u32(i32(endgame)) << 16) + u32(i32(middlegame)));
+	}
 
 public:
-	INLINE constexpr Score() noexcept : m_asI32(0) { }
-	INLINE constexpr Score(const Score& other) noexcept : m_asI32(other.m_asI32) { }
-	INLINE constexpr explicit Score(const u32 asI32) noexcept : m_asI32(asI32) { }
+	INLINE constexpr Score() noexcept : m_value(0) { }
+	INLINE constexpr Score(const Score& other) noexcept : m_value(other.m_value) { }
+	INLINE constexpr explicit Score(const u32 packed) noexcept : m_value(i32(packed)) { }
 	INLINE constexpr Score(const Value middlegame, const Value endgame) noexcept
-		: m_middlegameValue(middlegame), m_endgameValue(endgame) { }
+		: m_value(pack(middlegame, endgame)) { }
 
 	INLINE constexpr Score& operator=(const Score other) noexcept {
-		m_asI32 = other.m_asI32;
+		m_value = other.m_value;
 		return *this;
 	}
 
 	CM_PURE constexpr bool operator==(const Score other) const noexcept {
-		return m_asI32 == other.m_asI32;
+		return m_value == other.m_value;
 	}
 
 	CM_PURE constexpr Score operator-() const noexcept {
-		return Score(-m_middlegameValue, -m_endgameValue);
+		return Score(0u - u32(m_value));
 	}
 
 	CM_PURE constexpr Score operator+(const Score other) const noexcept {
-		return Score(m_middlegameValue + other.m_middlegameValue, m_endgameValue + other.m_endgameValue);
+		return Score(u32(m_value) + u32(other.m_value));
 	}
 
 	CM_PURE constexpr Score operator-(const Score other) const noexcept {
-		return Score(m_middlegameValue - other.m_middlegameValue, m_endgameValue - other.m_endgameValue);
+		return Score(u32(m_value) - u32(other.m_value));
 	}
 
 	CM_PURE constexpr Score operator*(const i32 value) const noexcept {
-		return Score(m_middlegameValue * value, m_endgameValue * value);
+		return Score(u32(m_value) * u32(value));
 	}
 
 	INLINE constexpr Score& operator+=(const Score other) noexcept {
-		m_middlegameValue += other.m_middlegameValue;
-		m_endgameValue += other.m_endgameValue;
+		m_value = i32(u32(m_value) + u32(other.m_value));
 		return *this;
 	}
 
 	INLINE constexpr Score& operator-=(const Score other) noexcept {
-		m_middlegameValue -= other.m_middlegameValue;
-		m_endgameValue -= other.m_endgameValue;
+		m_value = i32(u32(m_value) - u32(other.m_value));
 		return *this;
 	}
 
+	CM_PURE constexpr u32 packed() const noexcept {
+		return u32(m_value);
+	}
+
 	CM_PURE constexpr Value middlegame() const noexcept {
-		return m_middlegameValue;
+		return Value(u16(u32(m_value)));
 	}
 
+	// The middlegame value borrows from the endgame one when negative, so 0x8000 compensates it
 	CM_PURE constexpr Value endgame() const noexcept {
-		return m_endgameValue;
+		return Value(u16((u32(m_value) + 0x8000) >> 16));
 	}
 
-	CM_PURE Value* middlegamePtr() noexcept {
-		return &m_middlegameValue;
+	INLINE constexpr void setMiddlegame(const Value middlegame) noexcept {
+		m_value = pack(middlegame, endgame());
 	}
 
-	CM_PURE Value* endgamePtr() noexcept {
-		return &m_endgameValue;
+	INLINE constexpr void setEndgame(const Value endgame) noexcept {
+		m_value = pack(middlegame(), endgame);
 	}
 
 	CM_PURE constexpr Value collapse(const Material material) const noexcept {
-		return material.interpolate(m_middlegameValue, m_endgameValue);
+		return material.interpolate(middlegame(), endgame());
 	}
 };
 
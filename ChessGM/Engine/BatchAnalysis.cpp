@@ -0,0 +1,277 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "BatchAnalysis.h"
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "Options.h"
+#include "Utils/IO.h"
+#include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+
+namespace engine {
+	// The last completed iteration of the current thread's search
+	struct BatchIteration final {
+		Value value = 0;
+		Depth depth = 0;
+		std::string pv; // As a JSON array
+	};
+
+	static thread_local BatchIteration s_lastIteration;
+
+	static void onIteration(const SearchResult& result, const Depth depth, const MoveList& pv) {
+		s_lastIteration.value = result.value;
+		s_lastIteration.depth = depth;
+		s_lastIteration.pv.clear();
+
+		for (Move move : pv) {
+			s_lastIteration.pv.append(s_lastIteration.pv.empty() ? "\"" : ",\"").append(move.toString()).append("\"");
+		}
+	}
+
+	// Appends the string as a JSON string
+	static void appendJSONString(std::string& out, const std::string_view str) {
+		out += '"';
+		for (const char ch : str) {
+			if (ch == '"' || ch == '\\') {
+				out += '\\';
+			}
+
+			if (u8(ch) >= 0x20) {
+				out += ch;
+			}
+		}
+
+		out += '"';
+	}
+
+	// Board::fromFEN expects a well-formed FEN, so the input lines are checked beforehand:
+	// 8 ranks of 8 squares, a king of each color, the side to move, castling rights and en passant square
+	static bool isWellFormedFEN(const std::string_view fen) {
+		const std::vector<std::string_view> fields = str_utils::split(fen, " ");
+		if (fields.size() < 4 || fields.size() > 6) {
+			return false;
+		}
+
+		u32 ranks = 1;
+		u32 files = 0;
+		u32 kings[Color::VALUES_COUNT] = { 0, 0 };
+		for (const char ch : fields[0]) {
+			if (ch == '/') {
+				if (files != 8) {
+					return false;
+				}
+
+				ranks++;
+				files = 0;
+			} else if (ch >= '1' && ch <= '8') {
+				files += ch - '0';
+			} else if (std::string_view("pnbrqkPNBRQK").find(ch) != std::string_view::npos) {
+				files++;
+				kings[Color::WHITE] += ch == 'K';
+				kings[Color::BLACK] += ch == 'k';
+			} else {
+				return false;
+			}
+
+			if (files > 8) {
+				return false;
+			}
+		}
+
+		return ranks == 8 && files == 8 && kings[Color::WHITE] == 1 && kings[Color::BLACK] == 1
+			&& (fields[1] == "w" || fields[1] == "b")
+			&& (fields[2] == "-" || fields[2].find_first_not_of("KQkq") == std::string_view::npos)
+			&& (fields[3] == "-" || (fields[3].size() == 2 && fields[3][0] >= 'a' && fields[3][0] <= 'h' && (fields[3][1] == '3' || fields[3][1] == '6')));
+	}
+
+	BatchReport BatchAnalysis::run(std::istream& input, std::ostream& output, const BatchSettings& settings) {
+		const bool wasPostMode = options::g_postMode;
+		const Limits oldLimits = g_limits;
+
+		options::g_postMode = false;
+
+		std::mutex inputMutex;
+		std::mutex outputMutex;
+		u64 nextId = 0;
+
+		BatchReport report;
+		const auto start = std::chrono::steady_clock::now();
+
+		ThreadPool pool(std::max(settings.threadsCount, 1u));
+		pool.run([&](const u32 threadId) {
+			// Each thread works with its own search state and its own part of the transposition table,
+			// so the thread 0 (the calling one) must not start the Lazy SMP helpers over the whole table
+			const u32 oldThreadsCount = g_threadsCount;
+			g_threadsCount = 1;
+			g_isInputChecked = false;
+			g_onIteration = onIteration;
+			TranspositionTable::useSlice(threadId, pool.threadsCount());
+			TranspositionTable::clear();
+			initSearch();
+
+			std::string fen;
+			std::string line;
+			NodesCount nodes = 0;
+			while (true) {
+				u64 id;
+				{
+					std::lock_guard<std::mutex> lock(inputMutex);
+					do {
+						if (!std::getline(input, fen)) {
+							fen.clear();
+							break;
+						}
+
+						// Trimming, the empty lines and the comments are skipped
+						fen.erase(0, std::min(fen.find_first_not_of(" \t\r"), fen.size()));
+						fen.erase(fen.find_last_not_of(" \t\r") + 1);
+					} while (fen.empty() || fen[0] == '#');
+
+					if (fen.empty()) {
+						break;
+					}
+
+					id = nextId++;
+				}
+
+				line = "{\"id\":" + std::to_string(id) + ",\"fen\":";
+				appendJSONString(line, fen);
+
+				// The move counters are optional
+				if (str_utils::split(fen, " ").size() == 4) {
+					fen += " 0 1";
+				}
+
+				bool success = isWellFormedFEN(fen);
+				Board board = success ? Board::fromFEN(fen, success) : Board();
+				if (success) {
+					s_lastIteration = BatchIteration();
+					g_limits.makeFixed(settings.limitType, settings.limit); // Also starts the timer
+
+					// The search expects at least one legal move, checkmates and stalemates are scored right away
+					SearchResult result { .best = Move::makeNullMove(), .value = 0 };
+					g_nodesCount = 0;
+					if (board.hasLegalMoves()) {
+						result = rootSearch(board);
+						nodes += g_nodesCount;
+					} else if (board.isInCheck()) {
+						s_lastIteration.value = -MATE;
+					}
+
+					line += ",\"bestmove\":" + (result.best.isNullMove() ? "null" : "\"" + result.best.toString() + "\"") + ",\"score\":{";
+					if (isMateValue(s_lastIteration.value)) {
+						line += "\"mate\":" + std::to_string(s_lastIteration.value < 0 ? -gettingMatedIn(s_lastIteration.value) : givingMateIn(s_lastIteration.value));
+					} else {
+						line += "\"cp\":" + std::to_string(s_lastIteration.value);
+					}
+
+					line += "},\"depth\":" + std::to_string(s_lastIteration.depth)
+						+ ",\"nodes\":" + std::to_string(g_nodesCount)
+						+ ",\"time\":" + std::to_string(g_limits.elapsedMilliseconds())
+						+ ",\"pv\":[" + s_lastIteration.pv + "]}\n";
+				} else {
+					line += ",\"error\":\"illegal position\"}\n";
+				}
+
+				std::lock_guard<std::mutex> lock(outputMutex);
+				output << line << std::flush;
+			}
+
+			std::lock_guard<std::mutex> lock(outputMutex);
+			report.nodes += nodes;
+
+			g_threadsCount = oldThreadsCount;
+			g_isInputChecked = true;
+			g_onIteration = nullptr;
+			TranspositionTable::useWholeTable();
+		});
+
+		report.positions = nextId;
+		report.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+		options::g_postMode = wasPostMode;
+		g_limits = oldLimits;
+
+		return report;
+	}
+
+	void BatchAnalysis::print(const std::vector<std::string>& args) {
+		if (args[0] == "-" && io::isInputThreadStarted()) {
+			io::g_out << io::Color::Red << "The positions can be read from stdin only by ChessGM batch, use a file here" << std::endl;
+			return;
+		}
+
+		BatchSettings settings;
+		if (args.size() > 1) {
+			if (!Limits::parseLimitType(args[1], settings.limitType)) {
+				io::g_out << io::Color::Red << "Unknown limit: " << args[1] << std::endl;
+				return;
+			}
+
+			settings.limit = settings.limitType == LimitType::DEPTH ? 10 : settings.limitType == LimitType::NODES ? 1000000 : 1000;
+		}
+
+		if (args.size() > 2) {
+			settings.limit = str_utils::fromString<u64>(args[2]);
+		}
+
+		settings.threadsCount = args.size() > 3
+			? str_utils::fromString<u32>(args[3])
+			: std::max(std::thread::hardware_concurrency(), 1u);
+
+		std::ifstream inputFile;
+		if (args[0] != "-") {
+			inputFile.open(args[0]);
+			if (!inputFile) {
+				io::g_out << io::Color::Red << "Failed to read the file " << args[0] << std::endl;
+				return;
+			}
+		}
+
+		std::ofstream outputFile;
+		if (args.size() > 4) {
+			outputFile.open(args[4]);
+			if (!outputFile) {
+				io::g_out << io::Color::Red << "Failed to open the file " << args[4] << std::endl;
+				return;
+			}
+		}
+
+		std::istream& input = args[0] == "-" ? std::cin : inputFile;
+		std::ostream& output = args.size() > 4 ? outputFile : std::cout;
+		const BatchReport report = run(input, output, settings);
+		const u64 positionsPerSecond = report.positions * 1000 / std::max(report.time, u64(1));
+
+		if (args.size() > 4) {
+			io::g_out << "Positions: " << io::Color::Blue << report.positions << std::endl
+				<< "Time: " << io::Color::Blue << report.time << io::Color::White << " milliseconds" << std::endl
+				<< "Positions per second: " << io::Color::Blue << positionsPerSecond << std::endl
+				<< "NPS: " << io::Color::Blue << report.nodes * 1000 / std::max(report.time, u64(1)) << std::endl;
+		} else { // Keeping the output in JSON lines
+			std::cout << "{\"positions\":" << report.positions << ",\"time\":" << report.time 
+				<< ",\"positionsPerSecond\":" << positionsPerSecond << ",\"nodes\":" << report.nodes << '}' << std::endl;
+		}
+	}
+}
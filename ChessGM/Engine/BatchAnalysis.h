@@ -0,0 +1,63 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+#include "Limits.h"
+
+/*
+*	BatchAnalysis(.h/.cpp) contains the analysis of many positions at once, e.g. for a data pipeline.
+* 
+*	The FENs are read line by line from a file or the standard input and searched with a fixed
+*	limit (time, depth or nodes) by several worker threads, each with its own search state and its
+*	own slice of the transposition table. The table is not cleared between the positions.
+*	The result of each position is written as soon as it is found, as a JSON line:
+*		{"id":0,"fen":"...","bestmove":"e2e4","score":{"cp":25},"depth":12,"nodes":123456,"time":98,"pv":["e2e4","e7e5"]}
+*	where id is the number of the line in the input, so the lines can go out of order with several threads.
+*	A position without legal moves gets "bestmove":null and the score of 0 or mate 0 (checkmate).
+*	A line that is not a correct FEN gets {"id":...,"fen":"...","error":"illegal position"}.
+*/
+
+namespace engine {
+	struct BatchSettings final {
+		LimitType limitType = LimitType::DEPTH;
+		u64 limit = 10;
+		u32 threadsCount = 1;
+	};
+
+	struct BatchReport final {
+		u64 positions = 0;
+		u64 time = 0; // The wall time in milliseconds
+		NodesCount nodes = 0;
+	};
+
+	class BatchAnalysis final {
+	public:
+		// Analyses all the FENs of the input, writes the results to the output as they come
+		static BatchReport run(std::istream& input, std::ostream& output, const BatchSettings& settings);
+
+		// Parses the arguments [fen file or "-" for stdin] [depth|nodes|time] [limit] [threads] [optional output file],
+		// runs the analysis and prints the throughput
+		static void print(const std::vector<std::string>& args);
+	};
+}
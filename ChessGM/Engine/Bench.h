@@ -0,0 +1,86 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "Utils/Types.h"
+
+/*
+*	Bench(.h/.cpp) contains the benchmark of the engine.
+* 
+*	A built-in set of positions (openings, middlegames, endgames, positions with checks and promotions)
+*	is searched to a fixed depth, each time with the cleared transposition and pawn hash tables.
+*	Since nothing is kept between the positions, the total number of nodes only depends on the search
+*	and evaluation code, so it works as a signature of the engine: a change that is not supposed to
+*	alter the search (e.g. an optimization) must keep the node count, while the speed is given by NPS.
+*	It only holds for 1 thread, as with more threads the search is not deterministic.
+* 
+*	The scaling of the parallel search is measured by running the bench with 1, 2, 4... threads: the NPS
+*	is compared with that of 1 thread, as well as the time to reach the depth (the speedup) and the number of
+*	nodes searched to reach it (the overhead of the threads doing the same work).
+*/
+
+namespace engine {
+	struct BenchSettings final {
+		Depth depth = 10;
+		u32 threadsCount = 1;
+		u32 hashSize = 16; // In megabytes
+	};
+
+	struct BenchReport final {
+		u32 positions = 0;
+		NodesCount nodes = 0;
+		u64 time = 0; // In milliseconds
+	};
+
+	struct ScalingReport final {
+		u32 threadsCount = 1;
+		BenchReport report;
+		double npsScaling = 1.0; // NPS relative to 1 thread
+		double timeToDepthSpeedup = 1.0; // The time to reach the depth with 1 thread divided by the time with these threads
+		double nodesOverhead = 0.0; // The extra nodes searched to reach the depth relative to 1 thread, e.g. 0.25 for 25%
+	};
+
+	class Bench final {
+	public:
+		// The built-in positions, they are also used by the microbenchmarks
+		static std::span<const std::string_view> positions() noexcept;
+
+		// Parses the optional arguments [depth] [threads] [hash in MB], the missing ones are left default
+		static BenchSettings parseSettings(const std::vector<std::string>& args);
+
+		// Searches all the bench positions, the limits, the options and the hash size are restored afterwards
+		static BenchReport run(const BenchSettings& settings);
+
+		// Runs the bench and prints the total nodes, time and NPS
+		static void print(const BenchSettings& settings);
+
+		// Runs the bench with 1, 2, 4... threads up to settings.threadsCount (which is also run if it is not a power of 2)
+		static std::vector<ScalingReport> runScaling(const BenchSettings& settings);
+		static void writeScalingCSV(std::ostream& out, const std::vector<ScalingReport>& reports);
+
+		// Parses the arguments [depth] [max threads] [hash in MB] [csv file], runs the scaling
+		// benchmark and prints the results as CSV, also writing them to the file if it is given
+		static void printScaling(const std::vector<std::string>& args);
+	};
+}
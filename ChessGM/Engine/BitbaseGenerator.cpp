@@ -0,0 +1,344 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "BitbaseGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+
+namespace engine {
+	// The results while generating, the final ones are the same as in BitbaseResult
+	enum GenerationState : u8 {
+		STATE_DRAW = u8(BitbaseResult::DRAW),
+		STATE_WIN = u8(BitbaseResult::WIN),
+		STATE_LOSS = u8(BitbaseResult::LOSS),
+		STATE_INVALID,
+		STATE_UNKNOWN
+	};
+
+	// Runs func(index, threadId) for every index in [0, count) on the given number of threads
+	// The indices are taken by chunks from a shared counter, so that the threads are evenly loaded
+	template<class Func>
+	void parallelFor(const u64 count, const u32 threadsCount, const u64 chunkSize, Func&& func) {
+		std::atomic<u64> next = 0;
+		const auto worker = [&](const u32 threadId) {
+			for (u64 begin; (begin = next.fetch_add(chunkSize, std::memory_order_relaxed)) < count;) {
+				const u64 end = std::min(begin + chunkSize, count);
+				for (u64 index = begin; index < end; index++) {
+					func(index, threadId);
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (u32 i = 1; i < threadsCount; i++) {
+			threads.emplace_back(worker, i);
+		}
+
+		worker(0);
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	class BitbaseGeneration final {
+	private:
+		const BitbaseMaterial& m_material;
+		const u64 m_materialKey;
+		const u64 m_positionsCount;
+		const u32 m_threadsCount;
+
+		// Written concurrently, but a state only changes once from STATE_UNKNOWN, so relaxed accesses are enough
+		std::unique_ptr<std::atomic<u8>[]> m_states;
+
+		// Positions resolved on the previous level, by thread
+		std::vector<std::vector<u64>> m_resolved;
+
+	public:
+		BitbaseGeneration(const BitbaseMaterial& material, const u32 threadsCount)
+			: m_material(material),
+			m_materialKey(material.materialKey()),
+			m_positionsCount(material.positionsCount()),
+			m_threadsCount(threadsCount),
+			m_states(new std::atomic<u8>[m_positionsCount]),
+			m_resolved(threadsCount) { }
+
+		// Returns the number of propagation levels
+		u32 run() {
+			// Initial classification
+			parallelFor(m_positionsCount, m_threadsCount, 4096, [this](const u64 index, const u32) {
+				m_states[index].store(STATE_UNKNOWN, std::memory_order_relaxed);
+			});
+
+			parallelFor(m_positionsCount, m_threadsCount, 4096, [this](const u64 index, const u32 threadId) {
+				Square squares[BitbaseMaterial::MAX_PIECES];
+				Color side;
+				if (!m_material.decodeIndex(index, squares, side)) {
+					m_states[index].store(STATE_INVALID, std::memory_order_relaxed);
+					return;
+				}
+
+				Board board = Board::fromPieces(m_material.pieces, squares, m_material.count, side);
+
+				// The side that has just moved cannot be in check
+				if (board.computeAttackersOf(side, board.king(side.getOpposite()))) {
+					m_states[index].store(STATE_INVALID, std::memory_order_relaxed);
+					return;
+				}
+
+				resolve(index, board, threadId, false);
+			});
+
+			// Propagation
+			u32 levels = 0;
+			std::vector<u64> level;
+			while (collectResolved(level)) {
+				++levels;
+				parallelFor(level.size(), m_threadsCount, 64, [this, &level](const u64 i, const u32 threadId) {
+					const u64 index = level[i];
+					const bool isLoss = m_states[index].load(std::memory_order_relaxed) == STATE_LOSS;
+
+					forEachPredecessor(index, [this, isLoss, threadId](const u64 predecessor) {
+						if (m_states[predecessor].load(std::memory_order_relaxed) != STATE_UNKNOWN) {
+							return;
+						}
+
+						if (isLoss) { // There is a move to a lost position
+							tryResolve(predecessor, STATE_WIN, threadId);
+						} else { // One more move to a won position, might be the last one
+							Square squares[BitbaseMaterial::MAX_PIECES];
+							Color side;
+							m_material.decodeIndex(predecessor, squares, side);
+
+							Board board = Board::fromPieces(m_material.pieces, squares, m_material.count, side);
+							resolve(predecessor, board, threadId, true);
+						}
+					});
+				});
+			}
+
+			return levels;
+		}
+
+		// Packs the results by 4 positions per byte, the unresolved positions are draws
+		std::vector<u8> pack(BitbaseGenerationReport& report) const {
+			std::vector<u8> result((m_positionsCount + 3) / 4, 0);
+			for (u64 index = 0; index < m_positionsCount; index++) {
+				u8 state = m_states[index].load(std::memory_order_relaxed);
+				switch (state) {
+					case STATE_WIN: ++report.wins; break;
+					case STATE_LOSS: ++report.losses; break;
+					case STATE_INVALID: state = STATE_DRAW; break;
+				default: 
+					state = STATE_DRAW;
+					++report.draws;
+					break;
+				}
+
+				result[index >> 2] |= state << ((index & 3) * 2);
+			}
+
+			return result;
+		}
+
+	private:
+		// Classifies the position by its successors and records the result if it is known
+		INLINE void resolve(const u64 index, Board& board, const u32 threadId, const bool isOnlyLossChecked) {
+			if (const GenerationState state = classify(board, isOnlyLossChecked); state != STATE_UNKNOWN) {
+				tryResolve(index, state, threadId);
+			}
+		}
+
+		INLINE void tryResolve(const u64 index, const GenerationState state, const u32 threadId) {
+			u8 expected = STATE_UNKNOWN;
+			if (m_states[index].compare_exchange_strong(expected, state, std::memory_order_relaxed)) {
+				m_resolved[threadId].push_back(index);
+			}
+		}
+
+		// Moves the positions resolved by all the threads into the level, returns false if there are none
+		bool collectResolved(std::vector<u64>& level) {
+			level.clear();
+			for (std::vector<u64>& resolved : m_resolved) {
+				level.insert(level.end(), resolved.begin(), resolved.end());
+				resolved.clear();
+			}
+
+			return !level.empty();
+		}
+
+		// A win if there is a move to a lost position, a loss if all the moves lead to won positions
+		// The moves that change the material are looked up in the smaller bitbases
+		// While propagating, a win is always found from the lost successor, so only a loss is checked for
+		GenerationState classify(Board& board, const bool isOnlyLossChecked) const {
+			MoveList moves;
+			board.generateMoves(moves);
+
+			bool hasLegalMoves = false;
+			bool areAllMovesLosing = true;
+			for (Move m : moves) {
+				if (!board.isLegal(m)) {
+					continue;
+				}
+
+				hasLegalMoves = true;
+				board.makeMove(m);
+
+				u8 successor = STATE_UNKNOWN;
+				if (board.materialKey() == m_materialKey) {
+					successor = m_states[m_material.makeIndex(board, false)].load(std::memory_order_relaxed);
+				} else if (BitbaseResult result; Bitbases::probe(board, result)) {
+					successor = u8(result);
+				}
+
+				board.unmakeMove(m);
+
+				if (successor == STATE_LOSS) {
+					return STATE_WIN;
+				} else if (isOnlyLossChecked && successor != STATE_WIN) {
+					return STATE_UNKNOWN;
+				}
+
+				areAllMovesLosing &= successor == STATE_WIN;
+			}
+
+			if (!hasLegalMoves) {
+				return board.isInCheck() ? STATE_LOSS : STATE_DRAW;
+			}
+
+			return areAllMovesLosing ? STATE_LOSS : STATE_UNKNOWN;
+		}
+
+		// Calls func for the index of every position that can precede the given one with a move
+		// that does not change the material. A move to any symmetric image of the position is a move
+		// to the same index, so it is enough to unmake the moves in the position itself. Though in pawnless
+		// endings the positions with the white king on the a1-h8 diagonal have 2 indices, one for each side of it
+		template<class Func>
+		void forEachPredecessor(const u64 index, Func&& func) const {
+			Square squares[BitbaseMaterial::MAX_PIECES];
+			Color side;
+			m_material.decodeIndex(index, squares, side);
+
+			BitBoard occupied = BitBoard::EMPTY;
+			for (u8 i = 0; i < m_material.count; i++) {
+				occupied.set(squares[i]);
+			}
+
+			const Color mover = side.getOpposite();
+			for (u8 i = 0; i < m_material.count; i++) {
+				const Piece piece = m_material.pieces[i];
+				if (piece.getColor() != mover) {
+					continue;
+				}
+
+				const Square to = squares[i];
+				BitBoard from = BitBoard::EMPTY;
+				if (piece.getType() == PieceType::PAWN) {
+					const i8 back = mover == Color::WHITE ? -8 : 8;
+					const Square single = Square::Value(to + back);
+					const Rank relativeRank = Rank::Value(mover == Color::WHITE ? to.getRank() : Rank::R8 - to.getRank());
+
+					if (relativeRank >= Rank::R3 && !occupied.test(single)) {
+						from.set(single);
+
+						if (relativeRank == Rank::R4 && !occupied.test(Square::Value(single + back))) {
+							from.set(Square::Value(single + back));
+						}
+					}
+				} else {
+					from = BitBoard::attacksOf(piece.getType(), to, occupied).b_and(occupied.b_not());
+				}
+
+				BB_FOR_EACH(sq, from) {
+					Square predecessor[BitbaseMaterial::MAX_PIECES];
+					std::copy(squares, squares + m_material.count, predecessor);
+					predecessor[i] = sq;
+
+					const u64 predecessorIndex = m_material.makeIndex(predecessor, mover);
+					func(predecessorIndex);
+
+					if (!m_material.hasPawns) {
+						std::transform(predecessor, predecessor + m_material.count, predecessor, [](Square s) { return s.mirrorByDiagonal(); });
+						if (const u64 mirroredIndex = m_material.makeIndex(predecessor, mover); mirroredIndex != predecessorIndex) {
+							func(mirroredIndex);
+						}
+					}
+				}
+			}
+		}
+	};
+
+	bool generateBitbase(const BitbaseMaterial& material, const u32 threadsCount, std::vector<BitbaseGenerationReport>& reports) {
+		const auto startTime = std::chrono::steady_clock::now();
+
+		BitbaseGenerationReport& report = reports.emplace_back();
+		report.name = material.toString();
+		report.positions = material.positionsCount();
+
+		std::string filePath;
+		{
+			BitbaseGeneration generation(material, threadsCount);
+			report.iterations = generation.run();
+			filePath = Bitbases::write(material, generation.pack(report));
+		}
+
+		if (filePath.empty() || !Bitbases::load(filePath)) {
+			return false;
+		}
+
+		report.fileSize = std::filesystem::file_size(filePath);
+		report.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+		return true;
+	}
+
+	bool BitbaseGenerator::generate(const BitbaseMaterial& material, const u32 threadsCount, std::vector<BitbaseGenerationReport>& reports) {
+		if (Bitbases::contains(material)) {
+			return true;
+		}
+
+		// The bitbases reachable with a capture or a promotion
+		const std::string name = material.toString();
+		for (size_t i = 1; i < name.size(); i++) {
+			if (name[i] == 'K' || name[i] == 'v') {
+				continue;
+			}
+
+			BitbaseMaterial dependency;
+			if (BitbaseMaterial::fromString(std::string(name).erase(i, 1), dependency)
+				&& !generate(dependency, threadsCount, reports)) {
+				return false;
+			}
+
+			if (name[i] == 'P') {
+				for (const char promoted : { 'Q', 'R', 'B', 'N' }) {
+					if (BitbaseMaterial::fromString(std::string(name).replace(i, 1, 1, promoted), dependency)
+						&& !generate(dependency, threadsCount, reports)) {
+						return false;
+					}
+				}
+			}
+		}
+
+		return generateBitbase(material, std::max(threadsCount, 1u), reports);
+	}
+}
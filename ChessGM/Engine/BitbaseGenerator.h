@@ -0,0 +1,54 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <vector>
+
+#include "Bitbases.h"
+
+/*
+*	BitbaseGenerator(.h/.cpp) contains the generation of the bitbases by retrograde analysis.
+* 
+*	At first, every position of the index space is set up on a Board and classified with the move generator:
+*	mates, stalemates and the positions resolved by captures and promotions into the smaller (already generated)
+*	bitbases. Then the results are propagated backwards level by level: the predecessors of a lost position
+*	are won, while the predecessors of a won position are checked again to see if all their moves lose.
+*	The positions that are left unresolved are draws. Both passes are split over the index space between threads.
+*/
+
+namespace engine {
+	struct BitbaseGenerationReport final {
+		std::string name;
+		u64 positions = 0;
+		u64 wins = 0;
+		u64 draws = 0;
+		u64 losses = 0;
+		u32 iterations = 0;
+		u64 time = 0; // In milliseconds
+		u64 fileSize = 0;
+	};
+
+	class BitbaseGenerator final {
+	public:
+		// Generates the bitbase and all the bitbases it depends on that are not loaded yet,
+		// writes them to the bitbases directory and loads them
+		// Returns false if some bitbase could not be written
+		static bool generate(const BitbaseMaterial& material, const u32 threadsCount, std::vector<BitbaseGenerationReport>& reports);
+	};
+}
@@ -0,0 +1,354 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Bitbases.h"
+#include <array>
+#include <deque>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+#include "Utils/MappedFile.h"
+
+namespace engine {
+	u8 Bitbases::s_maxPieces = 0;
+	std::string Bitbases::s_path;
+
+	struct BitbaseHeader final {
+		char magic[8];
+		u64 materialKey;
+		u64 positionsCount;
+		u8 piecesCount;
+		u8 reserved[7];
+	};
+
+	static_assert(sizeof(BitbaseHeader) == 32);
+
+	constexpr char BITBASE_MAGIC[8] = "CGMBB01";
+	constexpr const char* BITBASE_EXTENSION = ".cgbb";
+
+	struct BitbaseTable final {
+		BitbaseMaterial material;
+		MappedFile file;
+
+		CM_PURE BitbaseResult get(const u64 index) const noexcept {
+			const u8 packed = file.data()[sizeof(BitbaseHeader) + (index >> 2)];
+			return BitbaseResult((packed >> ((index & 3) * 2)) & 3);
+		}
+	};
+
+	std::deque<BitbaseTable> g_bitbases;
+	std::unordered_map<u64, const BitbaseTable*> g_bitbasesByKey; // Both with the original and the flipped material key
+
+
+	///  INDEXING  ///
+
+	// The white king squares in pawnless endings: a1-d1-d4 triangle
+	constexpr Square KING_TRIANGLE[10] = {
+		Square::A1, Square::B1, Square::C1, Square::D1,
+		Square::B2, Square::C2, Square::D2,
+		Square::C3, Square::D3,
+		Square::D4
+	};
+
+	constexpr auto KING_TRIANGLE_INDEX = [] {
+		std::array<u8, 64> result { };
+		for (u8 i = 0; i < std::size(KING_TRIANGLE); i++) {
+			result[KING_TRIANGLE[i]] = i;
+		}
+
+		return result;
+	}();
+
+	// Pieces are compared by the type, the queen being the strongest
+	CM_PURE constexpr bool isStrongerPiece(const char a, const char b) noexcept {
+		return Piece::fromFENChar(a).getType() > Piece::fromFENChar(b).getType();
+	}
+
+	bool BitbaseMaterial::fromString(std::string_view str, BitbaseMaterial& result) {
+		const size_t separator = str.find('v');
+		if (separator == std::string_view::npos) {
+			return false;
+		}
+
+		std::string sides[Color::VALUES_COUNT] = { std::string(str.substr(separator + 1)), std::string(str.substr(0, separator)) };
+		for (std::string& side : sides) {
+			if (side.empty() || side.front() != 'K' || side.find_first_not_of("QRBNP", 1) != std::string::npos) {
+				return false;
+			}
+
+			std::sort(side.begin() + 1, side.end(), isStrongerPiece);
+		}
+
+		if (sides[Color::WHITE].size() + sides[Color::BLACK].size() > MAX_PIECES) {
+			return false;
+		}
+
+		// The side with stronger pieces (or more pieces with the same strongest ones) is white
+		if (std::lexicographical_compare(sides[Color::WHITE].begin() + 1, sides[Color::WHITE].end(),
+			sides[Color::BLACK].begin() + 1, sides[Color::BLACK].end(), [](const char a, const char b) { return isStrongerPiece(b, a); })) {
+			std::swap(sides[Color::WHITE], sides[Color::BLACK]);
+		}
+
+		result = BitbaseMaterial();
+		result.pieces[result.count++] = Piece::KING_WHITE;
+		result.pieces[result.count++] = Piece::KING_BLACK;
+		for (auto color : { Color::WHITE, Color::BLACK }) {
+			for (const char ch : std::string_view(sides[color]).substr(1)) {
+				const Piece piece = Piece(color, Piece::fromFENChar(ch).getType());
+				result.pieces[result.count++] = piece;
+				result.hasPawns |= piece.getType() == PieceType::PAWN;
+			}
+		}
+
+		return true;
+	}
+
+	std::string BitbaseMaterial::toString() const {
+		std::string result = "K";
+		for (u8 i = 2; i < count && pieces[i].getColor() == Color::WHITE; i++) {
+			result += Piece(Color::WHITE, pieces[i].getType()).toChar();
+		}
+
+		result += "vK";
+		for (u8 i = 2; i < count; i++) {
+			if (pieces[i].getColor() == Color::BLACK) {
+				result += Piece(Color::WHITE, pieces[i].getType()).toChar();
+			}
+		}
+
+		return result;
+	}
+
+	u64 BitbaseMaterial::materialKey() const noexcept {
+		u64 result = 0;
+		for (u8 i = 0; i < count; i++) {
+			result += Board::materialKeyOf(pieces[i]);
+		}
+
+		return result;
+	}
+
+	u64 BitbaseMaterial::flippedMaterialKey() const noexcept {
+		u64 result = 0;
+		for (u8 i = 0; i < count; i++) {
+			result += Board::materialKeyOf(Piece(pieces[i].getColor().getOpposite(), pieces[i].getType()));
+		}
+
+		return result;
+	}
+
+	u64 BitbaseMaterial::positionsCount() const noexcept {
+		u64 result = (hasPawns ? 32 : std::size(KING_TRIANGLE)) * 64 * 2;
+		for (u8 i = 2; i < count; i++) {
+			result *= pieces[i].getType() == PieceType::PAWN ? 48 : 64;
+		}
+
+		return result;
+	}
+
+	u64 BitbaseMaterial::makeIndex(const Square* squares, const Color side) const noexcept {
+		Square sq[MAX_PIECES];
+		std::copy(squares, squares + count, sq);
+
+		// Normalizing the white king position
+		if (sq[0].getFile() > File::D) {
+			std::transform(sq, sq + count, sq, [](Square s) { return s.mirrorByFile(); });
+		}
+
+		if (!hasPawns) {
+			if (sq[0].getRank() > Rank::R4) {
+				std::transform(sq, sq + count, sq, [](Square s) { return s.getOpposite(); });
+			}
+
+			if (sq[0].getRank() > u8(sq[0].getFile())) {
+				std::transform(sq, sq + count, sq, [](Square s) { return s.mirrorByDiagonal(); });
+			}
+		}
+
+		// The same pieces are ordered by the square so that each position has a single index
+		for (u8 i = 3; i < count; i++) {
+			for (u8 j = i; j > 2 && pieces[j] == pieces[j - 1] && sq[j] < sq[j - 1]; j--) {
+				std::swap(sq[j], sq[j - 1]);
+			}
+		}
+
+		u64 result = hasPawns ? sq[0].getRank() * 4 + sq[0].getFile() : KING_TRIANGLE_INDEX[sq[0]];
+		result = result * 64 + sq[1];
+		for (u8 i = 2; i < count; i++) {
+			result = pieces[i].getType() == PieceType::PAWN
+				? result * 48 + (sq[i] - 8)
+				: result * 64 + sq[i];
+		}
+
+		return result * 2 + side;
+	}
+
+	u64 BitbaseMaterial::makeIndex(const Board& board, const bool swapColors) const noexcept {
+		Square squares[MAX_PIECES];
+		for (u8 i = 0; i < count;) {
+			const Piece piece = swapColors ? Piece(pieces[i].getColor().getOpposite(), pieces[i].getType()) : pieces[i];
+
+			BitBoard bb = board.byPiece(piece);
+			BB_FOR_EACH(sq, bb) {
+				squares[i++] = swapColors ? sq.getOpposite() : sq;
+			}
+		}
+
+		return makeIndex(squares, swapColors ? board.side().getOpposite() : board.side());
+	}
+
+	bool BitbaseMaterial::decodeIndex(u64 index, Square* squares, Color& side) const noexcept {
+		side = Color::Value(index & 1);
+		index >>= 1;
+
+		for (u8 i = count - 1; i >= 2; i--) {
+			if (pieces[i].getType() == PieceType::PAWN) {
+				squares[i] = Square::Value(index % 48 + 8);
+				index /= 48;
+			} else {
+				squares[i] = Square::Value(index % 64);
+				index /= 64;
+			}
+		}
+
+		squares[1] = Square::Value(index % 64);
+		index /= 64;
+		squares[0] = hasPawns ? Square(File::Value(index % 4), Rank::Value(index / 4)) : KING_TRIANGLE[index];
+
+		BitBoard occupied = BitBoard::EMPTY;
+		for (u8 i = 0; i < count; i++) {
+			if (occupied.test(squares[i])) {
+				return false;
+			}
+
+			occupied.set(squares[i]);
+
+			// The other order of the same pieces is the same position
+			if (i > 2 && pieces[i] == pieces[i - 1] && squares[i] < squares[i - 1]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	///  LOADING AND PROBING  ///
+
+	void Bitbases::init(const std::string& path) {
+		g_bitbasesByKey.clear();
+		g_bitbases.clear();
+		s_maxPieces = 0;
+		s_path = path == "<empty>" ? "" : path;
+
+		if (s_path.empty()) {
+			return;
+		}
+
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(s_path, error)) {
+			if (entry.path().extension() == BITBASE_EXTENSION) {
+				load(entry.path().string());
+			}
+		}
+	}
+
+	bool Bitbases::load(const std::string& filePath) {
+		BitbaseMaterial material;
+		if (!BitbaseMaterial::fromString(std::filesystem::path(filePath).stem().string(), material)) {
+			return false;
+		}
+
+		if (g_bitbasesByKey.contains(material.materialKey())) {
+			return true; // Already loaded
+		}
+
+		MappedFile file;
+		if (!file.open(filePath) || file.size() < sizeof(BitbaseHeader)) {
+			return false;
+		}
+
+		BitbaseHeader header;
+		memcpy(&header, file.data(), sizeof(BitbaseHeader));
+		if (memcmp(header.magic, BITBASE_MAGIC, sizeof(BITBASE_MAGIC))
+			|| header.materialKey != material.materialKey()
+			|| header.positionsCount != material.positionsCount()
+			|| header.piecesCount != material.count
+			|| file.size() != sizeof(BitbaseHeader) + (header.positionsCount + 3) / 4) {
+			return false;
+		}
+
+		BitbaseTable& table = g_bitbases.emplace_back(BitbaseTable { .material = material, .file = std::move(file) });
+		g_bitbasesByKey[material.materialKey()] = g_bitbasesByKey[material.flippedMaterialKey()] = &table;
+		s_maxPieces = std::max(s_maxPieces, material.count);
+
+		return true;
+	}
+
+	size_t Bitbases::tablesCount() noexcept {
+		return g_bitbases.size();
+	}
+
+	bool Bitbases::contains(const BitbaseMaterial& material) noexcept {
+		return g_bitbasesByKey.contains(material.materialKey());
+	}
+
+	std::string Bitbases::write(const BitbaseMaterial& material, const std::vector<u8>& results) {
+		BitbaseHeader header { };
+		memcpy(header.magic, BITBASE_MAGIC, sizeof(BITBASE_MAGIC));
+		header.materialKey = material.materialKey();
+		header.positionsCount = material.positionsCount();
+		header.piecesCount = material.count;
+
+		std::error_code error;
+		std::filesystem::create_directories(path(), error);
+
+		const std::string filePath = (std::filesystem::path(path()) / (material.toString() + BITBASE_EXTENSION)).string();
+		std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(results.data()), results.size());
+
+		return file.good() ? filePath : "";
+	}
+
+	bool Bitbases::probe(const Board& board, BitbaseResult& result) noexcept {
+		if (board.allPieces().popcnt() > s_maxPieces || board.castleRight()) {
+			return false;
+		}
+
+		// En passant is not accounted for in the bitbases
+		const Color side = board.side();
+		if (board.ep() != Square::NO_POS && BitBoard::pawnAttacks(side.getOpposite(), board.ep()).b_and(board.pawns(side))) {
+			return false;
+		}
+
+		const auto it = g_bitbasesByKey.find(board.materialKey());
+		if (it == g_bitbasesByKey.end()) {
+			return false;
+		}
+
+		const BitbaseTable& table = *it->second;
+		result = table.get(table.material.makeIndex(board, board.materialKey() != table.material.materialKey()));
+
+		return true;
+	}
+}
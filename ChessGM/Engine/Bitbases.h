@@ -0,0 +1,111 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include "Chess/Board.h"
+
+/*
+*	Bitbases(.h/.cpp) contains the win/draw/loss bitbases generated by the engine itself
+*	(see BitbaseGenerator) for the endings with up to 5 pieces.
+* 
+*	A bitbase file is named after its material (e.g. KRvKN.cgbb) and consists of a 32-byte header
+*	followed by 2 bits per position with the result for the side to move. The files are memory mapped,
+*	so only the accessed pages are loaded.
+* 
+*	The index of a position is built from the squares of the pieces in the order of BitbaseMaterial.
+*	The white king is normalized to the a1-d1-d4 triangle (10 squares) in pawnless endings and
+*	to files A-D (32 squares) otherwise, the pawns take only 48 squares. Castling and en passant
+*	are not taken into account, so such positions are not probed.
+*/
+
+namespace engine {
+	// The result for the side to move
+	enum class BitbaseResult : u8 {
+		DRAW = 0,
+		WIN = 1,
+		LOSS = 2
+	};
+
+	// The material of a bitbase: the white king, the black king, then the rest of white and black pieces
+	// from queens to pawns. White is always the side with the stronger pieces
+	struct BitbaseMaterial final {
+		constexpr inline static u8 MAX_PIECES = 5;
+
+		Piece pieces[MAX_PIECES] { };
+		u8 count = 0;
+		bool hasPawns = false;
+
+		// Parses a material like KRvKN, the sides are swapped if black is stronger
+		static bool fromString(std::string_view str, BitbaseMaterial& result);
+		std::string toString() const;
+
+		u64 materialKey() const noexcept;
+
+		// The key of the same material with the colors swapped
+		u64 flippedMaterialKey() const noexcept;
+
+		u64 positionsCount() const noexcept;
+
+		// The index of the position with the pieces on the given squares (in the order of pieces)
+		u64 makeIndex(const Square* squares, const Color side) const noexcept;
+
+		// The index of the position on the board, the colors are swapped if the board has the flipped material
+		u64 makeIndex(const Board& board, const bool swapColors) const noexcept;
+
+		// Restores the squares of the pieces and the side to move, returns false if the index
+		// does not represent a valid placement of pieces (some pieces on the same square and so on)
+		bool decodeIndex(u64 index, Square* squares, Color& side) const noexcept;
+	};
+
+	class Bitbases final {
+	private:
+		static u8 s_maxPieces; // The maximal number of pieces among the loaded bitbases
+		static std::string s_path;
+
+	public:
+		// (Re)loads the bitbases from the given directory, an empty path disables the bitbases
+		static void init(const std::string& path);
+
+		// Loads a single bitbase file, returns false if the file is missing or corrupted
+		static bool load(const std::string& filePath);
+
+		static size_t tablesCount() noexcept;
+		static bool contains(const BitbaseMaterial& material) noexcept;
+
+		// The directory the bitbases are loaded from and generated into
+		CM_PURE static std::string path() noexcept {
+			return s_path.empty() ? "." : s_path;
+		}
+
+		CM_PURE static u8 maxPieces() noexcept {
+			return s_maxPieces;
+		}
+
+		// Writes the results packed by 4 positions per byte into the bitbase file in the bitbases directory
+		// Returns the path to the file or an empty string on failure
+		static std::string write(const BitbaseMaterial& material, const std::vector<u8>& results);
+
+		// Probes the bitbase for the position, returns false if there is no such bitbase
+		static bool probe(const Board& board, BitbaseResult& result) noexcept;
+	};
+}
@@ -0,0 +1,74 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Chess/Board.h"
+
+/*
+*	Book(.h/.cpp) contains the opening book in the Polyglot format.
+* 
+*	A book file is an array of 16-byte big-endian entries (key, move, weight, learn) sorted by the key.
+*	The file is memory mapped once and stays mapped across games, the entries of a position are found
+*	with a binary search by its Polyglot key and the move is chosen randomly in proportion to its weight.
+* 
+*	The keys are the Polyglot ones (the original 781 random numbers for pieces, castling, en passant
+*	and the turn), so the books built by other tools can be used as well as the ones built with build_book.
+*/
+
+namespace engine {
+	struct BookEntry final {
+		u64 key;
+		u16 move;
+		u16 weight;
+		u32 learn;
+	};
+
+	class Book final {
+	public:
+		constexpr inline static size_t ENTRY_SIZE = 16;
+
+	public:
+		// Maps the book file, the previous book is closed
+		static bool open(const std::string& path);
+		static void close();
+
+		static bool isOpen() noexcept;
+		static size_t entriesCount() noexcept;
+
+		static u64 polyglotKey(const Board& board) noexcept;
+
+		// Polyglot encodes castling as the king capturing its own rook
+		static u16 toPolyglotMove(const Board& board, const Move move) noexcept;
+
+		// Returns the null move if there is no such legal move in the position
+		static Move fromPolyglotMove(const Board& board, const u16 move) noexcept;
+
+		static void readEntry(const u8* data, BookEntry& entry) noexcept;
+		static void writeEntry(u8* data, const BookEntry& entry) noexcept;
+
+		// Appends the book entries of the position that have legal moves
+		static void getEntries(const Board& board, std::vector<BookEntry>& entries);
+
+		// Chooses a book move by the weights, returns the null move if the position is not in the book
+		static Move probe(const Board& board);
+	};
+}
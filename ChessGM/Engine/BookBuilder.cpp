@@ -0,0 +1,487 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "BookBuilder.h"
+#include <mutex>
+#include <memory>
+#include <queue>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+#include "Book.h"
+#include "PgnReader.h"
+
+namespace engine {
+	constexpr u32 SHARDS_COUNT = 64;
+	constexpr u64 CHUNK_SIZE = 16ull << 20; // The pgn files are split into chunks of about that size
+	constexpr u64 COUNTER_MEMORY = 64; // An estimation of the memory taken by a single counter in the hash map
+	constexpr size_t RUN_BUFFER_SIZE = 4096; // In records
+	constexpr size_t MERGE_FAN_IN = 16; // The runs merged at once, so that only as many files and buffers are open
+
+	struct BookMoveKey final {
+		u64 key;
+		u16 move;
+
+		CM_PURE constexpr bool operator==(const BookMoveKey& other) const noexcept {
+			return key == other.key && move == other.move;
+		}
+
+		CM_PURE constexpr bool operator<(const BookMoveKey& other) const noexcept {
+			return key < other.key || (key == other.key && move < other.move);
+		}
+	};
+
+	struct BookMoveKeyHash final {
+		CM_PURE size_t operator()(const BookMoveKey& key) const noexcept {
+			return size_t(key.key ^ (u64(key.move) * 0x9e3779b97f4a7c15ull));
+		}
+	};
+
+	struct BookMoveStats final {
+		u32 games = 0;
+		u32 wins = 0; // For the moving side
+		u32 draws = 0;
+	};
+
+	// Written to the run files as is, since they are read back by the same build
+	struct BookRunRecord final {
+		BookMoveKey key;
+		BookMoveStats stats;
+	};
+
+	using BookCounters = std::unordered_map<BookMoveKey, BookMoveStats, BookMoveKeyHash>;
+
+	struct BookShard final {
+		std::mutex mutex;
+		BookCounters counters;
+	};
+
+	// Reads the records of a sorted run either from its file or from memory
+	struct RunCursor final {
+		std::ifstream file;
+		std::vector<BookRunRecord> buffer;
+		size_t position = 0;
+
+		bool next(BookRunRecord& record) {
+			if (position == buffer.size()) {
+				if (!file.is_open()) {
+					return false;
+				}
+
+				buffer.resize(RUN_BUFFER_SIZE);
+				file.read(reinterpret_cast<char*>(buffer.data()), std::streamsize(RUN_BUFFER_SIZE * sizeof(BookRunRecord)));
+				buffer.resize(size_t(file.gcount()) / sizeof(BookRunRecord));
+				position = 0;
+
+				if (buffer.empty()) {
+					return false;
+				}
+			}
+
+			record = buffer[position++];
+			return true;
+		}
+	};
+
+	// K-way merge of the sorted runs, onRecord is called in the key order with the counters of each move summed up
+	template<class OnRecord>
+	void mergeRuns(std::vector<RunCursor>& cursors, OnRecord&& onRecord) {
+		using HeapItem = std::pair<BookRunRecord, size_t>;
+		const auto heapCompare = [](const HeapItem& a, const HeapItem& b) { return b.first.key < a.first.key; };
+		std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(heapCompare)> heap(heapCompare);
+
+		for (size_t i = 0; i < cursors.size(); i++) {
+			if (BookRunRecord record; cursors[i].next(record)) {
+				heap.emplace(record, i);
+			}
+		}
+
+		bool hasCurrent = false;
+		BookRunRecord current;
+		while (!heap.empty()) {
+			auto [record, cursor] = heap.top();
+			heap.pop();
+
+			if (BookRunRecord next; cursors[cursor].next(next)) {
+				heap.emplace(next, cursor);
+			}
+
+			if (hasCurrent && current.key == record.key) {
+				current.stats.games += record.stats.games;
+				current.stats.wins += record.stats.wins;
+				current.stats.draws += record.stats.draws;
+				continue;
+			}
+
+			if (hasCurrent) {
+				onRecord(current);
+			}
+
+			current = record;
+			hasCurrent = true;
+		}
+
+		if (hasCurrent) {
+			onRecord(current);
+		}
+	}
+
+	class BookBuilding final {
+	private:
+		const BookBuildSettings& m_settings;
+		const std::string& m_bookFile;
+		const u64 m_countersLimit;
+
+		std::unique_ptr<BookShard[]> m_shards;
+		std::vector<PgnChunk> m_chunks;
+		std::atomic<u64> m_countersCount = 0; // In all the shards
+
+		std::mutex m_spillMutex;
+		std::vector<std::string> m_runFiles; // The runs not merged yet
+		u64 m_runsCount = 0; // All the runs written, also the merged ones
+		u64 m_spillsCount = 0;
+
+		std::atomic<size_t> m_nextChunk = 0;
+		std::atomic<u64> m_games = 0;
+		std::atomic<u64> m_moves = 0;
+		std::atomic<bool> m_failed = false;
+
+	public:
+		BookBuilding(const BookBuildSettings& settings, const std::string& bookFile)
+			: m_settings(settings), 
+			m_bookFile(bookFile), 
+			m_countersLimit(std::max<u64>(settings.memoryLimit / COUNTER_MEMORY, 1)),
+			m_shards(std::make_unique<BookShard[]>(SHARDS_COUNT)) { }
+
+		~BookBuilding() {
+			for (const std::string& runFile : m_runFiles) {
+				std::error_code error;
+				std::filesystem::remove(runFile, error);
+			}
+		}
+
+		bool splitFiles(const std::vector<std::string>& pgnFiles) {
+			for (const std::string& path : pgnFiles) {
+				if (!PgnReader::split(path, CHUNK_SIZE, m_chunks)) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void count() {
+			const auto worker = [this]() {
+				for (size_t chunk; (chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed)) < m_chunks.size();) {
+					countChunk(m_chunks[chunk]);
+				}
+			};
+
+			std::vector<std::thread> threads;
+			for (u32 i = 1; i < m_settings.threadsCount; i++) {
+				threads.emplace_back(worker);
+			}
+
+			worker();
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+		}
+
+		bool write(BookBuildReport& report) {
+			std::vector<RunCursor> cursors;
+			if (m_runFiles.empty()) { // Everything fits in memory, so it is merged right from there
+				RunCursor& cursor = cursors.emplace_back();
+				takeCounters(cursor.buffer);
+			} else {
+				// The counters left in memory make up the last run, then the runs are merged in several
+				// passes till there are few enough of them to be merged into the book at once
+				spill(true);
+				while (!isFailed() && m_runFiles.size() > MERGE_FAN_IN) {
+					mergePass();
+				}
+
+				if (isFailed() || !openRuns(m_runFiles, cursors)) {
+					return false;
+				}
+			}
+
+			std::ofstream book(m_bookFile, std::ios::binary);
+			if (!book.is_open()) {
+				return false;
+			}
+
+			std::vector<BookRunRecord> positionMoves;
+			mergeRuns(cursors, [&](const BookRunRecord& record) {
+				addMove(book, positionMoves, record, report);
+			});
+
+			writePosition(book, positionMoves, report);
+
+			book.close();
+			return !book.fail();
+		}
+
+		u64 gamesCount() const noexcept {
+			return m_games.load(std::memory_order_relaxed);
+		}
+
+		u64 movesCount() const noexcept {
+			return m_moves.load(std::memory_order_relaxed);
+		}
+
+		u64 spillsCount() const noexcept {
+			return m_spillsCount;
+		}
+
+		bool isFailed() const noexcept {
+			return m_failed.load(std::memory_order_relaxed);
+		}
+
+	private:
+		void countChunk(const PgnChunk& chunk) {
+			PgnReader pgn;
+			if (!pgn.open(chunk)) {
+				m_failed.store(true, std::memory_order_relaxed);
+				return;
+			}
+
+			PgnGame game;
+			while (pgn.readGame(game)) {
+				// The games with an unknown result (*) would count as draws and skew the weights
+				bool success;
+				Board board = Board::fromFEN(game.initialFen, success);
+				if (!success || !game.isResultKnown) {
+					continue;
+				}
+
+				const size_t plies = std::min<size_t>(game.moves.size(), m_settings.maxPly);
+				for (size_t ply = 0; ply < plies; ply++) {
+					const Move move = game.moves[ply];
+					const float score = board.side() == Color::WHITE ? game.result : 1.f - game.result;
+
+					BookMoveStats stats;
+					stats.games = 1;
+					stats.wins = score == 1.f;
+					stats.draws = score == 0.5f;
+
+					addCounter(BookMoveKey { Book::polyglotKey(board), Book::toPolyglotMove(board, move) }, stats);
+					board.makeMove(move);
+				}
+
+				m_games.fetch_add(1, std::memory_order_relaxed);
+				m_moves.fetch_add(plies, std::memory_order_relaxed);
+			}
+		}
+
+		void addCounter(const BookMoveKey& key, const BookMoveStats& stats) {
+			BookShard& shard = m_shards[BookMoveKeyHash()(key) % SHARDS_COUNT];
+			bool isNew;
+
+			{
+				std::lock_guard<std::mutex> lock(shard.mutex);
+
+				auto [it, inserted] = shard.counters.try_emplace(key);
+				it->second.games += stats.games;
+				it->second.wins += stats.wins;
+				it->second.draws += stats.draws;
+				isNew = inserted;
+			}
+
+			if (isNew && m_countersCount.fetch_add(1, std::memory_order_relaxed) + 1 >= m_countersLimit) {
+				spill(false);
+			}
+		}
+
+		// Moves the counters of all the shards to the sorted records, one shard at a time
+		void takeCounters(std::vector<BookRunRecord>& records) {
+			records.reserve(m_countersCount.load(std::memory_order_relaxed));
+
+			for (u32 i = 0; i < SHARDS_COUNT; i++) {
+				BookCounters counters;
+				{
+					std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+					counters.swap(m_shards[i].counters);
+				}
+
+				m_countersCount.fetch_sub(counters.size(), std::memory_order_relaxed);
+				for (const auto& [key, stats] : counters) {
+					records.emplace_back(BookRunRecord { key, stats });
+				}
+			}
+
+			std::sort(records.begin(), records.end(), [](const BookRunRecord& a, const BookRunRecord& b) {
+				return a.key < b.key;
+			});
+		}
+
+		// Spills all the shards together into a single sorted run, so that the runs are as large as the memory limit allows
+		// Unless forced, it is only done if the limit is still reached, since another thread could have spilled the counters already
+		void spill(const bool force) {
+			std::lock_guard<std::mutex> lock(m_spillMutex);
+			const u64 countersCount = m_countersCount.load(std::memory_order_relaxed);
+			if (countersCount == 0 || (!force && countersCount < m_countersLimit)) {
+				return;
+			}
+
+			std::vector<BookRunRecord> records;
+			takeCounters(records);
+
+			std::ofstream file = createRun();
+			file.write(reinterpret_cast<const char*>(records.data()), std::streamsize(records.size() * sizeof(BookRunRecord)));
+			file.close();
+
+			++m_spillsCount;
+			if (file.fail()) {
+				m_failed.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		std::ofstream createRun() {
+			const std::string path = m_bookFile + ".run" + std::to_string(m_runsCount++);
+			m_runFiles.push_back(path);
+
+			return std::ofstream(path, std::ios::binary);
+		}
+
+		bool openRuns(const std::vector<std::string>& runFiles, std::vector<RunCursor>& cursors) {
+			cursors.resize(runFiles.size());
+			for (size_t i = 0; i < runFiles.size(); i++) {
+				cursors[i].file.open(runFiles[i], std::ios::binary);
+				if (!cursors[i].file.is_open()) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Merges the runs by MERGE_FAN_IN into the larger ones
+		void mergePass() {
+			std::vector<std::string> runFiles;
+			runFiles.swap(m_runFiles);
+
+			for (size_t first = 0; first < runFiles.size(); first += MERGE_FAN_IN) {
+				const std::vector<std::string> group(runFiles.begin() + first, runFiles.begin() + std::min(first + MERGE_FAN_IN, runFiles.size()));
+
+				std::vector<RunCursor> cursors;
+				std::ofstream file = createRun();
+				if (!openRuns(group, cursors) || !file.is_open()) {
+					m_failed.store(true, std::memory_order_relaxed);
+					break;
+				}
+
+				std::vector<BookRunRecord> buffer;
+				buffer.reserve(RUN_BUFFER_SIZE);
+				const auto flush = [&]() {
+					file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size() * sizeof(BookRunRecord)));
+					buffer.clear();
+				};
+
+				mergeRuns(cursors, [&](const BookRunRecord& record) {
+					buffer.push_back(record);
+					if (buffer.size() == RUN_BUFFER_SIZE) {
+						flush();
+					}
+				});
+
+				flush();
+				file.close();
+				cursors.clear();
+
+				for (const std::string& runFile : group) {
+					std::error_code error;
+					std::filesystem::remove(runFile, error);
+				}
+
+				if (file.fail()) {
+					m_failed.store(true, std::memory_order_relaxed);
+					break;
+				}
+			}
+
+			// The runs of a failed pass are removed by the destructor
+			if (isFailed()) {
+				m_runFiles.insert(m_runFiles.end(), runFiles.begin(), runFiles.end());
+			}
+		}
+
+		// Collects the moves of the same position, since their weights are scaled together
+		void addMove(std::ofstream& book, std::vector<BookRunRecord>& positionMoves, const BookRunRecord& record, BookBuildReport& report) {
+			if (!positionMoves.empty() && positionMoves.front().key.key != record.key.key) {
+				writePosition(book, positionMoves, report);
+			}
+
+			if (record.stats.games >= m_settings.minGames && 2 * u64(record.stats.wins) + record.stats.draws > 0) {
+				positionMoves.push_back(record);
+			}
+		}
+
+		void writePosition(std::ofstream& book, std::vector<BookRunRecord>& positionMoves, BookBuildReport& report) {
+			u64 maxWeight = 0;
+			for (const BookRunRecord& record : positionMoves) {
+				maxWeight = std::max(maxWeight, 2 * u64(record.stats.wins) + record.stats.draws);
+			}
+
+			u8 data[Book::ENTRY_SIZE];
+			for (const BookRunRecord& record : positionMoves) {
+				u64 weight = 2 * u64(record.stats.wins) + record.stats.draws;
+				if (maxWeight > 0xffff) {
+					weight = std::max<u64>(weight * 0xffff / maxWeight, 1);
+				}
+
+				Book::writeEntry(data, BookEntry { record.key.key, record.key.move, u16(weight), 0 });
+				book.write(reinterpret_cast<const char*>(data), Book::ENTRY_SIZE);
+				++report.entries;
+			}
+
+			positionMoves.clear();
+		}
+	};
+
+	bool BookBuilder::build(const std::vector<std::string>& pgnFiles, const std::string& bookFile, const BookBuildSettings& settings, BookBuildReport& report) {
+		using namespace std::chrono;
+
+		const auto start = high_resolution_clock::now();
+		report = BookBuildReport();
+
+		BookBuilding building(settings, bookFile);
+		if (!building.splitFiles(pgnFiles)) {
+			return false;
+		}
+
+		building.count();
+
+		const bool success = !building.isFailed() && building.write(report);
+		report.games = building.gamesCount();
+		report.moves = building.movesCount();
+		report.runs = building.spillsCount();
+		report.time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+
+		std::error_code error;
+		report.fileSize = std::filesystem::file_size(bookFile, error);
+
+		return success;
+	}
+}
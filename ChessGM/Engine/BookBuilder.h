@@ -0,0 +1,61 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Utils/Types.h"
+
+/*
+*	BookBuilder(.h/.cpp) contains the building of Polyglot opening books from pgn files.
+* 
+*	The pgn files are split into chunks at the game boundaries, and the chunks are read by several threads.
+*	For each (position key, move) pair within the depth limit the games, wins and draws of the moving side
+*	are counted in a hash map split into shards with their own locks. Once the counters of all the shards
+*	reach the memory limit, they are sorted and spilled together to a temporary run file next to the book.
+*	In the end the runs are merged by at most 16 at once, in several passes if there are more of them, then
+*	the moves played in too few games are dropped and the rest are written as the book entries.
+*	The games with an unknown result (*) are skipped.
+*/
+
+namespace engine {
+	struct BookBuildSettings final {
+		u32 minGames = 3; // A move must be played in at least as many games to get into the book
+		u32 maxPly = 30; // Only the positions within that many half-moves from the game start are counted
+		u32 threadsCount = 1;
+		u64 memoryLimit = 256ull << 20; // In bytes, for the counters held in memory
+	};
+
+	struct BookBuildReport final {
+		u64 games = 0;
+		u64 moves = 0; // The (position, move) occurrences counted
+		u64 runs = 0; // The sorted runs spilled to the disk
+		u64 entries = 0;
+		u64 time = 0; // In milliseconds
+		u64 fileSize = 0;
+	};
+
+	class BookBuilder final {
+	public:
+		// The weight of a move is 2 * wins + draws for the moving side, scaled down to 16 bits if needed
+		// Returns false if some pgn file could not be read or the book could not be written
+		static bool build(const std::vector<std::string>& pgnFiles, const std::string& bookFile, const BookBuildSettings& settings, BookBuildReport& report);
+	};
+}
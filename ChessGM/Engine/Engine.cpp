@@ -18,6 +18,7 @@
 
 #include "Engine.h"
 #include "Search.h"
+#include "Utils/Profiler.h"
 
 namespace engine {
 	Board g_board;
@@ -39,6 +40,8 @@ namespace engine {
 			options::g_forceMode = true;
 		}
 
+		io::startInputThread(mode == io::CONSOLE ? isUrgentConsole : mode == io::UCI ? isUrgentUCI : isUrgentXboard);
+
 		// Get another command in a loop and handle it in the current mode.
 		std::vector<std::string> args;
 		std::string cmd;
@@ -48,21 +51,17 @@ namespace engine {
 		} while (handle(std::move(cmd), args));
 	}
 
-	void checkInput() {
-		if (!io::hasInput()) { // Has no input
-			return;
-		}
+	bool checkInput() {
+		PROFILE_ZONE(CHECK_INPUT);
 
-		void (*check)(std::string, const std::vector<std::string>&)
+		bool (*check)(const std::string&, const std::vector<std::string>&)
 			= io::getMode() == io::CONSOLE
 				? checkConsole
 			: io::getMode() == io::UCI
 				? checkUCI
 				: checkXboard;
 
-		std::vector<std::string> args;
-		std::string cmd = io::getCommand(args, false);
-		check(std::move(cmd), args);
+		return io::checkUrgentCommands(check);
 	}
 
 	bool newGame(std::string_view fen) {
@@ -39,16 +39,23 @@ namespace engine {
 	bool handleConsole(std::string cmd, const std::vector<std::string>& args);
 	bool handleUCI(std::string cmd, const std::vector<std::string>& args);
 
-	void checkXboard(std::string cmd, const std::vector<std::string>& args);
-	void checkConsole(std::string cmd, const std::vector<std::string>& args);
-	void checkUCI(std::string cmd, const std::vector<std::string>& args);
+	// Called by the input thread, tell if the command must be seen by the search right away
+	bool isUrgentXboard(std::string_view cmd);
+	bool isUrgentConsole(std::string_view cmd);
+	bool isUrgentUCI(std::string_view cmd);
+
+	// Called during the search for the urgent commands, return true if the command was handled,
+	// otherwise the search stops and the command is handled as usual afterwards
+	bool checkXboard(const std::string& cmd, const std::vector<std::string>& args);
+	bool checkConsole(const std::string& cmd, const std::vector<std::string>& args);
+	bool checkUCI(const std::string& cmd, const std::vector<std::string>& args);
 
 	void run(io::IOMode mode);
 
-	// Must be called once in a while during continuous processes
-	// Checks if there is any input available and handles it if necessary
-	// This works with very few commands - most are just pushed to the queue
-	void checkInput();
+	// Must be called once in a while during continuous processes if io::hasUrgentCommands()
+	// Handles the urgent commands that can be handled right away (e.g. isready)
+	// Returns true if the process must stop for the other ones (e.g. stop)
+	bool checkInput();
 
 	// Common engine functions (implemented in Engine.cpp)
 	// Return false on any error, the error would be in g_errorMessage.
@@ -18,6 +18,10 @@
 
 #include "Engine.h"
 #include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <thread>
 
 #include "Utils/CommandHandlingUtils.h"
 #include "Utils/StringUtils.h"
@@ -25,6 +29,20 @@
 #include "Search.h"
 #include "Test.h"
 #include "Tuning.h"
+#include "TranspositionTable.h"
+#include "PawnHashTable.h"
+#include "Syzygy.h"
+#include "BitbaseGenerator.h"
+#include "Book.h"
+#include "BookBuilder.h"
+#include "PositionIndex.h"
+#include "PgnReader.h"
+#include "Bench.h"
+#include "Microbench.h"
+#include "EpdTest.h"
+#include "BatchAnalysis.h"
+#include "GameReview.h"
+#include "Utils/Profiler.h"
 
 namespace engine {
 	void handleIncorrectCommandConsole(std::string_view cmd, const std::vector<std::string>& args, CommandError err) {
@@ -64,6 +82,41 @@ namespace engine {
 			<< g_board << std::endl;
 	}
 
+	// Searches the current position with the lazy evaluation disabled and enabled
+	// and prints the speed of both searches
+	void compareLazyEval(const Depth depth) {
+		const bool wasLazyEval = options::g_lazyEval;
+		const bool wasPostMode = options::g_postMode;
+		const Limits oldLimits = g_limits;
+
+		options::g_postMode = false;
+		for (const bool lazyEval : { false, true }) {
+			options::g_lazyEval = lazyEval;
+			TranspositionTable::clear();
+			PawnHashTable::reset();
+			g_evalStats = EvalStats();
+			g_limits.makeInfinite(); // Also starts the timer
+			g_limits.setDepthLimit(depth);
+
+			SearchResult result = rootSearch(g_board);
+			const time_t elapsed = std::max(g_limits.elapsedMilliseconds(), time_t(1));
+
+			io::g_out << "Lazy evaluation " << (lazyEval ? "on" : "off") << ":" << std::endl
+				<< "\tBest move: " << io::Color::Blue << result.best << io::Color::White 
+				<< ", value: " << io::Color::Green << result.value << std::endl
+				<< "\tNodes: " << io::Color::Blue << g_nodesCount << std::endl
+				<< "\tTime: " << io::Color::Blue << elapsed << io::Color::White << " milliseconds" << std::endl
+				<< "\tKn/S: " << io::Color::Blue << g_nodesCount / elapsed << std::endl
+				<< "\tEvaluations: " << io::Color::Blue << g_evalStats.calls << io::Color::White 
+				<< ", lazy exits: " << io::Color::Blue << g_evalStats.lazyExits << io::Color::White 
+				<< " (" << (g_evalStats.lazyExits * 100.0 / std::max(g_evalStats.calls, NodesCount(1))) << "%)" << std::endl;
+		}
+
+		options::g_lazyEval = wasLazyEval;
+		options::g_postMode = wasPostMode;
+		g_limits = oldLimits;
+	}
+
 	void printHelp() {
 		io::g_out << io::Color::Green
 			<< "List of available commands: "\
@@ -77,20 +130,44 @@ namespace engine {
 			"\n\tdo [move] - to make a move"\
 			"\n\tundo - to unmake a move"\
 			"\n\trandom - toggles the random mode, where the engine makes more random moves"\
+			"\n\tlazy_eval - toggles the lazy evaluation in quiescence search"\
+			"\n\tsyzygy_path [paths: string] - loads the Syzygy tablebases from the given directories"\
+			"\n\tbitbase_path [path: string] - loads the bitbases from the given directory, new bitbases are generated there"\
+			"\n\tbook_file [path: string] - opens the Polyglot opening book"\
+			"\n\tbook - to get the book moves in the current position"\
+			"\n\tbuild_book [book file] [pgn files...] [optional: min_games=uint depth=uint threads=uint memory=MB] - builds the Polyglot book from pgn files"\
+			"\n\tindex_pgn [pgn file] [optional depth: uint] [optional threads: uint] - indexes the positions of the pgn file's games"\
+			"\n\tfind_games [pgn file] [optional max games: uint, 10 by default] - finds the indexed games that reached the current position"\
+			"\n\tpgn_bench [pgn file] - reads all the games of the pgn file and prints the reading speed"\
+			"\n\tgenerate_bitbase [material: e.g. KRvKN] [optional threads: uint] - generates the bitbase for up to 5 pieces"\
 			"\n\tforce - sets the force mode, where the engine doesn't make moves and only accepts input"\
 			"\n\tlevel [control: uint] [base time: minutes:seconds] [inc time: seconds] - sets time limits"\
 			"\n\tset_max_nodes [nodes: u64] - sets nodes limit"\
 			"\n\tset_max_depth [depth: u64] - sets depth limit"\
 			"\n\treset_limits - resets all the limits, making the search infinite"\
+			"\n\tthreads [count: uint] - sets the number of threads of the search"\
 			"\n\tgo - resets the force mode and starts the engine's move"\
 			"\n\thistory - to print the moves done during the game"\
 			"\n\teval - returns static evaluation of the current position"\
 			"\n\tsearch [depth: uint] - returns the position evaluation based on search for given depth"\
 			"\n\tperft [depth: uint] - starts the performance test for the given depth and prints the number of nodes"\
+			"\n\tlazy_eval_test [depth: uint] - searches the position with and without lazy evaluation and compares the speed"\
+			"\n\tsearch_stats [off|console|file] - dumps the search statistics after each search to the console or appends them to the JSON lines file (needs ENABLE_SEARCH_STATS)"\
+			"\n\tprofile [optional: reset] - prints the cycles and calls of the profiled zones (movegen, eval, SEE...) per thread or resets them (needs ENABLE_PROFILER)"\
+			"\n\tbench [optional depth: uint, default: 10] [optional threads: uint] [optional hash: MB, default: 16] - searches the built-in positions and prints the total nodes (a signature of the engine) and NPS"\
+			"\n\tsmp_bench [optional depth: uint, default: 10] [optional max threads: uint, default: all cores] [optional hash: MB, default: 16] [optional: csv file] - runs the bench with 1, 2, 4... threads and prints the NPS scaling, time to depth speedup and node overhead in CSV"\
+			"\n\tmicrobench [optional: csv file] [optional samples: uint, default: 15] - times the hot primitives (move generation, SEE, eval, hash tables...) and prints the cost of each in CSV"\
+			"\n\tepdtest [epd file] [optional limit: time|depth|nodes, default: time] [optional limit value: ms|plies|nodes, default: 1000 ms, 10 plies or 1000000 nodes] [optional threads: uint, default: all cores] - runs an EPD test suite (bm/am operations) and prints the solved positions with the time and nodes to solution"\
+			"\n\tbatch [fen file] [optional limit: time|depth|nodes, default: depth] [optional limit value, default: 10 plies, 1000 ms or 1000000 nodes] [optional threads: uint, default: all cores] [optional output file, default: stdout] - analyses the positions on several threads and writes the results as JSON lines"\
+			"\n\treview [pgn file] [optional limit: time|depth|nodes, default: depth] [optional limit value, default: 10 plies, 1000 ms or 1000000 nodes] [optional: compare] - searches the positions of each game from the last one backwards and prints the evaluations and the inaccuracies/mistakes/blunders; compare also searches them forwards to measure the speedup"\
 			"\n\t? - stops the current search and prints the results or makes a move immediately"\
 			"\n\ttest - developer's command, runs all the tests"\
-			"\n\tcompute_eval_err/ceerr [optinal: filename, default: test_suit.fen] - conputes the error of static evaluation for the given positions"\
-			"\n\textract_positions [from: pgn file] [to: fen file, test_suit.fen by default] - extracts positions suitable for ceerr"
+			"\n\tcompute_eval_err/ceerr [optinal: filename, default: test_suit.fen] [optional threads: uint] - conputes the error of static evaluation for the given positions"\
+			"\n\ttune_weights [optional: filename, default: test_suit.fen] [optional epochs: uint, default: 1000] [optional threads: uint] - tunes all the weights with gradient descent, dumps them to tuned_scores.txt"\
+			"\n\ttune_local [optional: filename, default: test_suit.fen] [optional iterations: uint, default: 10] [optional threads: uint] - tunes all the weights with local search, dumps them to tuned_scores.txt"\
+			"\n\tceerr_scaling [optinal: filename, default: test_suit.fen] [optional threads: uints, default: 1 4 16] - measures the speedup of ceerr with the threads count"\
+			"\n\textract_positions [from: pgn file] [to: fen file, test_suit.fen by default] - extracts positions suitable for ceerr, packed if the file is *.cgtp"\
+			"\n\tpack_positions [from: fen file] [to: *.cgtp file] - converts the positions into the compact binary format"
 			<< std::endl;
 	}
 
@@ -158,6 +235,180 @@ namespace engine {
 					io::g_out << io::Color::Red << "Cannot unmake move: " << g_errorMessage << std::endl;
 				} break;
 			CASE_CMD("random", 0, 0) options::g_randomMode = !options::g_randomMode; break;
+			CASE_CMD("lazy_eval", 0, 0)
+				options::g_lazyEval = !options::g_lazyEval;
+				io::g_out << "Lazy evaluation: " << io::Color::Blue << (options::g_lazyEval ? "on" : "off") << std::endl;
+				break;
+			CASE_CMD("syzygy_path", 1, 99)
+				Syzygy::init(std::string(io::getAllArguments()));
+				io::g_out << "Tablebases found: " << io::Color::Blue << Syzygy::tablesCount() << std::endl;
+				break;
+			CASE_CMD("book_file", 1, 99)
+				if (Book::open(std::string(io::getAllArguments()))) {
+					io::g_out << "Book entries: " << io::Color::Blue << Book::entriesCount() << std::endl;
+				} else {
+					io::g_out << io::Color::Red << "Cannot open the book file" << std::endl;
+				} break;
+			CASE_CMD("book", 0, 0) {
+				std::vector<BookEntry> entries;
+				Book::getEntries(g_board, entries);
+
+				io::g_out << "Book moves:" << io::Color::Green;
+				for (const BookEntry& entry : entries) {
+					io::g_out << "\n\t" << Book::fromPolyglotMove(g_board, entry.move) << io::Color::White 
+						<< ", weight " << io::Color::Blue << entry.weight << io::Color::Green;
+				}
+
+				io::g_out << std::endl << "Total moves: " << io::Color::Blue << entries.size() << std::endl;
+			} break;
+			CASE_CMD("build_book", 2, 99) {
+				BookBuildSettings settings;
+				settings.threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+				std::vector<std::string> pgnFiles;
+				for (size_t i = 1; i < args.size(); i++) {
+					const size_t separator = args[i].find('=');
+					if (separator == std::string::npos) {
+						pgnFiles.push_back(args[i]);
+						continue;
+					}
+
+					const std::string name = args[i].substr(0, separator);
+					const u64 value = str_utils::fromString<u64>(args[i].substr(separator + 1));
+					if (name == "min_games") {
+						settings.minGames = static_cast<u32>(value);
+					} else if (name == "depth") {
+						settings.maxPly = static_cast<u32>(value);
+					} else if (name == "threads") {
+						settings.threadsCount = std::max(static_cast<u32>(value), 1u);
+					} else if (name == "memory") {
+						settings.memoryLimit = value << 20;
+					} else {
+						io::g_out << io::Color::Red << "Unknown build_book option: " << name << std::endl;
+					}
+				}
+
+				BookBuildReport report;
+				if (!BookBuilder::build(pgnFiles, args[0], settings, report)) {
+					io::g_out << io::Color::Red << "Failed to build the book" << std::endl;
+					break;
+				}
+
+				io::g_out << "Book built: " << io::Color::Blue << report.games << io::Color::White << " games, "
+					<< io::Color::Blue << report.moves << io::Color::White << " moves counted, "
+					<< io::Color::Blue << report.runs << io::Color::White << " runs spilled, "
+					<< io::Color::Blue << report.entries << io::Color::White << " entries, "
+					<< io::Color::Blue << report.time << io::Color::White << " ms, "
+					<< io::Color::Blue << report.fileSize << io::Color::White << " bytes" << std::endl;
+			} break;
+			CASE_CMD("index_pgn", 1, 3) {
+				const u32 maxPly = args.size() > 1 ? str_utils::fromString<u32>(args[1]) : UINT32_MAX;
+				const u32 threadsCount = args.size() > 2
+					? str_utils::fromString<u32>(args[2])
+					: std::max(std::thread::hardware_concurrency(), 1u);
+
+				PositionIndexReport report;
+				if (!PositionIndex::build(args[0], threadsCount, maxPly, report)) {
+					io::g_out << io::Color::Red << "Failed to index the pgn file" << std::endl;
+					break;
+				}
+
+				io::g_out << "Index built: " << io::Color::Blue << report.games << io::Color::White << " games, "
+					<< io::Color::Blue << report.positions << io::Color::White << " positions, "
+					<< io::Color::Blue << report.time << io::Color::White << " ms, "
+					<< io::Color::Blue << report.fileSize << io::Color::White << " bytes" << std::endl;
+			} break;
+			CASE_CMD("find_games", 1, 2) {
+				const size_t maxGames = args.size() > 1 ? str_utils::fromString<size_t>(args[1]) : 10;
+
+				std::vector<u64> offsets;
+				if (!PositionIndex::find(args[0], g_board, offsets)) {
+					io::g_out << io::Color::Red << "No valid index for the pgn file, use index_pgn first" << std::endl;
+					break;
+				}
+
+				io::g_out << "Games found: " << io::Color::Blue << offsets.size() << io::Color::White;
+				for (size_t i = 0; i < offsets.size() && i < maxGames; i++) {
+					const IndexedGame game = PositionIndex::readGame(args[0], offsets[i]);
+					io::g_out << "\n\t" << io::Color::Blue << game.offset << io::Color::White << ": " << game.white << " - " << game.black
+						<< ", " << io::Color::Green << game.result << io::Color::White << ", " << game.date;
+				}
+
+				io::g_out << std::endl;
+			} break;
+			CASE_CMD("pgn_bench", 1, 99) {
+				using namespace std::chrono;
+
+				PgnReader reader;
+				if (!reader.open(std::string(io::getAllArguments()))) {
+					io::g_out << io::Color::Red << "Cannot open the pgn file" << std::endl;
+					break;
+				}
+
+				const auto start = high_resolution_clock::now();
+
+				PgnGame game;
+				u64 gamesCount = 0;
+				u64 movesCount = 0;
+				u64 corruptedCount = 0;
+				while (reader.readGame(game)) {
+					++gamesCount;
+					movesCount += game.moves.size();
+					corruptedCount += game.isCorrupted;
+				}
+
+				const u64 time = std::max<u64>(duration_cast<milliseconds>(high_resolution_clock::now() - start).count(), 1);
+				io::g_out << "Games: " << io::Color::Blue << gamesCount << io::Color::White << ", moves: "
+					<< io::Color::Blue << movesCount << io::Color::White << ", with unreadable moves: "
+					<< io::Color::Blue << corruptedCount << io::Color::White << ", time: "
+					<< io::Color::Blue << time << io::Color::White << " ms, games/second: "
+					<< io::Color::Blue << gamesCount * 1000 / time << std::endl;
+			} break;
+			CASE_CMD("bitbase_path", 1, 1)
+				Bitbases::init(args[0]);
+				io::g_out << "Bitbases found: " << io::Color::Blue << Bitbases::tablesCount() << std::endl;
+				break;
+			CASE_CMD("generate_bitbase", 1, 2) {
+				BitbaseMaterial material;
+				if (!BitbaseMaterial::fromString(args[0], material)) {
+					io::g_out << io::Color::Red << "Incorrect material, expected something like KRvKN with up to "
+						<< u32(BitbaseMaterial::MAX_PIECES) << " pieces" << std::endl;
+					break;
+				}
+
+				const u32 threadsCount = args.size() > 1
+					? str_utils::fromString<u32>(args[1])
+					: std::max(std::thread::hardware_concurrency(), 1u);
+
+				std::vector<BitbaseGenerationReport> reports;
+				const bool success = BitbaseGenerator::generate(material, threadsCount, reports);
+
+				u64 totalTime = 0;
+				u64 totalSize = 0;
+				for (const BitbaseGenerationReport& report : reports) {
+					io::g_out << report.name << ": " << io::Color::Blue << report.positions << io::Color::White << " positions, "
+						<< io::Color::Blue << report.wins << io::Color::White << " wins, "
+						<< io::Color::Blue << report.draws << io::Color::White << " draws, "
+						<< io::Color::Blue << report.losses << io::Color::White << " losses, "
+						<< io::Color::Blue << report.iterations << io::Color::White << " levels, "
+						<< io::Color::Blue << report.time << io::Color::White << " ms, "
+						<< io::Color::Blue << report.fileSize << io::Color::White << " bytes" << std::endl;
+
+					totalTime += report.time;
+					totalSize += report.fileSize;
+				}
+
+				if (!success) {
+					io::g_out << io::Color::Red << "Failed to write the bitbase into " << Bitbases::path() << std::endl;
+				} else if (reports.empty()) {
+					io::g_out << "The bitbase is already loaded" << std::endl;
+				} else {
+					io::g_out << "Generated " << io::Color::Blue << reports.size() << io::Color::White << " bitbases with "
+						<< io::Color::Blue << threadsCount << io::Color::White << " threads in "
+						<< io::Color::Blue << totalTime << io::Color::White << " ms, "
+						<< io::Color::Blue << totalSize << io::Color::White << " bytes total" << std::endl;
+				}
+			} break;
 			CASE_CMD("force", 0, 0) options::g_forceMode = true; break;
 			CASE_CMD("level", 3, 3) {
 				const u32 control = str_utils::fromString<u32>(args[0]);
@@ -174,6 +425,7 @@ namespace engine {
 			CASE_CMD("set_max_nodes", 1, 1) g_limits.setNodesLimit(str_utils::fromString<u64>(args[0])); break;
 			CASE_CMD("set_max_depth", 1, 1) g_limits.setDepthLimit(str_utils::fromString<u8>(args[0])); break;
 			CASE_CMD("reset_limits", 0, 0) g_limits.makeInfinite(); break;
+			CASE_CMD("threads", 1, 1) g_threadsCount = std::clamp(str_utils::fromString<u32>(args[0]), 1u, MAX_THREADS_COUNT); break;
 			CASE_CMD("go", 0, 0) options::g_forceMode = false; consoleGo(); break;
 			CASE_CMD("history", 0, 0)
 				io::g_out << "History of the moves in the current game (" << g_moveHistory.size() << " moves made):" 
@@ -205,48 +457,136 @@ namespace engine {
 					<< "Time: " << io::Color::Blue << perftTimeInSeconds << io::Color::White << " seconds" << std::endl
 					<< "Kn/S: " << io::Color::Blue << kiloNodesPerSecond << io::Color::White << " kilonodes per second" << std::endl;
 			} break;
+			CASE_CMD("lazy_eval_test", 1, 1) compareLazyEval(str_utils::fromString<u8>(args[0])); break;
+			CASE_CMD("search_stats", 1, 1)
+				if (!SEARCH_STATS_ENABLED) {
+					io::g_out << io::Color::Red << "The search statistics are not compiled in, rebuild with ENABLE_SEARCH_STATS defined" << std::endl;
+				}
+
+				setSearchStatsOutput(args[0] == "off" ? "" : args[0]);
+				break;
+			CASE_CMD("profile", 0, 1)
+				if (args.size() && args[0] == "reset") {
+					profiler::reset();
+				} else {
+					profiler::print();
+				}
+				break;
+			CASE_CMD("bench", 0, 3) Bench::print(Bench::parseSettings(args)); break;
+			CASE_CMD("smp_bench", 0, 4) Bench::printScaling(args); break;
+			CASE_CMD("microbench", 0, 2) Microbench::print(args); break;
+			CASE_CMD("epdtest", 1, 4) EpdTest::print(args); break;
+			CASE_CMD("batch", 1, 5) BatchAnalysis::print(args); break;
+			CASE_CMD("review", 1, 4) GameReview::print(args); break;
 			IGNORE_CMD("?")
 			CASE_CMD("test", 0, 0) {
 				runTests();
 			} break;
-			CASE_CMD_WITH_VARIANT("compute_eval_err", "ceerr", 0, 1) {
+			CASE_CMD_WITH_VARIANT("compute_eval_err", "ceerr", 0, 2) {
 				std::string fileName = args.size() > 0 ? args[0] : "test_suit.fen";
 				Tuning tuning;
 				
 				tuning.loadPositions(fileName);
+				if (args.size() > 1) {
+					tuning.setThreadsCount(str_utils::fromString<u32>(args[1]));
+				}
+
 				double err = tuning.computeErr();
 
 				io::g_out << "Evaluation error: " << io::Color::Blue << std::setprecision(10) << err << std::endl;
 			} break;
+			CASE_CMD("tune_weights", 0, 3) {
+				Tuning tuning;
+				tuning.loadPositions(args.size() > 0 ? args[0] : "test_suit.fen");
+				tuning.setThreadsCount(args.size() > 2
+					? str_utils::fromString<u32>(args[2])
+					: std::max(std::thread::hardware_concurrency(), 1u));
+
+				tuning.optimizeWeights(args.size() > 1 ? str_utils::fromString<u32>(args[1]) : 1000);
+
+				std::ofstream file("tuned_scores.txt");
+				scores::Weights::dump(file);
+				io::g_out << "The weights are dumped to " << io::Color::Blue << "tuned_scores.txt" << std::endl;
+			} break;
+			CASE_CMD("tune_local", 0, 3) {
+				Tuning tuning;
+				tuning.loadPositions(args.size() > 0 ? args[0] : "test_suit.fen");
+				tuning.setThreadsCount(args.size() > 2
+					? str_utils::fromString<u32>(args[2])
+					: std::max(std::thread::hardware_concurrency(), 1u));
+
+				std::vector<u32> weights(scores::Weights::count());
+				std::iota(weights.begin(), weights.end(), 0);
+				tuning.optimizeScores(weights, args.size() > 1 ? str_utils::fromString<u32>(args[1]) : 10);
+
+				std::ofstream file("tuned_scores.txt");
+				scores::Weights::dump(file);
+				io::g_out << "The weights are dumped to " << io::Color::Blue << "tuned_scores.txt" << std::endl;
+			} break;
+			CASE_CMD("ceerr_scaling", 0, 99) {
+				using namespace std::chrono;
+				constexpr u32 RUNS_COUNT = 3;
+
+				std::vector<u32> threadsCounts;
+				for (size_t i = 1; i < args.size(); i++) {
+					threadsCounts.push_back(std::max(str_utils::fromString<u32>(args[i]), 1u));
+				}
+
+				if (threadsCounts.empty()) {
+					threadsCounts = { 1, 4, 16 };
+				}
+
+				Tuning tuning;
+				tuning.loadPositions(args.size() > 0 ? args[0] : "test_suit.fen");
+
+				double baseTime = 0;
+				for (const u32 threadsCount : threadsCounts) {
+					tuning.setThreadsCount(threadsCount);
+
+					const auto start = high_resolution_clock::now();
+					double err = 0;
+					for (u32 i = 0; i < RUNS_COUNT; i++) {
+						err = tuning.computeErr();
+					}
+
+					const double time = duration<double, std::milli>(high_resolution_clock::now() - start).count() / RUNS_COUNT;
+					if (baseTime == 0) {
+						baseTime = time;
+					}
+
+					io::g_out << "Threads: " << io::Color::Blue << threadsCount << io::Color::White << ", time: "
+						<< io::Color::Blue << std::setprecision(4) << time << io::Color::White << " ms, speedup: "
+						<< io::Color::Blue << baseTime / time << io::Color::White << ", error: "
+						<< io::Color::Blue << std::setprecision(10) << err << std::endl;
+				}
+			} break;
 			CASE_CMD("extract_positions", 1, 2) {
 				std::string pgnFileName = args[0];
 				std::string fenFileName = args.size() > 1 ? args[1] : "test_suit.fen";
 
 				Tuning::extractPositions(pgnFileName, fenFileName);
 			} break;
+			CASE_CMD("pack_positions", 2, 2)
+				if (!Tuning::convertPositions(args[0], args[1])) {
+					io::g_out << io::Color::Red << "Cannot convert the positions" << std::endl;
+				}
+
+				break;
 			CMD_DEFAULT
 		}
 
 		return true;
 	}
 
-	void checkConsole(std::string cmd, const std::vector<std::string>& args) {
-		const static Hash s_acceptedCommands[] = { // Commands that are handled right away
+	bool isUrgentConsole(std::string_view cmd) {
+		const static Hash s_urgentCommands[] = {
 			HASH_OF("do"), HASH_OF("undo"), HASH_OF("?"), HASH_OF("q"), HASH_OF("quit")
 		};
 
-		if (!isOneOf(cmd, s_acceptedCommands)) {
-			io::pushCommand(std::move(cmd), args);
-			return;
-		}
+		return isOneOf(cmd, s_urgentCommands);
+	}
 
-		if (cmd == "q" || cmd == "quit") {
-			exit(0);
-		} else { // do, undo, ?
-			engine::stopSearching();
-			if (cmd != "?") {
-				io::pushCommand(std::move(cmd), args); // Would do/undo move in the main handling loop
-			}
-		}
+	bool checkConsole(const std::string& cmd, const std::vector<std::string>& args) {
+		return false; // All of them stop the search and are handled afterwards
 	}
 }
\ No newline at end of file
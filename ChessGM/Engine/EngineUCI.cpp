@@ -23,15 +23,37 @@
 #include "Utils/StringUtils.h"
 #include "Search.h"
 #include "TranspositionTable.h"
+#include "Syzygy.h"
+#include "Bitbases.h"
+#include "Book.h"
 
 namespace engine {
-	void uciGo() {
-		SearchResult result = rootSearch(g_board);
+	// While pondering the search is infinite, its actual limits are applied on ponderhit
+	bool g_isPondering = false;
+	Limits g_ponderLimits;
+	time_t g_ponderTimeLeft = 0;
 
-		io::g_out << "bestmove " << result.best << std::endl;
-		g_board.makeMove(result.best);
+	void uciGo(const bool ponder, const time_t msLeft) {
+		Move best = options::g_ownBook ? Book::probe(g_board) : Move::makeNullMove();
+		if (best.isNullMove()) {
+			if (ponder) {
+				g_isPondering = true;
+				g_ponderLimits = g_limits;
+				g_ponderTimeLeft = msLeft;
+				g_limits.makeInfinite();
+			}
+
+			best = rootSearch(g_board).best;
+			if (g_isPondering) { // Stopped without ponderhit
+				g_isPondering = false;
+				g_limits = g_ponderLimits;
+			}
+		}
+
+		io::g_out << "bestmove " << best << std::endl;
+		g_board.makeMove(best);
 		g_limits.addMoves(1);
-		g_moveHistory.push_back(result.best);
+		g_moveHistory.push_back(best);
 	}
 
 	void handleIncorrectCommandUCI(std::string_view cmd, const std::vector<std::string>& args, CommandError err) {
@@ -44,9 +66,27 @@ namespace engine {
 			CASE_CMD_WITH_VARIANT("quit", "q", 0, 0) return false;
 			CASE_CMD("debug", 1, 1) options::g_debugMode = (args[0] == "on"); break;
 			CASE_CMD("isready", 0, 0) io::g_out << "readyok" << std::endl; break;
-			CASE_CMD("setoption", 4, 6) {
+			CASE_CMD("setoption", 4, 99) {
 				if (args[0] == "name" && args[1] == "Hash" && args[3] == "value") {
 					engine::TranspositionTable::setSize(atoi(args[4].c_str()));
+				} else if (args[0] == "name" && args[1] == "SyzygyPath" && args[2] == "value") {
+					const std::string_view allArguments = io::getAllArguments();
+					Syzygy::init(std::string(allArguments.substr(allArguments.find("value") + 6)));
+					io::g_out << "info string Found " << Syzygy::tablesCount() << " tablebases" << std::endl;
+				} else if (args[0] == "name" && args[1] == "BitbasePath" && args[2] == "value") {
+					const std::string_view allArguments = io::getAllArguments();
+					Bitbases::init(std::string(allArguments.substr(allArguments.find("value") + 6)));
+					io::g_out << "info string Found " << Bitbases::tablesCount() << " bitbases" << std::endl;
+				} else if (args[0] == "name" && args[1] == "Threads" && args[2] == "value") {
+					g_threadsCount = std::clamp(str_utils::fromString<u32>(args[3]), 1u, MAX_THREADS_COUNT);
+				} else if (args[0] == "name" && args[1] == "OwnBook" && args[2] == "value") {
+					options::g_ownBook = (args[3] == "true");
+				} else if (args[0] == "name" && args[1] == "BookFile" && args[2] == "value") {
+					const std::string_view allArguments = io::getAllArguments();
+					const std::string path = std::string(allArguments.substr(allArguments.find("value") + 6));
+					if (!Book::open(path) && path != "<empty>") {
+						io::g_out << "info string Cannot open the book file" << std::endl;
+					}
 				}
 			} break;
 			IGNORE_CMD("register")
@@ -73,12 +113,14 @@ namespace engine {
 				u32 movesTillControl = 0;
 				time_t incTime = 0;
 				time_t timeLeft = 0;
+				time_t msForMove = 0;
+				bool ponder = false;
 
 				for (auto it = args.begin(); it != args.end(); it++) {
 					if (*it == "infinite") {
 						g_limits = Limits();
 					} else if (*it == "movetime") {
-						time_t msForMove = str_utils::fromString<u64>(*(++it));
+						msForMove = str_utils::fromString<u64>(*(++it));
 						g_limits.setTimeLimitsInMs(0, 0, msForMove);
 						g_limits.reset(msForMove);
 					} else if (*it == "nodes") {
@@ -93,7 +135,9 @@ namespace engine {
 					} else if ((*it == "wtime" && g_board.side() == Color::WHITE)
 							 || (*it == "btime" && g_board.side() == Color::BLACK)) {
 						timeLeft = str_utils::fromString<u32>(*(++it));
-					} // TODO: implement searchmoves, ponder, mate
+					} else if (*it == "ponder") {
+						ponder = true;
+					} // TODO: implement searchmoves, mate
 				}
 
 				if (movesTillControl || incTime) {
@@ -104,7 +148,7 @@ namespace engine {
 					g_limits.reset(timeLeft);
 				}
 
-				uciGo();
+				uciGo(ponder, timeLeft ? timeLeft : msForMove);
 			} break;
 			IGNORE_CMD("stop")
 			IGNORE_CMD("ponderhit")
@@ -114,20 +158,32 @@ namespace engine {
 		return true;
 	}
 
-	void checkUCI(std::string cmd, const std::vector<std::string>& args) {
-		const static Hash s_acceptedCommands[] = { // Commands that are handled right away
-			HASH_OF("stop"), HASH_OF("quit")
+	bool isUrgentUCI(std::string_view cmd) {
+		const static Hash s_urgentCommands[] = {
+			HASH_OF("stop"), HASH_OF("isready"), HASH_OF("ponderhit"), HASH_OF("quit"), HASH_OF("q")
 		};
 
-		if (!isOneOf(cmd, s_acceptedCommands)) {
-			io::pushCommand(std::move(cmd), args);
-			return;
-		}
+		return isOneOf(cmd, s_urgentCommands);
+	}
+
+	bool checkUCI(const std::string& cmd, const std::vector<std::string>& args) {
+		if (cmd == "isready") {
+			io::g_out << "readyok" << std::endl;
+			return true;
+		} else if (cmd == "ponderhit") {
+			if (g_isPondering) { // The search goes on with its actual limits, the time counts from now
+				g_isPondering = false;
+				g_limits = g_ponderLimits;
+				if (g_ponderTimeLeft) {
+					g_limits.reset(g_ponderTimeLeft);
+				}
 
-		if (cmd == "quit") {
-			exit(0);
-		} else { // stop
-			engine::stopSearching();
+				updateSearchDeadline();
+			}
+
+			return true;
 		}
+
+		return false; // stop, quit
 	}
 }
\ No newline at end of file
@@ -17,11 +17,14 @@
 */
 
 #include "Engine.h"
+#include <algorithm>
 #include "Utils/CommandHandlingUtils.h"
 #include "Utils/StringUtils.h"
 #include "ChessGMInfo.h"
 #include "Search.h"
 #include "Eval.h"
+#include "Syzygy.h"
+#include "Book.h"
 
 namespace engine {
 	time_t g_timeLeft = 0;
@@ -60,6 +63,16 @@ namespace engine {
 
 	// Makes engine's move in xboard mode
 	void xboardGo() {
+		if (options::g_ownBook) {
+			if (const Move bookMove = Book::probe(g_board); !bookMove.isNullMove()) {
+				io::g_out << "move " << bookMove << std::endl;
+				g_board.makeMove(bookMove);
+				g_limits.addMoves(1);
+				g_moveHistory.push_back(bookMove);
+				return;
+			}
+		}
+
 		g_limits.reset(g_timeLeft);
 
 		SearchResult result = rootSearch(g_board);
@@ -85,23 +98,25 @@ namespace engine {
 		g_moveHistory.push_back(result.best);
 	}
 
-	void xboardAnalyze() {
+	// Returns false on quitting
+	bool xboardAnalyze() {
 		g_limits = Limits();
 		options::g_postMode = true;
 
-		while (true) {
+		while (options::g_analyzeMode) {
 			rootSearch(g_board);
 
-			if (options::g_analyzeMode) {
-				if (io::hasCommandsInQueue()) {
-					std::vector<std::string> args;
-					std::string cmd = io::getCommand(args, true);
-					handleXboard(cmd, args);
+			// The search was stopped by an urgent command, so it is handled along with the ones before it
+			while (io::hasUrgentCommands()) {
+				std::vector<std::string> args;
+				std::string cmd = io::getCommand(args);
+				if (!handleXboard(std::move(cmd), args)) {
+					return false;
 				}
-			} else {
-				break;
 			}
 		}
+
+		return true;
 	}
 
 	///  ERROR HANDLING  ///
@@ -202,43 +217,54 @@ namespace engine {
 			CASE_CMD("analyze", 0, 0)
 				if (!options::g_analyzeMode) {
 					options::g_analyzeMode = true;
-					xboardAnalyze();
+					if (!xboardAnalyze()) {
+						return false;
+					}
 				} break;
-			IGNORE_CMD("exit")
+			CASE_CMD("exit", 0, 0) options::g_analyzeMode = false; break;
 			CASE_CMD("name", 1, 999) {
 				options::g_isPlayingAgainstSelf = (io::getAllArguments().find(ENGINE_NAME) != std::string_view::npos);
 			} break;
 			IGNORE_CMD("rating") // Should inform about opponent's and engine's rating
 			IGNORE_CMD("ics") // Should inform about whether the opponent is local or online
 			CASE_CMD("computer", 0, 0) options::g_isComputerOpponent = true; break;
+			CASE_CMD("cores", 1, 1) g_threadsCount = std::clamp(str_utils::fromString<u32>(args[0]), 1u, MAX_THREADS_COUNT); break;
+			CASE_CMD("egtpath", 2, 99) {
+				if (args[0] == "syzygy") {
+					const std::string_view allArguments = io::getAllArguments();
+					Syzygy::init(std::string(allArguments.substr(allArguments.find("syzygy") + 7)));
+				}
+			} break;
+			CASE_CMD("option", 1, 99) { // option NAME=VALUE
+				const std::string_view allArguments = io::getAllArguments();
+				const size_t separator = allArguments.find('=');
+				const std::string_view name = allArguments.substr(0, separator);
+				const std::string_view value = separator == std::string_view::npos ? "" : allArguments.substr(separator + 1);
+
+				if (name == "OwnBook") {
+					options::g_ownBook = (value == "1");
+				} else if (name == "BookFile" && !Book::open(std::string(value))) {
+					io::g_out << "tellusererror Cannot open the book file" << std::endl;
+				}
+			} break;
 			CMD_DEFAULT
 		}
 
 		return true;
 	}
 
-	void checkXboard(std::string cmd, const std::vector<std::string>& args) {
-		const static Hash s_acceptedCommands[] = { // Commands that are handled right away
+	bool isUrgentXboard(std::string_view cmd) {
+		const static Hash s_urgentCommands[] = {
 			HASH_OF("usermove"), HASH_OF("undo"), HASH_OF("new"), HASH_OF("setboard"), HASH_OF("exit"), 
 			HASH_OF("."), HASH_OF("?"), HASH_OF("q"), HASH_OF("quit")
 		};
 
-		if (!isOneOf(cmd, s_acceptedCommands)) {
-			io::pushCommand(std::move(cmd), args);
-			return;
-		}
-
-		if (cmd == "exit") {
-			options::g_analyzeMode = false;
-		}
+		return isOneOf(cmd, s_urgentCommands);
+	}
 
-		if (cmd == "q" || cmd == "quit") {
-			exit(0);
-		} else { // do, undo, ?
-			engine::stopSearching();
-			if (cmd != "?") {
-				io::pushCommand(std::move(cmd), args); // Would do/undo move in the main handling loop
-			}
-		}
+	bool checkXboard(const std::string& cmd, const std::vector<std::string>& args) {
+		// The analysis status is not supported, so the search just goes on
+		// The others (usermove, undo, new, setboard, exit, ?, quit) stop the search and are handled afterwards
+		return cmd == ".";
 	}
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "EpdTest.h"
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <fstream>
+#include <algorithm>
+#include "Search.h"
+#include "MovePicker.h"
+#include "TranspositionTable.h"
+#include "PawnHashTable.h"
+#include "Options.h"
+#include "Utils/IO.h"
+#include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+
+namespace engine {
+	// The position the current thread is searching and the solution it has found so far
+	static thread_local const EpdPosition* s_position = nullptr;
+	static thread_local EpdPositionResult* s_result = nullptr;
+
+	static bool isSolution(const EpdPosition& position, const Move move) {
+		if (move.isNullMove() || std::find(position.avoidMoves.begin(), position.avoidMoves.end(), move) != position.avoidMoves.end()) {
+			return false;
+		}
+
+		return position.bestMoves.empty()
+			|| std::find(position.bestMoves.begin(), position.bestMoves.end(), move) != position.bestMoves.end();
+	}
+
+	static bool isCoordinateMove(const std::string_view str) {
+		return str.size() >= 4
+			&& str[0] >= 'a' && str[0] <= 'h' && str[1] >= '1' && str[1] <= '8'
+			&& str[2] >= 'a' && str[2] <= 'h' && str[3] >= '1' && str[3] <= '8';
+	}
+
+	// Called after each iteration, the solution is found once the search settles on a correct move
+	static void onIteration(const SearchResult& result, const Depth depth, const MoveList&) {
+		if (!isSolution(*s_position, result.best)) {
+			s_result->isSolved = false;
+		} else if (!s_result->isSolved) {
+			s_result->isSolved = true;
+			s_result->solutionTime = g_limits.elapsedMilliseconds();
+			s_result->solutionNodes = g_nodesCount;
+			s_result->solutionDepth = depth;
+		}
+
+		s_result->depth = depth;
+	}
+
+	bool EpdTest::parse(std::string_view line, EpdPosition& position) {
+		constexpr std::string_view SPACES = " \t\r";
+
+		position = EpdPosition();
+
+		// The first 4 fields are the FEN without the move counters
+		const std::vector<std::string_view> fields = str_utils::split(line, SPACES);
+		if (fields.size() < 5) {
+			return false;
+		}
+
+		position.fen = std::string(fields[0]).append(" ").append(fields[1]).append(" ")
+			.append(fields[2]).append(" ").append(fields[3]).append(" 0 1");
+
+		bool success;
+		const Board board = Board::fromFEN(position.fen, success);
+		if (!success) {
+			return false;
+		}
+
+		// The operations are separated by semicolons
+		const std::string_view operations = line.substr(fields[4].data() - line.data());
+		for (const std::string_view operation : str_utils::split(operations, ";")) {
+			const std::vector<std::string_view> operands = str_utils::split(operation, SPACES);
+			if (operands.empty()) {
+				continue;
+			}
+
+			if (operands[0] == "bm" || operands[0] == "am") {
+				std::vector<Move>& moves = operands[0] == "bm" ? position.bestMoves : position.avoidMoves;
+				for (size_t i = 1; i < operands.size(); i++) {
+					const std::string_view str = operands[i];
+					Move move = board.makeMoveFromSAN(str);
+					if (move.isNullMove() && isCoordinateMove(str)) { // Some suites use the coordinate notation
+						move = board.makeMoveFromString(str);
+					}
+
+					if (move.isNullMove()) {
+						return false;
+					}
+
+					moves.push_back(move);
+				}
+			} else if (operands[0] == "id") {
+				const size_t first = operation.find('"');
+				const size_t last = operation.rfind('"');
+				position.id = first < last ? operation.substr(first + 1, last - first - 1) : operands.back();
+			}
+		}
+
+		return !position.bestMoves.empty() || !position.avoidMoves.empty();
+	}
+
+	bool EpdTest::load(const std::string& fileName, std::vector<EpdPosition>& positions) {
+		std::ifstream file(fileName);
+		if (!file) {
+			return false;
+		}
+
+		std::string line;
+		EpdPosition position;
+		while (std::getline(file, line)) {
+			if (parse(line, position)) {
+				positions.push_back(std::move(position));
+			}
+		}
+
+		return true;
+	}
+
+	EpdTestReport EpdTest::run(const std::vector<EpdPosition>& positions, const EpdTestSettings& settings) {
+		const bool wasPostMode = options::g_postMode;
+		const Limits oldLimits = g_limits;
+
+		options::g_postMode = false;
+
+		EpdTestReport report;
+		report.results.resize(positions.size());
+
+		std::atomic<size_t> nextPosition = 0;
+		const auto start = std::chrono::steady_clock::now();
+
+		ThreadPool pool(std::clamp(settings.threadsCount, 1u, u32(std::max<size_t>(positions.size(), 1))));
+		pool.run([&](const u32 threadId) {
+			// Each thread works with its own search state and its own part of the transposition table,
+			// so the thread 0 (the calling one) must not start the Lazy SMP helpers over the whole table
+			const u32 oldThreadsCount = g_threadsCount;
+			g_threadsCount = 1;
+			g_isInputChecked = false;
+			g_onIteration = onIteration;
+			TranspositionTable::useSlice(threadId, pool.threadsCount());
+
+			for (size_t i = nextPosition++; i < positions.size(); i = nextPosition++) {
+				bool success;
+				Board board = Board::fromFEN(positions[i].fen, success);
+				assert(success);
+
+				s_position = &positions[i];
+				s_result = &report.results[i];
+
+				TranspositionTable::clear();
+				PawnHashTable::reset();
+				initSearch();
+				g_limits.makeFixed(settings.limitType, settings.limit); // Also starts the timer
+
+				const SearchResult result = rootSearch(board);
+
+				s_result->best = result.best;
+				s_result->value = result.value;
+				s_result->time = g_limits.elapsedMilliseconds();
+				s_result->nodes = g_nodesCount;
+			}
+
+			g_threadsCount = oldThreadsCount;
+			g_isInputChecked = true;
+			g_onIteration = nullptr;
+			TranspositionTable::useWholeTable();
+		});
+
+		report.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		for (const EpdPositionResult& result : report.results) {
+			report.solved += result.isSolved;
+			report.nodes += result.nodes;
+		}
+
+		options::g_postMode = wasPostMode;
+		g_limits = oldLimits;
+
+		return report;
+	}
+
+	void EpdTest::print(const std::vector<std::string>& args) {
+		EpdTestSettings settings;
+		if (args.size() > 1) {
+			if (!Limits::parseLimitType(args[1], settings.limitType)) {
+				io::g_out << io::Color::Red << "Unknown limit: " << args[1] << std::endl;
+				return;
+			}
+
+			settings.limit = settings.limitType == LimitType::DEPTH ? 10 : settings.limitType == LimitType::NODES ? 1000000 : 1000;
+		}
+
+		if (args.size() > 2) {
+			settings.limit = str_utils::fromString<u64>(args[2]);
+		}
+
+		settings.threadsCount = args.size() > 3
+			? str_utils::fromString<u32>(args[3])
+			: std::max(std::thread::hardware_concurrency(), 1u);
+
+		std::vector<EpdPosition> positions;
+		if (!EpdTest::load(args[0], positions)) {
+			io::g_out << io::Color::Red << "Failed to read the file " << args[0] << std::endl;
+			return;
+		}
+
+		const EpdTestReport report = run(positions, settings);
+
+		std::vector<u64> solutionTimes;
+		for (size_t i = 0; i < positions.size(); i++) {
+			const EpdPositionResult& result = report.results[i];
+			io::g_out << (result.isSolved ? io::Color::Green : io::Color::Red) << (result.isSolved ? "+ " : "- ")
+				<< io::Color::White << (positions[i].id.empty() ? std::to_string(i + 1) : positions[i].id)
+				<< ": " << result.best.toString() << " (" << result.value << "), depth " << result.depth
+				<< ", " << result.nodes << " nodes, " << result.time << " ms";
+
+			if (result.isSolved) {
+				solutionTimes.push_back(result.solutionTime);
+				io::g_out << "; solved at depth " << result.solutionDepth << " in " 
+					<< result.solutionTime << " ms, " << result.solutionNodes << " nodes";
+			}
+
+			io::g_out << std::endl;
+		}
+
+		std::sort(solutionTimes.begin(), solutionTimes.end());
+		const u64 totalSolutionTime = std::accumulate(solutionTimes.begin(), solutionTimes.end(), u64(0));
+		const u64 time = std::max(report.time, u64(1));
+
+		io::g_out << "Solved: " << io::Color::Blue << report.solved << io::Color::White << " of " << positions.size() << std::endl
+			<< "Time: " << io::Color::Blue << report.time << io::Color::White << " milliseconds" << std::endl
+			<< "Nodes: " << io::Color::Blue << report.nodes << std::endl
+			<< "NPS: " << io::Color::Blue << report.nodes * 1000 / time << std::endl;
+
+		if (!solutionTimes.empty()) {
+			io::g_out << "Time to solution: " << io::Color::Blue << totalSolutionTime / solutionTimes.size() << io::Color::White
+				<< " ms on average, " << io::Color::Blue << solutionTimes[solutionTimes.size() / 2] << io::Color::White
+				<< " ms median" << std::endl;
+		}
+	}
+}
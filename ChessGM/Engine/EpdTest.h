@@ -0,0 +1,85 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Chess/Move.h"
+#include "Limits.h"
+
+/*
+*	EpdTest(.h/.cpp) contains the runner of the EPD test suites (WAC, STS, ECM and so on).
+* 
+*	Each EPD record is a position with the operations, of which "bm" (the best moves), "am" (the moves
+*	to avoid) and "id" are used. The positions are distributed among several worker threads, each of them
+*	searching its positions with its own search state and its own slice of the transposition table.
+*	A position is solved if the search ends with a best move and not an avoided one. The time and nodes
+*	to the solution are taken from the iteration after which the search did not leave the solution anymore.
+*/
+
+namespace engine {
+	struct EpdTestSettings final {
+		LimitType limitType = LimitType::TIME;
+		u64 limit = 1000;
+		u32 threadsCount = 1;
+	};
+
+	struct EpdPosition final {
+		std::string fen; // With the move counters, as Board::fromFEN requires
+		std::string id;
+		std::vector<Move> bestMoves;
+		std::vector<Move> avoidMoves;
+	};
+
+	struct EpdPositionResult final {
+		Move best;
+		Value value = 0;
+		Depth depth = 0; // The last completed iteration
+		u64 time = 0; // In milliseconds
+		NodesCount nodes = 0;
+
+		bool isSolved = false;
+		u64 solutionTime = 0; // The time and nodes to the solution, only if solved
+		NodesCount solutionNodes = 0;
+		Depth solutionDepth = 0;
+	};
+
+	struct EpdTestReport final {
+		std::vector<EpdPositionResult> results; // In the order of the positions
+		u32 solved = 0;
+		u64 time = 0; // The wall time in milliseconds
+		NodesCount nodes = 0;
+	};
+
+	class EpdTest final {
+	public:
+		// Parses a single EPD record, returns false if the position is illegal or has neither bm nor am
+		static bool parse(std::string_view line, EpdPosition& position);
+
+		// Reads all the correct records of the file, returns false if the file cannot be read
+		static bool load(const std::string& fileName, std::vector<EpdPosition>& positions);
+
+		static EpdTestReport run(const std::vector<EpdPosition>& positions, const EpdTestSettings& settings);
+
+		// Parses the arguments [file] [time|depth|nodes] [limit] [optional threads], runs the test 
+		// and prints the result of each position and the summary
+		static void print(const std::vector<std::string>& args);
+	};
+}
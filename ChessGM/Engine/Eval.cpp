@@ -17,9 +17,22 @@
 */
 
 #include "Eval.h"
+#include <array>
+#include <algorithm>
+#include <cassert>
+
 #include "PawnHashTable.h"
+#include "KPKBitbase.h"
+#include "Bitbases.h"
+#include "Options.h"
+#include "Utils/Profiler.h"
 
 namespace engine {
+	// The maximal expected difference between the material+PST score and the full evaluation
+	constexpr Value LAZY_EVAL_MARGIN = 350;
+
+	thread_local EvalStats g_evalStats;
+
 	const BitBoard OUTPOSTS_BB[Color::VALUES_COUNT] = {
 		// Black
 		BitBoard::fromRank(Rank::R5).b_or(BitBoard::fromRank(Rank::R4)).b_or(BitBoard::fromRank(Rank::R3))
@@ -30,101 +43,66 @@ namespace engine {
 			.b_and(BitBoard::fromFile(File::A).b_or(BitBoard::fromFile(File::H)).b_not())
 	};
 
-	// Checks if the current position is drawish from the stonger side's POV
-	template<Color::Value StrongSide>
-	CM_PURE bool isDrawishEndgame(Board& board, const u8 strongMat, const u8 weakMat) {
-		constexpr Color WeakSide = Color(StrongSide).getOpposite();
-
-		switch (strongMat + weakMat) {
-		case 3: return true; // King and a minor piece against a bare king
-		case 6: // King and 2 minor pieces versus a bare king or king and a minor piece versus king and a minor piece
-			if (strongMat == 3) { // King and a minor piece versus king and a minor piece
-				return true;
-			} else { // King and 2 minor pieces versus a bare king
-				if (board.bishops(StrongSide) == BitBoard::EMPTY) { // KNNK since there are no bishops
-					return true;
-				} else if (board.hasOnlySameColoredBishops(StrongSide)) {
-					return true; // King and same-colored bishops versus a bare king
-				} else {
-					return false;
-				}
-			}
-		case 9: // Three minor pieces on the board
-			if (strongMat == 6) { // King and 2 minor pieces versus a king and a minor piece
-				// 2 bishops versus a bishop or 2 minors but bishop pair versus a knight is a draw
-				// 2 same-colored bishops also cannot lead to a win
-				if (board.knights(StrongSide) != BitBoard::EMPTY 
-					|| board.bishops(WeakSide) == BitBoard::EMPTY 
-					|| board.hasOnlySameColoredBishops(StrongSide)) {
-					return true;
-				} else {
-					return false;
-				}
-			} else {
-				return false;
-			}
-		default: return false;
-		}
+	///  ENDGAMES  ///
+
+	// Returned by a specialized endgame evaluator if the general evaluation must be used instead
+	constexpr Value NO_ENDGAME_VALUE = INF + 1;
+
+	// The base value of a won KPK position
+	constexpr Value KPK_WIN = SURE_WIN - 200;
+	constexpr Value KPK_PAWN_ADVANCE = 20;
+
+	// The base value of a position won according to the generated bitbases,
+	// the evaluation within the margin is added so that the search makes progress
+	constexpr Value BITBASE_WIN = SURE_WIN / 2;
+	constexpr Value BITBASE_PROGRESS_MARGIN = 2000;
+
+	// Converts the value from the given side's POV to the moving side's POV
+	template<Color::Value Side>
+	CM_PURE Value fromSidePOV(const Board& board, const Value value) {
+		return board.side() == Side ? value : -value;
 	}
 
-	// Checks if the current position is drawish
-	CM_PURE bool isDrawishEndgame(Board& board) {
-		const u8 wMat = board.materialByColor(Color::WHITE);
-		const u8 bMat = board.materialByColor(Color::BLACK);
-		if (wMat + bMat > 9) { // Does not consider too complex endgames
-			return false;
-		}
+	CM_PURE Value evalDraw(Board&) {
+		return 0;
+	}
 
-		const bool hasWPawns = board.byPiece(Piece::PAWN_WHITE) != BitBoard::EMPTY;
-		const bool hasBPawns = board.byPiece(Piece::PAWN_BLACK) != BitBoard::EMPTY;
-		if (hasWPawns || hasBPawns) { // Does not consider endgames with pawns
-			return false;
-		}
+	// Evaluation in case when there is a bare king versus some pieces and enemy king
+	template<Color::Value StrongSide>
+	CM_PURE Value evalKXK(Board& board) {
+		const Square enemyKing = board.king(Color(StrongSide).getOpposite());
 
-		return wMat > bMat 
-			? isDrawishEndgame<Color::WHITE>(board, wMat, bMat) 
-			: isDrawishEndgame<Color::BLACK>(board, bMat, wMat);
+		return fromSidePOV<StrongSide>(board, SURE_WIN + scores::KING_PUSH_TO_CORNER[enemyKing]);
 	}
 
 	// Endgame with king, knight, bishop versus bare king
+	// The enemy king is pushed to the corner of the bishop's color
 	template<Color::Value StrongSide>
 	CM_PURE Value evalKBNK(Board& board) {
 		const Square enemyKing = board.king(Color(StrongSide).getOpposite());
 		const u8 kingKingTropism = Square::distance(enemyKing, board.king(StrongSide));
 
-		if (board.byPiece(Piece(StrongSide, PieceType::BISHOP)).b_and(BitBoard::fromColor(Color::WHITE))) {
-			constexpr Square corner1 = Square::A8;
-			constexpr Square corner2 = Square::H1;
-
-			return kingKingTropism - std::min(Square::distance(corner1, enemyKing), Square::distance(corner2, enemyKing)) * 5;
+		u8 cornerDistance;
+		if (board.bishops(StrongSide).b_and(BitBoard::fromColor(Color::WHITE))) {
+			cornerDistance = std::min(Square::distance(Square::A8, enemyKing), Square::distance(Square::H1, enemyKing));
 		} else {
-			constexpr Square corner1 = Square::H8;
-			constexpr Square corner2 = Square::A1;
-
-			return kingKingTropism - std::min(Square::distance(corner1, enemyKing), Square::distance(corner2, enemyKing)) * 5;
+			cornerDistance = std::min(Square::distance(Square::H8, enemyKing), Square::distance(Square::A1, enemyKing));
 		}
+
+		return fromSidePOV<StrongSide>(board, SURE_WIN - kingKingTropism - cornerDistance * 5);
 	}
 
-	// Evaluation in case when there is a bare king versus some pieces and enemy king
-	// Returns evaluation from the moving side POV
-	CM_PURE Value evalSoleKingXPieces(Board& board) {
-		Value result = 0;
-		
-		if (board.materialByColor(Color::WHITE) == 0) { // Bare white king
-			if (board.materialByColor(Color::BLACK) == 6 && board.byPiece(Piece::BISHOP_BLACK) && board.byPiece(Piece::KNIGHT_BLACK)) {
-				result = -SURE_WIN + evalKBNK<Color::BLACK>(board);
-			} else {
-				result = -scores::KING_PUSH_TO_CORNER[board.king(Color::WHITE)] - SURE_WIN;
-			}
-		} else {
-			if (board.materialByColor(Color::WHITE) == 6 && board.byPiece(Piece::BISHOP_WHITE) && board.byPiece(Piece::KNIGHT_WHITE)) {
-				result = SURE_WIN - evalKBNK<Color::WHITE>(board);
-			} else {
-				result = scores::KING_PUSH_TO_CORNER[board.king(Color::BLACK)] + SURE_WIN;
-			}
-		}
+	// Endgame with king and 2 bishops versus bare king, a draw if the bishops are of the same color
+	template<Color::Value StrongSide>
+	CM_PURE Value evalKBBK(Board& board) {
+		return board.hasOnlySameColoredBishops(StrongSide) ? 0 : evalKXK<StrongSide>(board);
+	}
 
-		return (-1 + 2 * (board.side() == Color::WHITE)) * result;
+	// Endgame with king and 2 bishops versus king and bishop
+	// Same colored bishops cannot win, otherwise the general evaluation is used
+	template<Color::Value StrongSide>
+	CM_PURE Value evalKBBKB(Board& board) {
+		return board.hasOnlySameColoredBishops(StrongSide) ? 0 : NO_ENDGAME_VALUE;
 	}
 
 	// Evaluation by side for the endgame with pawns and kings only
@@ -166,9 +144,224 @@ namespace engine {
 		return result;
 	}
 
-	// Evaluation by side
+	// Endgame with kings and pawns only
+	CM_PURE Value evalKPsKPs(Board& board) {
+		Value result = evalPawnEndgame<Color::WHITE>(board) - evalPawnEndgame<Color::BLACK>(board);
+		result *= (-1 + 2 * (board.side() == Color::WHITE));
+
+		return result + scores::TEMPO_SCORE.endgame();
+	}
+
+	// Endgame with king and pawn versus bare king, the result is exactly known from the bitbase
+	// A won position is scored higher the more advanced the pawn is, but lower than any KXK position
+	template<Color::Value StrongSide>
+	CM_PURE Value evalKPK(Board& board) {
+		if (!KPKBitbase::probe<StrongSide>(board)) {
+			return 0;
+		}
+
+		const Rank pawnRank = Rank::makeRelativeRank(StrongSide, board.pawns(StrongSide).lsb().getRank());
+		return fromSidePOV<StrongSide>(board, KPK_WIN + KPK_PAWN_ADVANCE * pawnRank);
+	}
+
+
+	///  ENDGAME DISPATCHING  ///
+
+	// Material signature of a side is 8 bits: 2 for each of pawns, knights and bishops count
+	// (saturated to 3), one for whether there are rooks and one for whether there are queens.
+	// The signature of the position is white's signature followed by black's one.
+	constexpr u32 SIDE_SIGNATURE_BITS = 8;
+	constexpr u32 MATERIAL_SIGNATURES_COUNT = 1 << (2 * SIDE_SIGNATURE_BITS);
+
+	CM_PURE constexpr u32 makeSideSignature(const u32 pawns, const u32 knights, const u32 bishops, const u32 rooks, const u32 queens) {
+		return std::min(pawns, 3u)
+			| (std::min(knights, 3u) << 2)
+			| (std::min(bishops, 3u) << 4)
+			| (u32(rooks != 0) << 6)
+			| (u32(queens != 0) << 7);
+	}
+
 	template<Color::Value Side>
-	CM_PURE Score evalSide(Board& board, const PawnHashEntry& entry) {
+	CM_PURE constexpr u32 sideSignature(const u64 materialKey) {
+		const auto count = [materialKey](const PieceType pt) -> u32 {
+			return (materialKey >> (4 * Piece(Side, pt))) & 0xf;
+		};
+
+		return makeSideSignature(count(PieceType::PAWN), count(PieceType::KNIGHT), count(PieceType::BISHOP), 
+			count(PieceType::ROOK), count(PieceType::QUEEN));
+	}
+
+	CM_PURE constexpr u32 materialSignature(const Board& board) {
+		return (sideSignature<Color::WHITE>(board.materialKey()) << SIDE_SIGNATURE_BITS)
+			| sideSignature<Color::BLACK>(board.materialKey());
+	}
+
+	// The endgames that have a specialized evaluation
+	// The order must be the same as in ENDGAME_EVALUATORS
+	enum EndgameType : u8 {
+		GENERAL = 0,
+		DRAW,
+		KPS_KPS,
+		KXK_WHITE, KXK_BLACK,
+		KBNK_WHITE, KBNK_BLACK,
+		KBBK_WHITE, KBBK_BLACK,
+		KBBKB_WHITE, KBBKB_BLACK,
+		KPK_WHITE, KPK_BLACK,
+
+		ENDGAME_TYPES_COUNT
+	};
+
+	using EndgameEvaluator = Value(*)(Board&);
+
+	constexpr EndgameEvaluator ENDGAME_EVALUATORS[ENDGAME_TYPES_COUNT] = {
+		nullptr,
+		evalDraw,
+		evalKPsKPs,
+		evalKXK<Color::WHITE>, evalKXK<Color::BLACK>,
+		evalKBNK<Color::WHITE>, evalKBNK<Color::BLACK>,
+		evalKBBK<Color::WHITE>, evalKBBK<Color::BLACK>,
+		evalKBBKB<Color::WHITE>, evalKBBKB<Color::BLACK>,
+		evalKPK<Color::WHITE>, evalKPK<Color::BLACK>
+	};
+
+	// Chooses the endgame by the material signatures of both sides
+	CM_PURE consteval EndgameType classifyEndgame(const u32 whiteSignature, const u32 blackSignature) {
+		struct SideMaterial {
+			u32 pawns, knights, bishops, rooks, queens;
+
+			constexpr SideMaterial(const u32 signature)
+				: pawns(signature & 3), knights((signature >> 2) & 3), bishops((signature >> 4) & 3), 
+				rooks((signature >> 6) & 1), queens((signature >> 7) & 1) { }
+
+			constexpr u32 minors() const { return knights + bishops; }
+			constexpr bool hasPieces() const { return minors() || rooks || queens; }
+			constexpr bool isBareKing() const { return !pawns && !hasPieces(); }
+		};
+
+		const SideMaterial white = SideMaterial(whiteSignature);
+		const SideMaterial black = SideMaterial(blackSignature);
+		const bool isWhiteStronger = white.minors() > black.minors();
+		const SideMaterial& strong = isWhiteStronger ? white : black;
+		const SideMaterial& weak = isWhiteStronger ? black : white;
+
+		// Pawn endgames
+		if (!white.hasPieces() && !black.hasPieces()) {
+			if (white.pawns == 1 && black.pawns == 0) {
+				return KPK_WHITE;
+			} else if (black.pawns == 1 && white.pawns == 0) {
+				return KPK_BLACK;
+			}
+
+			return KPS_KPS;
+		}
+
+		// Endgames with minor pieces only
+		if (!white.pawns && !black.pawns 
+			&& !white.rooks && !black.rooks 
+			&& !white.queens && !black.queens
+			&& white.minors() + black.minors() <= 3) {
+			switch (strong.minors()) {
+			case 1: return DRAW; // King and a minor piece versus king or king and a minor piece
+			case 2:
+				if (weak.minors() == 0) { // King and 2 minor pieces versus a bare king
+					if (strong.bishops == 0) { // KNNK
+						return DRAW;
+					} else if (strong.knights == 1) {
+						return isWhiteStronger ? KBNK_WHITE : KBNK_BLACK;
+					} else {
+						return isWhiteStronger ? KBBK_WHITE : KBBK_BLACK;
+					}
+				} else { // King and 2 minor pieces versus a king and a minor piece
+					// 2 minors but bishop pair versus a knight is a draw
+					if (strong.knights != 0 || weak.bishops == 0) {
+						return DRAW;
+					} else {
+						return isWhiteStronger ? KBBKB_WHITE : KBBKB_BLACK;
+					}
+				}
+			default: break;
+			}
+		}
+
+		// Bare king versus some pieces
+		if (black.isBareKing()) {
+			return KXK_WHITE;
+		} else if (white.isBareKing()) {
+			return KXK_BLACK;
+		}
+
+		return GENERAL;
+	}
+
+	CM_PURE consteval std::array<u8, MATERIAL_SIGNATURES_COUNT> generateEndgameTable() {
+		std::array<u8, MATERIAL_SIGNATURES_COUNT> result { };
+
+		for (u32 whiteSignature = 0; whiteSignature < (1 << SIDE_SIGNATURE_BITS); ++whiteSignature) {
+			for (u32 blackSignature = 0; blackSignature < (1 << SIDE_SIGNATURE_BITS); ++blackSignature) {
+				result[(whiteSignature << SIDE_SIGNATURE_BITS) | blackSignature] = classifyEndgame(whiteSignature, blackSignature);
+			}
+		}
+
+		return result;
+	}
+
+	// The endgame type for each material signature
+	constexpr std::array<u8, MATERIAL_SIGNATURES_COUNT> ENDGAME_TABLE = generateEndgameTable();
+
+	static_assert(ENDGAME_TABLE[makeSideSignature(8, 2, 2, 2, 1) << SIDE_SIGNATURE_BITS | makeSideSignature(8, 2, 2, 2, 1)] == GENERAL);
+	static_assert(ENDGAME_TABLE[makeSideSignature(0, 1, 1, 0, 0) << SIDE_SIGNATURE_BITS] == KBNK_WHITE);
+	static_assert(ENDGAME_TABLE[makeSideSignature(0, 0, 0, 0, 0) << SIDE_SIGNATURE_BITS | makeSideSignature(1, 0, 0, 0, 0)] == KPK_BLACK);
+
+
+	///  TRACING  ///
+
+	// Adds the weight's coefficient for the side to the dense coefficients of the traced evaluation
+	template<bool Traced, Color::Value Side>
+	INLINE void traceWeight(i16* coefficients, const Score& weight, const i16 count = 1) {
+		if constexpr (Traced) {
+			coefficients[scores::Weights::indexOf(weight)] += Side == Color::WHITE ? count : -count;
+		}
+	}
+
+	// Traces the pre-evaluated pawn structure of the side, the same as in PawnHashTable::scanPawns
+	template<Color::Value Side>
+	void tracePawns(i16* coefficients, const PawnHashEntry& entry) {
+		const BitBoard pawns = entry.pawns[Side];
+
+		BitBoard pieces = pawns.b_and(pawns.pawnAttackedSquares<Side>());
+		BB_FOR_EACH(sq, pieces) {
+			traceWeight<true, Side>(coefficients, scores::DEFENDED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())]);
+		}
+
+		pieces = pawns.b_and(entry.passed);
+		BB_FOR_EACH(sq, pieces) {
+			traceWeight<true, Side>(coefficients, scores::PASSED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())]);
+		}
+
+		traceWeight<true, Side>(coefficients, scores::ISOLATED_PAWN, pawns.b_and(entry.isolated).popcnt());
+		traceWeight<true, Side>(coefficients, scores::DOUBLE_PAWN, pawns.b_and(entry.doubled).popcnt());
+		traceWeight<true, Side>(coefficients, scores::BACKWARD_PAWN, pawns.b_and(entry.backward).popcnt());
+		traceWeight<true, Side>(coefficients, scores::PAWN_ISLANDS[std::min(entry.islandsCount[Side], u8(4))]);
+		traceWeight<true, Side>(coefficients, scores::PAWN_DISTORTION, entry.distortion[Side]);
+	}
+
+	// Traces the piece values and the piece-square tables, i.e. the incremental score of the board
+	void tracePieces(i16* coefficients, const Board& board) {
+		BitBoard pieces = board.allPieces();
+		BB_FOR_EACH(sq, pieces) {
+			const Piece piece = board[sq];
+			const i16 sign = piece.getColor() == Color::WHITE ? 1 : -1;
+
+			coefficients[scores::Weights::indexOf(scores::PIECE_VALUE[piece.getType()])] += sign;
+			coefficients[scores::Weights::pstIndexOf(piece, sq)] += sign;
+		}
+	}
+
+
+	// Evaluation by side
+	// If traced, the coefficients of the weights are added to <coefficients> (except for the pawn structure and PST)
+	template<Color::Value Side, bool Traced = false>
+	CM_PURE Score evalSide(Board& board, const PawnHashEntry& entry, i16* coefficients = nullptr) {
 		constexpr Color::Value OppositeSide = Color(Side).getOpposite().value();
 		constexpr Direction::Value Up = Direction::makeRelativeDirection(Side, Direction::UP).value();
 		constexpr Direction::Value Down = Direction::makeRelativeDirection(Side, Direction::DOWN).value();
@@ -199,12 +392,14 @@ namespace engine {
 				Square rookSq = Side == Color::WHITE ? rooksBehind.msb() : rooksBehind.lsb();
 				if (occ.b_and(BitBoard::betweenBits(sq, rookSq)) == BitBoard::EMPTY) { // Nothing between the rook and the passed
 					result += scores::ROOK_BEHIND_PASSED_PAWN;
+					traceWeight<Traced, Side>(coefficients, scores::ROOK_BEHIND_PASSED_PAWN);
 				}
 			}
 
 			// Blocked passed
 			if (board[sq.shift(Up)] == Piece(OppositeSide, PieceType::KNIGHT) || board[sq.shift(Up)] == Piece(OppositeSide, PieceType::BISHOP)) {
 				result += scores::MINOR_PASSED_BLOCKED;
+				traceWeight<Traced, Side>(coefficients, scores::MINOR_PASSED_BLOCKED);
 			}
 		}
 
@@ -217,10 +412,12 @@ namespace engine {
 
 			// Mobility
 			result += scores::KNIGHT_MOBILITY[attacks.popcnt()];
+			traceWeight<Traced, Side>(coefficients, scores::KNIGHT_MOBILITY[attacks.popcnt()]);
 
 			// Outpost
 			if (outpostSquares.test(sq) && BitBoard::directionBits<Up>(sq).b_and(enemyPawnsAttacks) == BitBoard::EMPTY) {
 				result += scores::OUTPOST * 2;
+				traceWeight<Traced, Side>(coefficients, scores::OUTPOST, 2);
 			}
 		}
 
@@ -230,6 +427,7 @@ namespace engine {
 		// Bishop pair
 		if (board.hasDifferentColoredBishops(Side)) {
 			result += scores::BISHOP_PAIR;
+			traceWeight<Traced, Side>(coefficients, scores::BISHOP_PAIR);
 		}
 
 		pieces = board.bishops(Side);
@@ -238,10 +436,12 @@ namespace engine {
 
 			// Mobility
 			result += scores::BISHOP_MOBILITY[attacks.popcnt()];
+			traceWeight<Traced, Side>(coefficients, scores::BISHOP_MOBILITY[attacks.popcnt()]);
 
 			// Outpost
 			if (outpostSquares.test(sq) && BitBoard::directionBits<Up>(sq).b_and(enemyPawnsAttacks) == BitBoard::EMPTY) {
 				result += scores::OUTPOST;
+				traceWeight<Traced, Side>(coefficients, scores::OUTPOST);
 			}
 		}
 
@@ -254,13 +454,16 @@ namespace engine {
 
 			// Mobility
 			result += scores::ROOK_MOBILITY[attacks.popcnt()];
+			traceWeight<Traced, Side>(coefficients, scores::ROOK_MOBILITY[attacks.popcnt()]);
 
 			// Rook on (semi)open file
 			if (entry.mostAdvanced[Side][sq.getFile() + 1] == Rank1) { // No our pawns on the file
 				if (entry.mostAdvanced[OppositeSide][sq.getFile() + 1] == Rank8) { // No enemy pawns as well
 					result += scores::ROOK_ON_OPEN_FILE;
+					traceWeight<Traced, Side>(coefficients, scores::ROOK_ON_OPEN_FILE);
 				} else {
 					result += scores::ROOK_ON_SEMIOPEN_FILE;
+					traceWeight<Traced, Side>(coefficients, scores::ROOK_ON_SEMIOPEN_FILE);
 				}
 			}
 		}
@@ -274,27 +477,43 @@ namespace engine {
 
 			// Mobility
 			result += scores::QUEEN_MOBILITY[attacks.popcnt()];
+			traceWeight<Traced, Side>(coefficients, scores::QUEEN_MOBILITY[attacks.popcnt()]);
 		}
 		
 
 		return result;
 	}
 
-	Value eval(Board& board) {
+	// The evaluation without the generated bitbases
+	Value evalPosition(Board& board, const Value alpha, const Value beta) {
+		///  ENDGAMES  ///
 
+		if (const u8 endgame = ENDGAME_TABLE[materialSignature(board)]; endgame != GENERAL) {
+			if (const Value result = ENDGAME_EVALUATORS[endgame](board); result != NO_ENDGAME_VALUE) {
+				return result;
+			}
+		}
 
-		///  ENDGAMES  ///
+		const Material material = board.materialByColor(Color::WHITE) + board.materialByColor(Color::BLACK);
+		const Value sideSign = (-1 + 2 * (board.side() == Color::WHITE));
+		const Value tempo = scores::TEMPO_SCORE.collapse(material);
 
-		if (!board.hasNonPawns(Color::WHITE) && !board.hasNonPawns(Color::BLACK)) { // Pawn endgame
-			Value result = evalPawnEndgame<Color::WHITE>(board) - evalPawnEndgame<Color::BLACK>(board);
-			result *= (-1 + 2 * (board.side() == Color::WHITE));
 
-			return result + scores::TEMPO_SCORE.endgame();
-		} else if (isDrawishEndgame(board)) { // Drawish endgame
-			return 0;
-		} else if (board.materialByColor(Color::WHITE) == 0 || board.materialByColor(Color::BLACK) == 0) { // KXK
-			return evalSoleKingXPieces(board);
-		} 
+		///  LAZY EVALUATION  ///
+
+		// The incremental score is already known, so if even with a margin it is outside
+		// of the window, the rest of the evaluation would not matter.
+		// The bound is returned instead of the score itself so as to keep stand pat and delta pruning sound
+		if (options::g_lazyEval) {
+			const Value lazyResult = sideSign * board.score().collapse(material) + tempo;
+			if (lazyResult - LAZY_EVAL_MARGIN >= beta) {
+				++g_evalStats.lazyExits;
+				return lazyResult - LAZY_EVAL_MARGIN;
+			} else if (lazyResult + LAZY_EVAL_MARGIN <= alpha) {
+				++g_evalStats.lazyExits;
+				return lazyResult + LAZY_EVAL_MARGIN;
+			}
+		}
 
 
 		// General evaluation
@@ -304,10 +523,63 @@ namespace engine {
 
 		///  RESULTS  ///
 
-		Material material = board.materialByColor(Color::WHITE) + board.materialByColor(Color::BLACK);
-		Value result = score.collapse(material);
-		result *= (-1 + 2 * (board.side() == Color::WHITE));
+		return sideSign * score.collapse(material) + tempo;
+	}
+
+	Value eval(Board& board, const Value alpha, const Value beta) {
+		PROFILE_ZONE(EVAL);
+		++g_evalStats.calls;
+
+		// The generated bitbases know the exact result, but not how to achieve it
+		if (BitbaseResult result; Bitbases::probe(board, result)) {
+			if (result == BitbaseResult::DRAW) {
+				return 0;
+			}
+
+			const Value progress = std::clamp(evalPosition(board, -INF, INF), Value(-BITBASE_PROGRESS_MARGIN), BITBASE_PROGRESS_MARGIN);
+			return result == BitbaseResult::WIN ? BITBASE_WIN + progress : -BITBASE_WIN + progress;
+		}
+
+		return evalPosition(board, alpha, beta);
+	}
+
+	void traceEval(Board& board, EvalTrace& trace) {
+		const Material material = board.materialByColor(Color::WHITE) + board.materialByColor(Color::BLACK);
+		trace.coefficients.clear();
+		trace.phase = material.interpolate(1.f, 0.f);
+		trace.isLinear = false;
+
+		// The bitbases and the specialized endgames are not linear in the weights
+		if (BitbaseResult result; Bitbases::probe(board, result)) {
+			return;
+		}
+
+		if (const u8 endgame = ENDGAME_TABLE[materialSignature(board)]; endgame != GENERAL) {
+			if (ENDGAME_EVALUATORS[endgame](board) != NO_ENDGAME_VALUE) {
+				return;
+			}
+		}
+
+		thread_local std::vector<i16> s_coefficients;
+		s_coefficients.assign(scores::Weights::count(), 0);
+
+		const PawnHashEntry& entry = PawnHashTable::getOrScanPHE(board);
+		tracePieces(s_coefficients.data(), board);
+		tracePawns<Color::WHITE>(s_coefficients.data(), entry);
+		tracePawns<Color::BLACK>(s_coefficients.data(), entry);
+		[[maybe_unused]] const Score tracedScore = evalSide<Color::WHITE, true>(board, entry, s_coefficients.data())
+			- evalSide<Color::BLACK, true>(board, entry, s_coefficients.data());
+		assert(tracedScore == evalSide<Color::WHITE>(board, entry) - evalSide<Color::BLACK>(board, entry));
+
+		// Tempo is given to the moving side
+		s_coefficients[scores::Weights::indexOf(scores::TEMPO_SCORE)] += board.side() == Color::WHITE ? 1 : -1;
+
+		for (u32 i = 0; i < s_coefficients.size(); i++) {
+			if (s_coefficients[i]) {
+				trace.coefficients.emplace_back(u16(i), s_coefficients[i]);
+			}
+		}
 
-		return result + scores::TEMPO_SCORE.collapse(material);
+		trace.isLinear = true;
 	}
 }
\ No newline at end of file
@@ -17,6 +17,7 @@
 */
 
 #pragma once
+#include <vector>
 #include "Chess/Board.h"
 
 /*
@@ -37,9 +38,40 @@
 *		11) Pawn islands
 *		12) Pawn distortion
 * 
-*		13) Separate evaluation functions for: KXK, KPsKPS, KBNK, some drawish endgames
+*		13) Separate evaluation functions for: KXK, KPsKPS, KPK, KBNK, KBBK, some drawish endgames,
+*			chosen with a compile-time table indexed by the material signature,
+*			KPK is scored exactly with the bitbase generated at startup
+* 
+*		14) Lazy evaluation - if the incremental material+PST score is far outside of
+*			the given window, the full evaluation is skipped
+* 
+*		15) The generated bitbases (see Bitbases) - a draw is returned as is, a win or a loss
+*			is scored far beyond the usual evaluation
 */
 
 namespace engine {
-	Value eval(Board& board);
+	// Statistics on the evaluation calls, reset by the user of the counters
+	// Each thread has its own counters, so that the parallel evaluations (tuning) do not race
+	struct EvalStats final {
+		NodesCount calls = 0;
+		NodesCount lazyExits = 0;
+	};
+
+	extern thread_local EvalStats g_evalStats;
+
+	// Returns the static evaluation from the moving side POV
+	// If the window is given, the evaluation can return early with a bound
+	// of the incremental score once it is unlikely to fall into [alpha, beta]
+	Value eval(Board& board, const Value alpha = -INF, const Value beta = INF);
+
+	// The evaluation of a position as the coefficients of the tunable weights (see scores::Weights)
+	struct EvalTrace final {
+		std::vector<std::pair<u16, i16>> coefficients; // Sparse, the weight's index and its coefficient from white's POV
+		float phase; // The middlegame share of a weight, the endgame one is (1 - phase)
+		bool isLinear; // False if the position is evaluated by the bitbases or a specialized endgame evaluator
+	};
+
+	// Fills the trace, so that for a linear position the evaluation from white's POV is
+	// the sum of the collapsed weights multiplied by the coefficients, up to the rounding
+	void traceEval(Board& board, EvalTrace& trace);
 }
@@ -0,0 +1,246 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "GameReview.h"
+#include <algorithm>
+#include <iomanip>
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "PawnHashTable.h"
+#include "Scores.h"
+#include "Options.h"
+#include "Utils/IO.h"
+#include "Utils/StringUtils.h"
+
+namespace engine {
+	// The depth of the last completed iteration of the current search
+	static thread_local Depth s_lastDepth = 0;
+
+	static void onIteration(const SearchResult&, const Depth depth, const MoveList&) {
+		s_lastDepth = depth;
+	}
+
+	// Searches the position and accounts the cost of the search in the pass
+	static SearchResult searchPosition(Board& board, const ReviewSettings& settings, ReviewPass& pass, Depth& depth) {
+		depth = 0;
+		if (!board.hasLegalMoves()) { // The game has ended with a mate or a stalemate
+			return SearchResult { .best = Move::makeNullMove(), .value = Value(board.isInCheck() ? -MATE : 0) };
+		}
+
+		s_lastDepth = 0;
+		g_limits.makeFixed(settings.limitType, settings.limit); // Also starts the timer
+
+		const SearchResult result = rootSearch(board);
+
+		depth = s_lastDepth;
+		pass.time += g_limits.elapsedMilliseconds();
+		pass.nodes += g_nodesCount;
+		pass.depths += depth;
+
+		return result;
+	}
+
+	bool GameReview::review(const PgnGame& game, const ReviewSettings& settings, GameReport& report) {
+		bool success;
+		Board board = Board::fromFEN(game.initialFen, success);
+		if (!success) {
+			return false;
+		}
+
+		const bool wasPostMode = options::g_postMode;
+		const bool wasInputChecked = g_isInputChecked;
+		const u32 oldThreadsCount = g_threadsCount;
+		const Limits oldLimits = g_limits;
+
+		// A single thread, so that the forward and backward passes search the same way
+		options::g_postMode = false;
+		g_isInputChecked = false;
+		g_threadsCount = 1;
+		g_onIteration = onIteration;
+
+		const size_t movesCount = game.moves.size();
+		std::vector<SearchResult> results(movesCount + 1);
+		std::vector<Depth> depths(movesCount + 1);
+
+		report = GameReport();
+		if (settings.compareWithForward) {
+			TranspositionTable::clear();
+			PawnHashTable::reset();
+			initSearch();
+
+			for (size_t ply = 0; ply <= movesCount; ply++) {
+				Depth depth;
+				searchPosition(board, settings, report.forward, depth);
+				if (ply < movesCount) {
+					board.makeMove(game.moves[ply]);
+				}
+			}
+		} else {
+			for (Move move : game.moves) {
+				board.makeMove(move);
+			}
+		}
+
+		// From the last position backwards, the board keeps the game's history for the repetitions
+		TranspositionTable::clear();
+		PawnHashTable::reset();
+		initSearch();
+
+		for (size_t ply = movesCount + 1; ply-- > 0; ) {
+			results[ply] = searchPosition(board, settings, report.backward, depths[ply]);
+			if (ply > 0) {
+				board.unmakeMove(game.moves[ply - 1]);
+			}
+		}
+
+		// A mate is counted as MATE_CENTIPAWNS centipawns (about a queen), so the losses stay comparable
+		const auto clampValue = [](const Value value) {
+			return std::clamp(i32(value), -i32(MATE_CENTIPAWNS), i32(MATE_CENTIPAWNS));
+		};
+
+		for (size_t ply = 0; ply < movesCount; ply++) {
+			ReviewedMove reviewed;
+			reviewed.move = game.moves[ply];
+			reviewed.best = results[ply].best;
+			reviewed.value = results[ply].value;
+			reviewed.valueAfter = -results[ply + 1].value;
+			reviewed.loss = reviewed.move == reviewed.best
+				? 0 // The difference is due to the search only
+				: Value(std::max(clampValue(reviewed.value) - clampValue(reviewed.valueAfter), 0));
+			reviewed.depth = depths[ply];
+			reviewed.mark = reviewed.loss >= BLUNDER_LOSS
+				? MoveMark::BLUNDER
+				: reviewed.loss >= MISTAKE_LOSS
+					? MoveMark::MISTAKE
+					: reviewed.loss >= INACCURACY_LOSS
+						? MoveMark::INACCURACY
+						: MoveMark::NONE;
+
+			report.moves.push_back(reviewed);
+		}
+
+		options::g_postMode = wasPostMode;
+		g_isInputChecked = wasInputChecked;
+		g_threadsCount = oldThreadsCount;
+		g_onIteration = nullptr;
+		g_limits = oldLimits;
+
+		return true;
+	}
+
+	// Returns the value in centipawns or as a mate for the white side
+	static std::string valueToString(const Value value, const Color side) {
+		const Value whiteValue = side == Color::WHITE ? value : -value;
+		if (isMateValue(whiteValue)) {
+			return whiteValue < 0 ? "-M" + std::to_string(gettingMatedIn(whiteValue)) : "M" + std::to_string(givingMateIn(whiteValue));
+		}
+
+		return std::to_string(whiteValue);
+	}
+
+	void GameReview::print(const std::vector<std::string>& args) {
+		constexpr std::string_view MARKS[] = { "", "?!", "?", "??" };
+
+		ReviewSettings settings;
+		if (args.size() > 1) {
+			if (!Limits::parseLimitType(args[1], settings.limitType)) {
+				io::g_out << io::Color::Red << "Unknown limit: " << args[1] << std::endl;
+				return;
+			}
+
+			settings.limit = settings.limitType == LimitType::DEPTH ? 10 : settings.limitType == LimitType::NODES ? 1000000 : 1000;
+		}
+
+		if (args.size() > 2) {
+			settings.limit = str_utils::fromString<u64>(args[2]);
+		}
+
+		settings.compareWithForward = args.size() > 3 && args[3] == "compare";
+
+		PgnReader reader;
+		if (!reader.open(args[0])) {
+			io::g_out << io::Color::Red << "Cannot open the pgn file" << std::endl;
+			return;
+		}
+
+		PgnGame game;
+		GameReport report;
+		for (u32 gameIndex = 1; reader.readGame(game); gameIndex++) {
+			if (!review(game, settings, report)) {
+				io::g_out << io::Color::Red << "Game " << gameIndex << " has an incorrect initial position" << std::endl;
+				continue;
+			}
+
+			io::g_out << io::Color::Yellow << "Game " << gameIndex << (game.isCorrupted ? " (till the first unreadable move)" : "") << std::endl;
+
+			// The move numbers are counted from the initial position's full move number
+			const std::vector<std::string_view> fenFields = str_utils::split(game.initialFen, " ");
+			const Color initialSide = fenFields[1] == "b" ? Color::BLACK : Color::WHITE;
+			const u32 initialMoveNumber = fenFields.size() > 5 ? std::max(str_utils::fromString<u32>(fenFields[5]), 1u) : 1;
+
+			Color side = initialSide;
+			u32 marks[Color::VALUES_COUNT][std::size(MARKS)] = { };
+			u64 losses[Color::VALUES_COUNT] = { 0, 0 };
+			u32 moves[Color::VALUES_COUNT] = { 0, 0 };
+
+			for (size_t ply = 0; ply < report.moves.size(); ply++, side = side.getOpposite()) {
+				const ReviewedMove& move = report.moves[ply];
+				marks[side][u8(move.mark)]++;
+				losses[side] += move.loss;
+				moves[side]++;
+
+				io::g_out << io::Color::White << std::setw(4) << (initialMoveNumber + (ply + (initialSide == Color::BLACK)) / 2)
+					<< (side == Color::WHITE ? ".    " : "... ") << std::left << std::setw(6) << move.move.toString() << std::right
+					<< std::setw(7) << valueToString(move.valueAfter, side) << " (depth " << std::setw(2) << move.depth << ")";
+
+				if (move.mark != MoveMark::NONE) {
+					io::g_out << (move.mark == MoveMark::BLUNDER ? io::Color::Red : io::Color::Yellow) << ' ' << MARKS[u8(move.mark)]
+						<< io::Color::White << " best " << move.best.toString() << " (" << valueToString(move.value, side) << "), loss " << move.loss;
+				}
+
+				io::g_out << std::endl;
+			}
+
+			for (const Color color : { Color::WHITE, Color::BLACK }) {
+				io::g_out << (color == Color::WHITE ? "White: " : "Black: ")
+					<< io::Color::Blue << marks[color][u8(MoveMark::INACCURACY)] << io::Color::White << " inaccuracies, "
+					<< io::Color::Blue << marks[color][u8(MoveMark::MISTAKE)] << io::Color::White << " mistakes, "
+					<< io::Color::Blue << marks[color][u8(MoveMark::BLUNDER)] << io::Color::White << " blunders, average loss "
+					<< io::Color::Blue << losses[color] / std::max(moves[color], 1u) << io::Color::White << " centipawns" << std::endl;
+			}
+
+			const size_t positions = report.moves.size() + 1;
+			io::g_out << "Backward: " << io::Color::Blue << report.backward.time << io::Color::White << " ms, "
+				<< io::Color::Blue << report.backward.nodes << io::Color::White << " nodes, average depth "
+				<< io::Color::Blue << std::fixed << std::setprecision(1) << double(report.backward.depths) / positions << std::defaultfloat << std::endl;
+
+			if (settings.compareWithForward) {
+				io::g_out << io::Color::White << "Forward: " << io::Color::Blue << report.forward.time << io::Color::White << " ms, "
+					<< io::Color::Blue << report.forward.nodes << io::Color::White << " nodes, average depth "
+					<< io::Color::Blue << std::fixed << std::setprecision(1) << double(report.forward.depths) / positions << std::endl
+					<< io::Color::White << "Speedup of backward: " << io::Color::Blue << std::setprecision(2)
+					<< double(report.forward.time) / std::max(report.backward.time, u64(1)) << io::Color::White << "x in time, "
+					<< io::Color::Blue << double(report.forward.nodes) / std::max(report.backward.nodes, NodesCount(1)) << io::Color::White
+					<< "x in nodes, " << io::Color::Blue << std::showpos << std::setprecision(1)
+					<< double(i64(report.backward.depths) - i64(report.forward.depths)) / positions << std::noshowpos << io::Color::White
+					<< " in average depth" << std::defaultfloat << std::endl;
+			}
+		}
+	}
+}
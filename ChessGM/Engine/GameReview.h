@@ -0,0 +1,91 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "PgnReader.h"
+#include "Limits.h"
+
+/*
+*	GameReview(.h/.cpp) contains the review of the games from a pgn file.
+* 
+*	The game is replayed and its positions are searched from the last one backwards with the same
+*	transposition table, which is not cleared in between. So the results of the deeper searches near
+*	the end of the game are found in the table while searching the earlier positions, as they often
+*	transpose to the same endgames. Each move is compared with the best move of its position: the loss is
+*	the difference between the value of the position and the value after the move, and the moves that
+*	lose much are marked as inaccuracies, mistakes, or blunders.
+*	Optionally, the game is searched in the forward order as well to measure the gain.
+*/
+
+namespace engine {
+	struct ReviewSettings final {
+		LimitType limitType = LimitType::DEPTH;
+		u64 limit = 10;
+		bool compareWithForward = false; // Also search the positions from the first one to measure the speedup
+	};
+
+	enum class MoveMark : u8 {
+		NONE = 0,
+		INACCURACY,
+		MISTAKE,
+		BLUNDER
+	};
+
+	struct ReviewedMove final {
+		Move move;
+		Move best;
+		Value value = 0; // Of the position before the move, for the side that makes it
+		Value valueAfter = 0; // Of the position after the move, for the same side
+		Value loss = 0; // In centipawns, a mate is counted as MATE_CENTIPAWNS
+		Depth depth = 0;
+		MoveMark mark = MoveMark::NONE;
+	};
+
+	// The cost of searching all the positions of a game in one order
+	struct ReviewPass final {
+		u64 time = 0; // In milliseconds
+		NodesCount nodes = 0;
+		Depth depths = 0; // The sum of the depths reached
+	};
+
+	struct GameReport final {
+		std::vector<ReviewedMove> moves;
+		ReviewPass backward;
+		ReviewPass forward; // Only if compared
+	};
+
+	class GameReview final {
+	public:
+		constexpr inline static Value MATE_CENTIPAWNS = 1000;
+		constexpr inline static Value INACCURACY_LOSS = 50;
+		constexpr inline static Value MISTAKE_LOSS = 100;
+		constexpr inline static Value BLUNDER_LOSS = 200;
+
+	public:
+		// Returns false if the game's initial position is incorrect
+		static bool review(const PgnGame& game, const ReviewSettings& settings, GameReport& report);
+
+		// Parses the arguments [pgn file] [time|depth|nodes] [limit] [compare], reviews
+		// all the games of the file and prints the moves with their evaluations and marks
+		static void print(const std::vector<std::string>& args);
+	};
+}
@@ -0,0 +1,141 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "KPKBitbase.h"
+#include <vector>
+#include <cstring>
+
+namespace engine {
+	u64 KPKBitbase::s_bitbase[POSITIONS_COUNT / 64];
+
+	// Results are bit flags, so that the results of all the successors can be merged with OR
+	enum KPKResult : u8 {
+		INVALID = 0,
+		UNKNOWN = 1,
+		DRAW = 2,
+		WIN = 4
+	};
+
+	// The position decoded from the bitbase index
+	struct KPKPosition final {
+		Color side;
+		Square whiteKing;
+		Square blackKing;
+		Square pawn;
+
+		INLINE KPKPosition(const u32 index) noexcept
+			: side(Color::Value((index >> 12) & 1)),
+			whiteKing(Square::Value(index & 63)),
+			blackKing(Square::Value((index >> 6) & 63)),
+			pawn(Square::Value(((index >> 13) & 3) + 8 * (Rank::R7 - (index >> 15)))) { }
+	};
+
+	// The result that can be determined without looking at the successors
+	CM_PURE KPKResult classifyInitially(const KPKPosition& pos) noexcept {
+		const BitBoard whiteKingAttacks = BitBoard::pseudoAttacks<PieceType::KING>(pos.whiteKing);
+		const BitBoard blackKingAttacks = BitBoard::pseudoAttacks<PieceType::KING>(pos.blackKing);
+		const BitBoard pawnAttacks = BitBoard::pawnAttacks(Color::WHITE, pos.pawn);
+
+		// Kings next to each other, overlapping pieces or black king in check with white to move
+		if (Square::distance(pos.whiteKing, pos.blackKing) <= 1
+			|| pos.whiteKing == pos.pawn
+			|| pos.blackKing == pos.pawn
+			|| (pos.side == Color::WHITE && pawnAttacks.test(pos.blackKing))) {
+			return INVALID;
+		}
+
+		if (pos.side == Color::WHITE) {
+			// The pawn promotes safely
+			const Square promotionSq = Square::Value(pos.pawn + 8);
+			if (pos.pawn.getRank() == Rank::R7
+				&& pos.whiteKing != promotionSq
+				&& pos.blackKing != promotionSq
+				&& (!blackKingAttacks.test(promotionSq) || whiteKingAttacks.test(promotionSq))) {
+				return WIN;
+			}
+		} else {
+			// Stalemate or the pawn is captured
+			if (!blackKingAttacks.b_and(whiteKingAttacks.b_or(pawnAttacks).b_not())
+				|| blackKingAttacks.b_and(whiteKingAttacks.b_not()).test(pos.pawn)) {
+				return DRAW;
+			}
+		}
+
+		return UNKNOWN;
+	}
+
+	// The result determined by the results of the successors
+	CM_PURE KPKResult classify(const std::vector<u8>& db, const KPKPosition& pos) noexcept {
+		const Color opposite = pos.side.getOpposite();
+		u8 successors = INVALID;
+
+		if (pos.side == Color::WHITE) {
+			BitBoard moves = BitBoard::pseudoAttacks<PieceType::KING>(pos.whiteKing);
+			BB_FOR_EACH(to, moves) {
+				successors |= db[KPKBitbase::makeIndex(opposite, to, pos.pawn, pos.blackKing)];
+			}
+
+			// Pawn pushes, the promotions are handled in classifyInitially
+			if (pos.pawn.getRank() < Rank::R7) {
+				const Square push = Square::Value(pos.pawn + 8);
+				successors |= db[KPKBitbase::makeIndex(opposite, pos.whiteKing, push, pos.blackKing)];
+
+				const Square doublePush = Square::Value(push + 8);
+				if (pos.pawn.getRank() == Rank::R2 && push != pos.whiteKing && push != pos.blackKing) {
+					successors |= db[KPKBitbase::makeIndex(opposite, pos.whiteKing, doublePush, pos.blackKing)];
+				}
+			}
+
+			return successors & WIN ? WIN : successors & UNKNOWN ? UNKNOWN : DRAW;
+		} else {
+			BitBoard moves = BitBoard::pseudoAttacks<PieceType::KING>(pos.blackKing);
+			BB_FOR_EACH(to, moves) {
+				successors |= db[KPKBitbase::makeIndex(opposite, pos.whiteKing, pos.pawn, to)];
+			}
+
+			return successors & DRAW ? DRAW : successors & UNKNOWN ? UNKNOWN : WIN;
+		}
+	}
+
+	void KPKBitbase::init() {
+		std::vector<u8> db(POSITIONS_COUNT);
+		for (u32 i = 0; i < POSITIONS_COUNT; i++) {
+			db[i] = classifyInitially(KPKPosition(i));
+		}
+
+		// Iterate until nothing changes, the positions left unknown are draws
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (u32 i = 0; i < POSITIONS_COUNT; i++) {
+				if (db[i] == UNKNOWN) {
+					db[i] = classify(db, KPKPosition(i));
+					changed |= db[i] != UNKNOWN;
+				}
+			}
+		}
+
+		memset(s_bitbase, 0, sizeof(s_bitbase));
+		for (u32 i = 0; i < POSITIONS_COUNT; i++) {
+			if (db[i] == WIN) {
+				s_bitbase[i >> 6] |= 1ull << (i & 63);
+			}
+		}
+	}
+}
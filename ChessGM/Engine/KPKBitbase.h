@@ -0,0 +1,86 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "Chess/Board.h"
+
+/*
+*	KPKBitbase(.h/.cpp) contains the win/draw bitbase for the king and pawn versus king endgame.
+* 
+*	The bitbase is generated at startup by retrograde analysis and has a single bit
+*	per position: whether the side with the pawn wins. The positions are normalized so that
+*	the strong side is white and the pawn is on files A-D, which gives
+*	2 (side to move) * 24 (pawn squares) * 64 * 64 (kings squares) = 196608 positions (24 KB).
+*/
+
+namespace engine {
+	class KPKBitbase final {
+	public:
+		constexpr inline static u32 POSITIONS_COUNT = 2 * 24 * 64 * 64;
+
+	private:
+		static u64 s_bitbase[POSITIONS_COUNT / 64];
+
+	public:
+		static void init();
+
+		// Whether the position (with the strong side being white and the pawn on files A-D) is won for white
+		CM_PURE static bool probeNormalized(const Color side, const Square whiteKing, const Square pawn, const Square blackKing) noexcept {
+			const u32 index = makeIndex(side, whiteKing, pawn, blackKing);
+			return (s_bitbase[index >> 6] >> (index & 63)) & 1;
+		}
+
+		// Whether the strong side wins in the KPK position on the board
+		template<Color::Value StrongSide>
+		CM_PURE static bool probe(const Board& board) noexcept {
+			Square strongKing = board.king(StrongSide);
+			Square weakKing = board.king(Color(StrongSide).getOpposite());
+			Square pawn = board.pawns(StrongSide).lsb();
+			Color side = board.side();
+
+			if constexpr (StrongSide == Color::BLACK) {
+				strongKing = strongKing.getOpposite();
+				weakKing = weakKing.getOpposite();
+				pawn = pawn.getOpposite();
+				side = side.getOpposite();
+			}
+
+			if (pawn.getFile() > File::D) {
+				strongKing = strongKing.mirrorByFile();
+				weakKing = weakKing.mirrorByFile();
+				pawn = pawn.mirrorByFile();
+			}
+
+			return probeNormalized(side, strongKing, pawn, weakKing);
+		}
+
+		// Whether there are only kings and a single pawn on the board
+		CM_PURE static bool isKPK(const Board& board) noexcept {
+			constexpr u64 KINGS_KEY = Board::materialKeyOf(Piece::KING_WHITE) + Board::materialKeyOf(Piece::KING_BLACK);
+
+			return board.materialKey() == KINGS_KEY + Board::materialKeyOf(Piece::PAWN_WHITE)
+				|| board.materialKey() == KINGS_KEY + Board::materialKeyOf(Piece::PAWN_BLACK);
+		}
+
+		// Index of the normalized position, the pawn must be on files A-D and ranks 2-7
+		CM_PURE constexpr static u32 makeIndex(const Color side, const Square whiteKing, const Square pawn, const Square blackKing) noexcept {
+			return u32(whiteKing) | (u32(blackKing) << 6) | (u32(side) << 12) | (u32(pawn.getFile()) << 13) | (u32(Rank::R7 - pawn.getRank()) << 15);
+		}
+	};
+}
@@ -40,6 +40,35 @@ namespace engine {
 		m_nodesLimit = UINT64_MAX;
 	}
 
+	void Limits::makeFixed(const LimitType type, const u64 limit) noexcept {
+		makeInfinite();
+
+		switch (type) {
+			case LimitType::TIME:
+				m_baseTime = 0;
+				m_incTime = time_t(limit);
+				reset();
+				break;
+			case LimitType::DEPTH: m_depthLimit = Depth(limit); break;
+			case LimitType::NODES: m_nodesLimit = limit; break;
+		default: break;
+		}
+	}
+
+	bool Limits::parseLimitType(std::string_view str, LimitType& type) noexcept {
+		if (str == "time") {
+			type = LimitType::TIME;
+		} else if (str == "depth") {
+			type = LimitType::DEPTH;
+		} else if (str == "nodes") {
+			type = LimitType::NODES;
+		} else {
+			return false;
+		}
+
+		return true;
+	}
+
 	void Limits::reset(const time_t msLeft) noexcept {
 		// DELAY_FIX is the time that is reserved due to the delays
 		// that are not accounted by the time limits
@@ -17,6 +17,7 @@
 */
 
 #pragma once
+#include <string_view>
 #include "Utils/Types.h"
 
 /*
@@ -27,6 +28,13 @@
 */
 
 namespace engine {
+	// The kind of a fixed limit, e.g. for the analysis of a batch of positions
+	enum class LimitType : u8 {
+		TIME = 0, // In milliseconds
+		DEPTH,
+		NODES
+	};
+
 	// Limits the search
 	class Limits final {
 	private:
@@ -45,6 +53,12 @@ namespace engine {
 		// Resets all the limits and makes the search infinite
 		void makeInfinite() noexcept;
 
+		// Makes the search limited by only the given time, depth or nodes and starts the timer
+		void makeFixed(const LimitType type, const u64 limit) noexcept;
+
+		// Parses "time", "depth" or "nodes", returns false for anything else
+		static bool parseLimitType(std::string_view str, LimitType& type) noexcept;
+
 		// Starts the time limit counting from the moment
 		// Recomputes the limits based on the currently left time
 		void reset(const time_t msLeft = 0) noexcept;
@@ -79,6 +93,11 @@ namespace engine {
 		// Hard limit is the time when the search is stopped no matter what
 		bool isHardLimitBroken() const noexcept;
 
+		// The time of the hard limit in the milliseconds of the steady clock, INT64_MAX if there is none
+		CM_PURE time_t hardLimitTime() const noexcept {
+			return m_hardBreak;
+		}
+
 		bool isNodesLimitBroken(const NodesCount nodes) const noexcept;
 		bool isDepthLimitBroken(const Depth depth) const noexcept;
 	};
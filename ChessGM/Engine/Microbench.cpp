@@ -0,0 +1,354 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Microbench.h"
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "Bench.h"
+#include "Eval.h"
+#include "MovePicker.h"
+#include "TranspositionTable.h"
+#include "PawnHashTable.h"
+#include "Utils/IO.h"
+#include "Utils/StringUtils.h"
+
+namespace engine {
+	constexpr u32 TT_KEYS_COUNT = 1 << 16;
+	constexpr u32 TT_SIZES[] = { 1, 16, 256 }; // In megabytes
+
+	// The results of the benchmarked operations are accumulated here so that they are not optimized away
+	static volatile u64 s_sink = 0;
+
+	// The positions with all the data needed by the microbenchmarks prepared in advance
+	struct MicrobenchPositions final {
+		std::vector<Board> quiet; // Not in check
+		std::vector<Board> inCheck;
+		std::unique_ptr<MoveList[]> pseudoLegal; // The pseudo-legal moves of the quiet positions
+		std::unique_ptr<MoveList[]> legal; // The legal moves of the quiet positions
+		std::unique_ptr<MoveList[]> captures; // The captures of the quiet positions
+
+		MicrobenchPositions() {
+			bool success;
+			for (const std::string_view fen : Bench::positions()) {
+				Board board = Board::fromFEN(fen, success);
+				(board.isInCheck() ? inCheck : quiet).push_back(std::move(board));
+			}
+
+			pseudoLegal.reset(new MoveList[quiet.size()]);
+			legal.reset(new MoveList[quiet.size()]);
+			captures.reset(new MoveList[quiet.size()]);
+
+			for (size_t i = 0; i < quiet.size(); i++) {
+				Board& board = quiet[i];
+				board.generateMoves(pseudoLegal[i]);
+				board.generateMoves<movegen::CAPTURES>(captures[i]);
+
+				for (Move m : pseudoLegal[i]) {
+					if (!board.isLegal(m)) {
+						continue;
+					}
+
+					legal[i].push(m);
+
+					// The positions after the checks are used for the evasions
+					if (board.givesCheck(m)) {
+						board.makeMove(m);
+						inCheck.push_back(Board::fromFEN(board.toFEN(), success));
+						board.unmakeMove(m);
+					}
+				}
+			}
+		}
+	};
+
+	// Runs the body for the warm-up and then for the given number of samples.
+	// The body must return the number of operations it has done.
+	template<class Body>
+	MicrobenchResult measureMicrobench(std::string name, const u32 samples, Body&& body) {
+		using namespace std::chrono;
+
+		MicrobenchResult result;
+		result.name = std::move(name);
+		result.samples = samples;
+		result.operations = body(); // Warm-up
+
+		std::vector<double> times;
+		times.reserve(samples);
+		for (u32 i = 0; i < samples; i++) {
+			const auto start = steady_clock::now();
+			const u64 operations = body();
+			const double elapsed = double(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+			times.push_back(elapsed / std::max(operations, u64(1)));
+		}
+
+		std::sort(times.begin(), times.end());
+		result.min = times.front();
+		result.median = times[times.size() / 2];
+
+		for (const double time : times) {
+			result.mean += time;
+		}
+
+		result.mean /= times.size();
+		for (const double time : times) {
+			result.stddev += (time - result.mean) * (time - result.mean);
+		}
+
+		result.stddev = std::sqrt(result.stddev / times.size());
+		return result;
+	}
+
+	template<movegen::GenerationMode Mode>
+	u64 generateAll(std::vector<Board>& boards, const u32 repeats) {
+		MoveList moves;
+		for (u32 r = 0; r < repeats; r++) {
+			for (Board& board : boards) {
+				moves.clear();
+				board.generateMoves<Mode>(moves);
+				s_sink = s_sink + moves.size();
+			}
+		}
+
+		return u64(boards.size()) * repeats;
+	}
+
+	void benchMoveGeneration(MicrobenchPositions& positions, const u32 samples, std::vector<MicrobenchResult>& results) {
+		constexpr u32 REPEATS = 1000;
+
+		results.push_back(measureMicrobench("generateMoves/ALL_MOVES", samples, [&]() { return generateAll<movegen::ALL_MOVES>(positions.quiet, REPEATS); }));
+		results.push_back(measureMicrobench("generateMoves/CAPTURES", samples, [&]() { return generateAll<movegen::CAPTURES>(positions.quiet, REPEATS); }));
+		results.push_back(measureMicrobench("generateMoves/QUIET_CHECKS", samples, [&]() { return generateAll<movegen::QUIET_CHECKS>(positions.quiet, REPEATS); }));
+		results.push_back(measureMicrobench("generateMoves/CHECK_EVASIONS", samples, [&]() { return generateAll<movegen::CHECK_EVASIONS>(positions.inCheck, REPEATS); }));
+	}
+
+	void benchMoves(MicrobenchPositions& positions, const u32 samples, std::vector<MicrobenchResult>& results) {
+		// The moves of the given lists are applied to each quiet position
+		const auto forEachMove = [&](std::unique_ptr<MoveList[]>& lists, const u32 repeats, auto&& body) {
+			u64 operations = 0;
+			for (u32 r = 0; r < repeats; r++) {
+				for (size_t i = 0; i < positions.quiet.size(); i++) {
+					Board& board = positions.quiet[i];
+					for (Move m : lists[i]) {
+						body(board, m);
+					}
+
+					operations += lists[i].size();
+				}
+			}
+
+			return operations;
+		};
+
+		results.push_back(measureMicrobench("makeMove+unmakeMove", samples, [&]() {
+			return forEachMove(positions.legal, 100, [](Board& board, const Move m) {
+				board.makeMove(m);
+				board.unmakeMove(m);
+			});
+		}));
+
+		results.push_back(measureMicrobench("isLegal", samples, [&]() {
+			return forEachMove(positions.pseudoLegal, 300, [](Board& board, const Move m) {
+				s_sink = s_sink + board.isLegal(m);
+			});
+		}));
+
+		results.push_back(measureMicrobench("givesCheck", samples, [&]() {
+			return forEachMove(positions.legal, 300, [](Board& board, const Move m) {
+				s_sink = s_sink + board.givesCheck(m);
+			});
+		}));
+
+		results.push_back(measureMicrobench("SEE", samples, [&]() {
+			return forEachMove(positions.captures, 500, [](Board& board, const Move m) {
+				s_sink = s_sink + u64(board.SEE(m));
+			});
+		}));
+	}
+
+	void benchEvaluation(MicrobenchPositions& positions, const u32 samples, std::vector<MicrobenchResult>& results) {
+		constexpr u32 REPEATS = 1000;
+
+		// The pawn structures of all the positions fit into the pawn hash table, so only the first call misses
+		PawnHashTable::reset();
+		results.push_back(measureMicrobench("eval", samples, [&]() {
+			for (u32 r = 0; r < REPEATS; r++) {
+				for (Board& board : positions.quiet) {
+					s_sink = s_sink + u64(eval(board));
+				}
+			}
+
+			return u64(positions.quiet.size()) * REPEATS;
+		}));
+
+		results.push_back(measureMicrobench("pawnHash.hit", samples, [&]() {
+			for (u32 r = 0; r < REPEATS; r++) {
+				for (Board& board : positions.quiet) {
+					s_sink = s_sink + PawnHashTable::getOrScanPHE(board).passed;
+				}
+			}
+
+			return u64(positions.quiet.size()) * REPEATS;
+		}));
+
+		// The miss path is what getOrScanPHE does after a failed lookup
+		results.push_back(measureMicrobench("pawnHash.miss", samples, [&]() {
+			PawnHashEntry entry;
+			for (u32 r = 0; r < REPEATS; r++) {
+				for (Board& board : positions.quiet) {
+					memset(&entry, 0, sizeof(PawnHashEntry));
+					entry.pawns[Color::WHITE] = board.byPiece(Piece::PAWN_WHITE);
+					entry.pawns[Color::BLACK] = board.byPiece(Piece::PAWN_BLACK);
+					PawnHashTable::scanPawnStructure(entry);
+
+					s_sink = s_sink + entry.passed;
+				}
+			}
+
+			return u64(positions.quiet.size()) * REPEATS;
+		}));
+
+		PawnHashTable::reset();
+	}
+
+	void benchTranspositionTable(const u32 samples, std::vector<MicrobenchResult>& results) {
+		constexpr u32 REPEATS = 16;
+
+		std::mt19937_64 random(0x1234567);
+		std::vector<Hash> keys(TT_KEYS_COUNT);
+		for (Hash& key : keys) {
+			key = random();
+		}
+
+		const uint32_t oldSize = TranspositionTable::size();
+		for (const u32 size : TT_SIZES) {
+			TranspositionTable::setSize(size << 20);
+			TranspositionTable::setRootAge(0);
+
+			results.push_back(measureMicrobench("tt.tryRecord/" + std::to_string(size) + "MB", samples, [&]() {
+				for (u32 r = 0; r < REPEATS; r++) {
+					for (u32 i = 0; i < TT_KEYS_COUNT; i++) {
+						TranspositionTable::tryRecord(EntryType(EXACT | PV), keys[i], u16(i), Value(i & 0xff), 1, u8(r), 0);
+					}
+				}
+
+				return u64(TT_KEYS_COUNT) * REPEATS;
+			}));
+
+			// The keys were recorded, so most of the probes hit unless the table is too small to keep them
+			results.push_back(measureMicrobench("tt.probe/" + std::to_string(size) + "MB", samples, [&]() {
+				for (u32 r = 0; r < REPEATS; r++) {
+					for (u32 i = 0; i < TT_KEYS_COUNT; i++) {
+						s_sink = s_sink + (TranspositionTable::probe(keys[i]) != nullptr);
+					}
+				}
+
+				return u64(TT_KEYS_COUNT) * REPEATS;
+			}));
+		}
+
+		TranspositionTable::setSize(oldSize);
+		TranspositionTable::clear();
+	}
+
+	void benchMovePicker(MicrobenchPositions& positions, const u32 samples, std::vector<MicrobenchResult>& results) {
+		constexpr u32 REPEATS = 300;
+
+		MovePicker::init();
+
+		// Scoring does not reorder the moves, so the same lists are scored again and again
+		results.push_back(measureMicrobench("movePicker.score", samples, [&]() {
+			u64 operations = 0;
+			for (u32 r = 0; r < REPEATS; r++) {
+				for (size_t i = 0; i < positions.quiet.size(); i++) {
+					MovePicker picker(positions.quiet[i], positions.pseudoLegal[i], 0);
+					s_sink = s_sink + picker.hasMore();
+					operations += positions.pseudoLegal[i].size();
+				}
+			}
+
+			return operations;
+		}));
+
+		results.push_back(measureMicrobench("movePicker.scoreAndPick", samples, [&]() {
+			u64 operations = 0;
+			for (u32 r = 0; r < REPEATS; r++) {
+				for (size_t i = 0; i < positions.quiet.size(); i++) {
+					MovePicker picker(positions.quiet[i], positions.pseudoLegal[i], 0);
+					while (picker.hasMore()) {
+						s_sink = s_sink + picker.pick().getData();
+					}
+
+					operations += positions.pseudoLegal[i].size();
+				}
+			}
+
+			return operations;
+		}));
+	}
+
+	std::vector<MicrobenchResult> Microbench::run(const u32 samples) {
+		MicrobenchPositions positions;
+		std::vector<MicrobenchResult> results;
+
+		benchMoveGeneration(positions, samples, results);
+		benchMoves(positions, samples, results);
+		benchEvaluation(positions, samples, results);
+		benchTranspositionTable(samples, results);
+		benchMovePicker(positions, samples, results);
+
+		return results;
+	}
+
+	void Microbench::writeCSV(std::ostream& out, const std::vector<MicrobenchResult>& results) {
+		out << "name,operations,samples,min_ns,median_ns,mean_ns,stddev_ns\n" << std::fixed << std::setprecision(3);
+		for (const MicrobenchResult& result : results) {
+			out << result.name << ',' << result.operations << ',' << result.samples << ','
+				<< result.min << ',' << result.median << ',' << result.mean << ',' << result.stddev << '\n';
+		}
+
+		out << std::defaultfloat;
+	}
+
+	void Microbench::print(const std::vector<std::string>& args) {
+		const u32 samples = args.size() > 1 ? str_utils::fromString<u32>(args[1]) : DEFAULT_SAMPLES;
+		const std::vector<MicrobenchResult> results = run(std::max(samples, 1u));
+
+		std::ostringstream csv;
+		writeCSV(csv, results);
+		io::g_out << csv.str() << std::flush;
+
+		if (args.size() > 0) {
+			std::ofstream file(args[0]);
+			if (!file) {
+				io::g_out << io::Color::Red << "Cannot open the file " << args[0] << std::endl;
+				return;
+			}
+
+			writeCSV(file, results);
+		}
+	}
+}
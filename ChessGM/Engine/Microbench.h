@@ -0,0 +1,65 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "Utils/Types.h"
+
+/*
+*	Microbench(.h/.cpp) contains the microbenchmarks of the engine's hot primitives.
+* 
+*	Unlike the bench, which measures the search as a whole, each microbenchmark times a single
+*	operation (move generation, making moves, legality and check tests, SEE, evaluation, pawn hash
+*	and transposition table accesses, move ordering) in a loop over the positions of the bench.
+*	A benchmark is run for several samples after a warm-up, and the cost of one operation is reported
+*	as the min/median/mean/standard deviation over the samples. The results are written as CSV,
+*	so that the runs of different builds can be compared line by line.
+*/
+
+namespace engine {
+	struct MicrobenchResult final {
+		std::string name; // Like "generateMoves/CAPTURES" or "tt.probe/16MB"
+		u64 operations = 0; // In a single sample
+		u32 samples = 0;
+
+		// The time of a single operation in nanoseconds
+		double min = 0;
+		double median = 0;
+		double mean = 0;
+		double stddev = 0;
+	};
+
+	class Microbench final {
+	public:
+		constexpr inline static u32 DEFAULT_SAMPLES = 15;
+
+		// Runs all the microbenchmarks, the hash tables are cleared afterwards
+		static std::vector<MicrobenchResult> run(const u32 samples = DEFAULT_SAMPLES);
+
+		// Writes the results in CSV with a header line
+		static void writeCSV(std::ostream& out, const std::vector<MicrobenchResult>& results);
+
+		// Parses the optional arguments [csv file] [samples], runs the microbenchmarks and prints the results
+		// The results are also written to the csv file if it is given
+		static void print(const std::vector<std::string>& args);
+	};
+}
@@ -20,6 +20,7 @@
 #include <cstring>
 #include "Chess/Board.h"
 #include "Search.h"
+#include "Utils/Profiler.h"
 
 /*
 *	MovePicker(.h/.cpp) contains the MovePicker class that is used 
@@ -28,12 +29,12 @@
 */
 
 namespace engine {
-	// Used in history heuristic
+	// Used in history heuristic, each searching thread has its own tables
 	// s_historyTries is the number of times the move was made during the search
-	extern uint32_t s_historyTries[Piece::VALUES_COUNT][Square::VALUES_COUNT];
+	extern thread_local uint32_t s_historyTries[Piece::VALUES_COUNT][Square::VALUES_COUNT];
 
 	// s_historySuccesses is the number of times the move triggered a successful cut
-	extern uint32_t s_historySuccesses[Piece::VALUES_COUNT][Square::VALUES_COUNT];
+	extern thread_local uint32_t s_historySuccesses[Piece::VALUES_COUNT][Square::VALUES_COUNT];
 
 	// Does not generate the moves, only sorts them and picks the best ones.
 	class MovePicker final {
@@ -65,6 +66,8 @@ namespace engine {
 			const Move tableMove = Move::makeNullMove(),
 			SearchStack* ss = &s_noSS
 		) noexcept : m_first(moves.begin()), m_end(moves.end()) {
+			PROFILE_ZONE(MOVE_SCORING);
+
 			for (Move* move = m_first; move < m_end; ++move) {
 				const u16 data = move->getData();
 
@@ -103,7 +106,9 @@ namespace engine {
 			}
 		}
 
-		CM_PURE constexpr Move pick() noexcept {
+		CM_PURE Move pick() noexcept {
+			PROFILE_ZONE(MOVE_PICKING);
+
 			Move* best = m_first;
 			Value bestValue = best->getValue();
 			for (Move* move = m_first + 1; move < m_end; ++move) {
@@ -24,6 +24,8 @@ namespace options {
 	bool g_analyzeMode = false;
 	bool g_postMode = true;
 	bool g_debugMode = false;
+	bool g_lazyEval = true;
+	bool g_ownBook = false;
 
 	bool g_isThinking = false;
 	bool g_isIllegalPosition = false;
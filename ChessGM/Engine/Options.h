@@ -43,6 +43,13 @@ namespace options {
 	// into the log file.
 	extern bool g_debugMode;
 
+	// Lazy evaluation allows the static evaluation to return early if the position
+	// is too far from the search window.
+	extern bool g_lazyEval;
+
+	// Own book makes the engine play the moves from the opening book while the position is in it
+	extern bool g_ownBook;
+
 
 	///  OWN ENGINE STATE VARIABLES  ///
 
@@ -0,0 +1,93 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "PackedPosition.h"
+#include <cstring>
+
+namespace engine {
+	PackedPosition PackedPosition::pack(const Board& board, const float result, const u32 length) noexcept {
+		PackedPosition packed;
+		memset(&packed, 0, sizeof(PackedPosition));
+
+		packed.occupancy = board.allPieces();
+		packed.side = board.side();
+		packed.castleRight = board.castleRight();
+		packed.ep = board.ep();
+		packed.result = u8(result * 2 + 0.5f);
+		packed.length = u16(std::min<u32>(length, 0xffff));
+
+		u32 i = 0;
+		BitBoard pieces = board.allPieces();
+		BB_FOR_EACH(sq, pieces) {
+			packed.pieces[i / 2] |= u8(board[sq]) << (4 * (i & 1));
+			++i;
+		}
+
+		return packed;
+	}
+
+	Board PackedPosition::unpack() const noexcept {
+		Board board;
+		unpack(board);
+
+		return board;
+	}
+
+	void PackedPosition::unpack(Board& board) const noexcept {
+		Piece boardPieces[32];
+		Square squares[32];
+		u8 count = 0;
+
+		BitBoard occupied = occupancy;
+		BB_FOR_EACH(sq, occupied) {
+			boardPieces[count] = Piece::Value((pieces[count / 2] >> (4 * (count & 1))) & 0xf);
+			squares[count] = sq;
+			++count;
+		}
+
+		board.setPieces(boardPieces, squares, count, Color::Value(side));
+		board.castleRight() = castleRight;
+		board.ep() = Square::Value(ep);
+	}
+
+	void PackedPositions::writeHeader(std::ostream& out) {
+		char header[HEADER_SIZE] = { };
+		memcpy(header, MAGIC, sizeof(MAGIC));
+		out.write(header, HEADER_SIZE);
+	}
+
+	void PackedPositions::write(std::ostream& out, const PackedPosition& position) {
+		out.write(reinterpret_cast<const char*>(&position), sizeof(PackedPosition));
+	}
+
+	bool PackedPositions::map(const std::string& fileName, MappedFile& file, const PackedPosition*& positions, size_t& count) {
+		if (!file.open(fileName)) {
+			return false;
+		}
+
+		if (file.size() < HEADER_SIZE || memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0) {
+			file.close();
+			return false;
+		}
+
+		positions = reinterpret_cast<const PackedPosition*>(file.data() + HEADER_SIZE);
+		count = (file.size() - HEADER_SIZE) / sizeof(PackedPosition);
+		return true;
+	}
+}
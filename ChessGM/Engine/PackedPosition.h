@@ -0,0 +1,81 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <ostream>
+#include <string_view>
+#include "Chess/Board.h"
+#include "Utils/MappedFile.h"
+
+/*
+*	PackedPosition(.h/.cpp) contains the compact binary format of the training positions for tuning.
+* 
+*	A position takes 32 bytes: the occupancy, the pieces of the occupied squares packed in 4 bits each,
+*	the side to move, castling rights, en passant square, the game result and the number of plies
+*	till the end of the game.
+*	A file of packed positions is a 32-byte header followed by the records, so that it can be
+*	memory mapped and used as is.
+*/
+
+namespace engine {
+	struct PackedPosition final {
+		u64 occupancy;
+		u8 pieces[16]; // The pieces of the occupied squares from A1 to H8, 4 bits per piece
+		u8 side;
+		u8 castleRight;
+		u8 ep; // Square::NO_POS if there is no en passant
+		u8 result; // From white's POV: 0 for a loss, 1 for a draw, 2 for a win
+		u16 length; // Plies till the end of the game
+		u16 reserved;
+
+		static PackedPosition pack(const Board& board, const float result, const u32 length) noexcept;
+
+		// Creates the board with the current piece-square tables
+		Board unpack() const noexcept;
+
+		// The same as unpack, but reuses the board's memory
+		void unpack(Board& board) const noexcept;
+
+		// The game result as 0.0, 0.5, or 1.0
+		CM_PURE float gameResult() const noexcept {
+			return result * 0.5f;
+		}
+	};
+
+	static_assert(sizeof(PackedPosition) == 32);
+
+	class PackedPositions final {
+	public:
+		constexpr inline static std::string_view EXTENSION = ".cgtp";
+		constexpr inline static char MAGIC[8] = "CGMTP01";
+		constexpr inline static size_t HEADER_SIZE = 32;
+
+		// Whether the file is supposed to contain the packed positions by its name
+		CM_PURE static bool hasExtension(const std::string_view fileName) noexcept {
+			return fileName.ends_with(EXTENSION);
+		}
+
+		static void writeHeader(std::ostream& out);
+
+		static void write(std::ostream& out, const PackedPosition& position);
+
+		// Maps the file, returns false if it is not a file of packed positions
+		static bool map(const std::string& fileName, MappedFile& file, const PackedPosition*& positions, size_t& count);
+	};
+}
@@ -20,9 +20,10 @@
 #include <cstring>
 
 #include "Scores.h"
+#include "Utils/Profiler.h"
 
 namespace engine {
-    PawnHashEntry PawnHashTable::s_table[1 << PAWN_HASH_TABLE_SIZE_LOG2];
+    thread_local PawnHashEntry PawnHashTable::s_table[1 << PAWN_HASH_TABLE_SIZE_LOG2];
 
     void PawnHashTable::init() {
 		reset();
@@ -50,76 +51,97 @@ namespace engine {
 
 		entry.pawns[Color::WHITE] = wpawns;
 		entry.pawns[Color::BLACK] = bpawns;
-
-		scanPawns<Color::WHITE>(board, entry);
-		scanPawns<Color::BLACK>(board, entry);
+		scanPawnStructure(entry);
 
 		return entry;
     }
 
+	void PawnHashTable::scanPawnStructure(PawnHashEntry& entry) {
+		PROFILE_ZONE(PAWN_SCAN);
+
+		// The most advanced ranks are left as for the empty files
+		for (u8 i = 0; i < 10; i++) {
+			entry.mostAdvanced[Color::WHITE][i] = Rank::R1;
+			entry.mostAdvanced[Color::BLACK][i] = Rank::R8;
+		}
+
+		scanPawns<Color::WHITE>(entry);
+		scanPawns<Color::BLACK>(entry);
+	}
+
 	template<Color::Value Side>
-	void PawnHashTable::scanPawns(Board& board, PawnHashEntry& entry) {
+	void PawnHashTable::scanPawns(PawnHashEntry& entry) {
 		constexpr Color::Value OppositeSide = Color(Side).getOpposite().value();
-		constexpr Direction::Value Up = Direction::makeRelativeDirection(Side, Direction::UP).value();
+		constexpr Direction::Value Down = Direction::makeRelativeDirection(Side, Direction::DOWN).value();
 
-		const BitBoard pawns = board.byPiece(Piece(Side, PieceType::PAWN));
-		const BitBoard enemyPawns = board.byPiece(Piece(OppositeSide, PieceType::PAWN));
+		const BitBoard pawns = entry.pawns[Side];
+		const BitBoard enemyPawns = entry.pawns[OppositeSide];
 
 		const BitBoard ourPawnAttacks = pawns.pawnAttackedSquares<Side>();
-
-		// Initializing like empty
-		for (u8 i = 0; i < 10; i++) {
-			entry.mostAdvanced[Color::WHITE][i] = Rank::R1;
-			entry.mostAdvanced[Color::BLACK][i] = Rank::R8;
+		const BitBoard enemyPawnAttacks = enemyPawns.pawnAttackedSquares<OppositeSide>();
+
+		// Note: BitBoard::threeFilesForward/adjacentFilesForward lack the file to the right
+		// (they are filled before s_directionBits of the next square), and the weights are tuned with that,
+		// so only the file to the left is accounted for passed and backward pawns.
+
+		// Squares that have an enemy pawn ahead on the same or the left file
+		const BitBoard enemyFrontSpan = enemyPawns.frontSpan<OppositeSide>();
+		const BitBoard enemyControlled = enemyFrontSpan.b_or(enemyFrontSpan.shift(Direction::RIGHT));
+
+		// Squares at or ahead of our pawns on the right file, i.e. where a pawn can be supported from the left
+		const BitBoard supportSpan = pawns.b_or(pawns.frontSpan<Side>()).shift(Direction::RIGHT);
+
+		const BitBoard defended = pawns.b_and(ourPawnAttacks);
+		const BitBoard doubled = pawns.b_and(pawns.frontSpan<OppositeSide>()); // There is our pawn ahead
+		const BitBoard passed = pawns.b_and(enemyControlled.b_or(doubled).b_not());
+		const BitBoard isolated = pawns.b_and(pawns.fileFill().neighbouringSquares().b_not());
+		const BitBoard backward = pawns
+			.b_and(supportSpan.b_not())
+			.b_and(enemyPawnAttacks.shift(Down)); // The stop square is attacked by an enemy pawn
+
+		entry.passed |= passed;
+		entry.isolated |= isolated;
+		entry.doubled |= doubled;
+		entry.backward |= backward;
+
+		// Defended and passed pawns depend on the rank
+		BitBoard pieces = defended;
+		BB_FOR_EACH(sq, pieces) {
+			entry.pawnEvaluation[Side] += scores::DEFENDED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())];
 		}
 
-		BitBoard pieces = pawns;
+		pieces = passed;
 		BB_FOR_EACH(sq, pieces) {
-			// Most advanced ranks
-			entry.mostAdvanced[Side][sq.getFile() + 1] = std::max(entry.mostAdvanced[Side][sq.getFile() + 1], Rank::makeRelativeRank(Side, sq.getRank()));
-
-			// Counting islands
-			if (File f = sq.getFile(); f == File::H || BitBoard::fromFile(File::Value(f + 1)).b_and(pawns) == BitBoard::EMPTY) {
-				entry.islandsCount[Side]++;
-			} else if (BitBoard pawnsOnNextFile = BitBoard::fromFile(File::Value(f + 1)).b_and(pawns); pawnsOnNextFile != BitBoard::EMPTY) {
-				entry.distortion[Side] += std::max(0, std::abs(pawnsOnNextFile.lsb().getRank() - sq.getRank()) - 1);
-			}
-
-			// Defended pawns
-			if (ourPawnAttacks.test(sq)) {
-				entry.pawnEvaluation[Side] += scores::DEFENDED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())];
-			}
-
-			if (BitBoard::threeFilesForward<Side>(sq).b_and(enemyPawns) == BitBoard::EMPTY
-				&& BitBoard::directionBits<Up>(sq).b_and(pawns) == BitBoard::EMPTY) { // Passed pawn
-				entry.pawnEvaluation[Side] += scores::PASSED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())];
-				entry.passed.set(sq);
-			}
-
-			// Isolated pawn
-			if (BitBoard::adjacentFiles(sq.getFile()).b_and(pawns) == BitBoard::EMPTY) {
-				entry.pawnEvaluation[Side] += scores::ISOLATED_PAWN;
-				entry.isolated.set(sq);
-			}
-
-			// Double pawn
-			if (BitBoard::directionBits<Up>(sq).b_and(pawns) != BitBoard::EMPTY) {
-				entry.pawnEvaluation[Side] += scores::DOUBLE_PAWN;
-				entry.doubled.set(sq);
-			}
-
-			// Backward pawn
-			if (BitBoard::adjacentFilesForward<OppositeSide>(sq.shift(Up)).b_and(pawns) == BitBoard::EMPTY
-				&& BitBoard::pawnAttacks(Side, sq.shift(Up)).b_and(enemyPawns)) {
-				entry.pawnEvaluation[Side] += scores::BACKWARD_PAWN;
-				entry.backward.set(sq);
-			}
+			entry.pawnEvaluation[Side] += scores::PASSED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())];
+		}
+
+		entry.pawnEvaluation[Side] += scores::ISOLATED_PAWN * isolated.popcnt();
+		entry.pawnEvaluation[Side] += scores::DOUBLE_PAWN * doubled.popcnt();
+		entry.pawnEvaluation[Side] += scores::BACKWARD_PAWN * backward.popcnt();
+
+		// Islands are counted by the pawns on the last file of every island
+		const u8 files = pawns.fileProjection();
+		const u8 islandsLastFiles = files & ~(files >> 1);
+		entry.islandsCount[Side] = pawns.b_and(BitBoard(islandsLastFiles * BitBoard::FILE_A)).popcnt();
+
+		// Distortion is the number of squares between a pawn and the lowest pawn on the next file.
+		// The pawns are taken by layers with at most one pawn per file, so that the distances
+		// could be counted set-wise.
+		const BitBoard nextFileLowest = pawns.b_and(pawns.frontSpan<Color::WHITE>().b_not()).shift(Direction::LEFT);
+		BitBoard remaining = pawns.b_and(nextFileLowest.fileFill());
+		while (remaining) {
+			const BitBoard layer = remaining.b_and(remaining.frontSpan<Color::WHITE>().b_not());
+			const BitBoard between = layer.frontSpan<Color::WHITE>().b_and(nextFileLowest.frontSpan<Color::BLACK>())
+				.b_or(layer.frontSpan<Color::BLACK>().b_and(nextFileLowest.frontSpan<Color::WHITE>()));
+
+			entry.distortion[Side] += between.popcnt();
+			remaining ^= layer;
 		}
 
-		// Pawn islands
-		entry.pawnEvaluation[Side] += scores::PAWN_ISLANDS[entry.islandsCount[Side]];
+		// Pawn islands (the count includes the doubled pawns on the last files, so it can go beyond 4)
+		entry.pawnEvaluation[Side] += scores::PAWN_ISLANDS[std::min(entry.islandsCount[Side], u8(4))];
 
 		// Pawn distortion
 		entry.pawnEvaluation[Side] += scores::PAWN_DISTORTION * entry.distortion[Side];
 	}
-}
\ No newline at end of file
+}
@@ -46,7 +46,8 @@ namespace engine {
 		constexpr inline static uint32_t PAWN_HASH_TABLE_SIZE_LOG2 = 12; // Nodes number in the table = 2**PAWN_HASH_TABLE_SIZE_LOG2
 
 	private:
-		static PawnHashEntry s_table[1 << PAWN_HASH_TABLE_SIZE_LOG2];
+		// Each thread has its own table, reset() and init() only affect the calling thread
+		thread_local static PawnHashEntry s_table[1 << PAWN_HASH_TABLE_SIZE_LOG2];
 
 	public:
 		static void init();
@@ -55,8 +56,11 @@ namespace engine {
 		// Returns an entry from the table if there is, or creates a new one
 		static PawnHashEntry& getOrScanPHE(Board& board);
 
+		// Fills the zeroed entry with the information on the pawns from entry.pawns
+		static void scanPawnStructure(PawnHashEntry& entry);
+
 	private:
 		template<Color::Value Side>
-		static void scanPawns(Board& board, PawnHashEntry& entry);
+		static void scanPawns(PawnHashEntry& entry);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,299 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "PgnReader.h"
+#include <cstring>
+#include <filesystem>
+
+namespace engine {
+	constexpr const char* DEFAULT_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+	CM_PURE bool isSpace(const int ch) noexcept {
+		return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+	}
+
+	CM_PURE bool isDelimiter(const char ch) noexcept {
+		switch (ch) {
+			case ' ': case '\n': case '\r': case '\t':
+			case '{': case '}': case '(': case ')': case '[': case ']': case ';':
+				return true;
+		default: return false;
+		}
+	}
+
+	CM_PURE bool isResult(std::string_view token) noexcept {
+		return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+	}
+
+	void parseResult(std::string_view result, PgnGame& game) noexcept {
+		game.result = result == "1-0" ? 1.f : result == "0-1" ? 0.f : 0.5f;
+		game.isResultKnown = result == "1-0" || result == "0-1" || result == "1/2-1/2";
+	}
+
+	Move parseMove(const Board& board, std::string_view token) noexcept {
+		const bool isLongAlgebraic = token.size() >= 4
+			&& token[0] >= 'a' && token[0] <= 'h' && token[1] >= '1' && token[1] <= '8'
+			&& token[2] >= 'a' && token[2] <= 'h' && token[3] >= '1' && token[3] <= '8';
+
+		return isLongAlgebraic 
+			? board.makeMoveFromString(token) 
+			: board.makeMoveFromSAN(token);
+	}
+
+	// Returns the offset of the first game that starts at or after the offset
+	u64 findGameStart(const std::string& path, const u64 offset, const u64 fileSize) {
+		std::ifstream file(path, std::ios::binary);
+		std::string line;
+
+		file.seekg(std::streamoff(offset - 1));
+		std::getline(file, line); // The rest of the line the offset is in
+
+		for (std::streamoff lineBegin = file.tellg(); lineBegin >= 0 && std::getline(file, line); lineBegin = file.tellg()) {
+			if (line.starts_with("[Event ")) {
+				return u64(lineBegin);
+			}
+		}
+
+		return fileSize;
+	}
+
+	PgnReader::PgnReader() 
+		: m_buffer(std::make_unique<char[]>(BUFFER_SIZE)) { }
+
+	bool PgnReader::open(const std::string& path, const u64 begin, const u64 end) {
+		m_file.close();
+		m_file.clear();
+		m_file.open(path, std::ios::binary);
+		if (!m_file.is_open()) {
+			return false;
+		}
+
+		m_file.seekg(std::streamoff(begin));
+		m_size = 0;
+		m_position = 0;
+		m_bufferOffset = begin;
+		m_end = end;
+
+		return true;
+	}
+
+	bool PgnReader::open(const PgnChunk& chunk) {
+		return open(chunk.path, chunk.begin, chunk.end);
+	}
+
+	bool PgnReader::readGame(PgnGame& game) {
+		skipSpaces();
+		game.offset = m_bufferOffset + m_position;
+		if (peek() == EOF || game.offset >= m_end) {
+			return false;
+		}
+
+		game.initialFen = DEFAULT_FEN;
+		game.result = 0.5f;
+		game.isResultKnown = false;
+		game.moves.clear();
+		game.isCorrupted = false;
+
+		// Tags
+		while (peek() == '[') {
+			readTag(game);
+			skipSpaces();
+		}
+
+		bool success;
+		Board board = Board::fromFEN(game.initialFen, success);
+		game.isCorrupted = !success;
+
+		// Moves
+		u32 variationDepth = 0;
+		for (int ch; (ch = peek()) != EOF;) {
+			if (isSpace(ch)) {
+				++m_position;
+				continue;
+			} else if (ch == '[') {
+				break; // The next game, this one had no result
+			} else if (ch == '{') {
+				skipTill('}');
+				continue;
+			} else if (ch == ';' || ch == '%') {
+				skipTill('\n');
+				continue;
+			} else if (ch == '(' || ch == ')') {
+				variationDepth = ch == '(' ? variationDepth + 1 : std::max(variationDepth, 1u) - 1;
+				++m_position;
+				continue;
+			} else if (ch == '}' || ch == ']') {
+				++m_position;
+				continue;
+			}
+
+			std::string_view token = readToken();
+			if (isResult(token)) {
+				if (variationDepth == 0) {
+					parseResult(token, game);
+					break;
+				}
+
+				continue;
+			} else if (variationDepth || game.isCorrupted || token[0] == '$') {
+				continue;
+			}
+
+			// Move numbers, also glued to the move as in "1.e4" or "1...e5"
+			size_t moveBegin = 0;
+			while (moveBegin < token.size() && token[moveBegin] >= '0' && token[moveBegin] <= '9') {
+				++moveBegin;
+			}
+
+			if (moveBegin < token.size() && token[moveBegin] == '.') {
+				while (moveBegin < token.size() && token[moveBegin] == '.') {
+					++moveBegin;
+				}
+
+				token.remove_prefix(moveBegin);
+			} else if (moveBegin == token.size()) {
+				continue;
+			}
+
+			if (token.empty()) {
+				continue;
+			}
+
+			const Move m = parseMove(board, token);
+			if (m.isNullMove()) {
+				game.isCorrupted = true;
+				continue;
+			}
+
+			game.moves.push_back(m);
+			board.makeMove(m);
+		}
+
+		return true;
+	}
+
+	bool PgnReader::split(const std::string& path, const u64 chunkSize, std::vector<PgnChunk>& chunks) {
+		std::error_code error;
+		const u64 fileSize = std::filesystem::file_size(path, error);
+		if (error) {
+			return false;
+		}
+
+		u64 begin = 0;
+		while (begin < fileSize) {
+			const u64 end = begin + chunkSize < fileSize ? findGameStart(path, begin + chunkSize, fileSize) : fileSize;
+			chunks.push_back(PgnChunk { path, begin, end });
+			begin = end;
+		}
+
+		return true;
+	}
+
+	size_t PgnReader::fill(const size_t count) {
+		const size_t available = m_size - m_position;
+		if (available >= count || !m_file.good()) {
+			return available;
+		}
+
+		// Moving the unread data to the beginning of the buffer
+		memmove(m_buffer.get(), m_buffer.get() + m_position, available);
+		m_bufferOffset += m_position;
+		m_position = 0;
+
+		m_file.read(m_buffer.get() + available, std::streamsize(BUFFER_SIZE - available));
+		m_size = available + size_t(m_file.gcount());
+
+		return m_size;
+	}
+
+	int PgnReader::peek() {
+		if (m_position == m_size && fill(1) == 0) {
+			return EOF;
+		}
+
+		return static_cast<u8>(m_buffer[m_position]);
+	}
+
+	void PgnReader::skipSpaces() {
+		for (int ch; (ch = peek()) != EOF && isSpace(ch);) {
+			++m_position;
+		}
+	}
+
+	void PgnReader::skipTill(const char ch) {
+		while (m_position < m_size || fill(1)) {
+			const char* found = static_cast<const char*>(memchr(m_buffer.get() + m_position, ch, m_size - m_position));
+			if (found) {
+				m_position = size_t(found - m_buffer.get()) + 1;
+				return;
+			}
+
+			m_position = m_size;
+		}
+	}
+
+	std::string_view PgnReader::readToken() {
+		const size_t available = fill(MAX_TOKEN_SIZE);
+		const size_t begin = m_position;
+		const size_t end = m_position + std::min(available, MAX_TOKEN_SIZE);
+
+		while (m_position < end && !isDelimiter(m_buffer[m_position])) {
+			++m_position;
+		}
+
+		// The rest of a too long token is skipped, and the token is replaced since the buffer could be refilled
+		if (m_position == end && m_position - begin == MAX_TOKEN_SIZE) {
+			for (int ch; (ch = peek()) != EOF && !isDelimiter(char(ch));) {
+				++m_position;
+			}
+
+			return "?";
+		}
+
+		return std::string_view(m_buffer.get() + begin, m_position - begin);
+	}
+
+	void PgnReader::readTag(PgnGame& game) {
+		++m_position; // '['
+
+		const std::string_view name = readToken();
+		const bool isResultTag = name == "Result";
+		const bool isFENTag = name == "FEN";
+
+		skipSpaces();
+		if (peek() == '"' && (isResultTag || isFENTag)) {
+			fill(MAX_TOKEN_SIZE);
+
+			const size_t begin = ++m_position;
+			while (m_position < m_size && m_buffer[m_position] != '"' && m_buffer[m_position] != '\n') {
+				m_position += m_buffer[m_position] == '\\' ? 2 : 1;
+			}
+
+			m_position = std::min(m_position, m_size);
+			const std::string_view value(m_buffer.get() + begin, m_position - begin);
+			if (isResultTag) {
+				parseResult(value, game);
+			} else {
+				game.initialFen = value;
+			}
+		}
+
+		skipTill(']');
+	}
+}
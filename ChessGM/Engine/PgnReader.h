@@ -0,0 +1,97 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "Chess/Board.h"
+
+/*
+*	PgnReader(.h/.cpp) contains the streaming reader of pgn files.
+* 
+*	The file is read in large blocks into a buffer and tokenized in place, so that the tags, move numbers,
+*	comments, variations and NAGs are skipped without allocating a string per line or token. The moves are
+*	parsed both in the standard algebraic notation and in the long algebraic one (e2e4). A reader can be
+*	limited to a chunk of the file, so that several threads can read the same file in parallel.
+*/
+
+namespace engine {
+	// A single game from a pgn file
+	struct PgnGame final {
+		u64 offset = 0; // Of the game's beginning in the file
+		std::string initialFen;
+		float result = 0.5f; // For white, either of 0.0, 0.5, or 1.0
+		bool isResultKnown = false; // The result is 1-0, 0-1 or 1/2-1/2, not * or missing (then it is 0.5)
+		std::vector<Move> moves; // Till the end of the game or the first move that could not be read
+		bool isCorrupted = false; // Some move could not be read
+	};
+
+	// A part of a pgn file that starts at a game's header
+	struct PgnChunk final {
+		std::string path;
+		u64 begin;
+		u64 end;
+	};
+
+	class PgnReader final {
+	public:
+		constexpr inline static size_t BUFFER_SIZE = 1 << 20;
+		constexpr inline static size_t MAX_TOKEN_SIZE = 4096; // Longer tokens are cut
+
+	private:
+		std::ifstream m_file;
+		std::unique_ptr<char[]> m_buffer;
+		size_t m_size = 0; // Of the data in the buffer
+		size_t m_position = 0; // In the buffer
+		u64 m_bufferOffset = 0; // Of the buffer's beginning in the file
+		u64 m_end = 0; // The games that begin at or after it are not read
+
+	public:
+		PgnReader();
+
+		// Opens the file to read the games that begin in [begin, end)
+		bool open(const std::string& path, const u64 begin = 0, const u64 end = UINT64_MAX);
+		bool open(const PgnChunk& chunk);
+
+		// Reads the next game, returns false if there are no more games
+		bool readGame(PgnGame& game);
+
+		// Splits the pgn file into chunks of about <chunkSize> bytes at the games' boundaries, so that
+		// they can be read in parallel; returns false if the file cannot be read
+		static bool split(const std::string& path, const u64 chunkSize, std::vector<PgnChunk>& chunks);
+
+	private:
+		// Makes sure at least <count> bytes are in the buffer unless the file ends, returns the bytes available
+		size_t fill(const size_t count);
+
+		int peek();
+		void skipSpaces();
+
+		// Skips till the character inclusively
+		void skipTill(const char ch);
+
+		// The returned view is valid till the next read
+		std::string_view readToken();
+
+		void readTag(PgnGame& game);
+	};
+}
@@ -0,0 +1,284 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "PositionIndex.h"
+#include <queue>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "Utils/MappedFile.h"
+#include "Chess/Zobrist.h"
+#include "PgnReader.h"
+
+namespace engine {
+	struct PositionIndexHeader final {
+		char magic[8];
+		u64 recordsCount;
+		u64 gamesCount;
+		u64 pgnSize; // To find out that the pgn file was changed after indexing
+	};
+
+	static_assert(sizeof(PositionIndexHeader) == 32);
+
+	struct PositionRecord final {
+		Hash key;
+		u64 offset;
+
+		CM_PURE constexpr bool operator<(const PositionRecord& other) const noexcept {
+			return key < other.key || (key == other.key && offset < other.offset);
+		}
+
+		CM_PURE constexpr bool operator==(const PositionRecord& other) const noexcept {
+			return key == other.key && offset == other.offset;
+		}
+	};
+
+	static_assert(sizeof(PositionRecord) == 16);
+
+	constexpr char INDEX_MAGIC[8] = "CGMPI01";
+	constexpr const char* INDEX_EXTENSION = ".cgpi";
+	constexpr u64 CHUNK_SIZE = 16ull << 20; // The pgn file is split into chunks of about that size
+	constexpr size_t WRITE_BUFFER_SIZE = 4096; // In records
+
+	// The Zobrist key computed from scratch, since the incremental key of the board depends on the moves parity
+	// and so differs for the same position set up from a FEN; en passant is only accounted if there is a pawn
+	// to capture it, so that the transpositions after a double pawn push are found
+	CM_PURE Hash positionKey(const Board& board) noexcept {
+		Hash result = zobrist::SIDE[board.side()] ^ zobrist::CASTLING[board.castleRight()];
+
+		BitBoard pieces = board.allPieces();
+		BB_FOR_EACH(sq, pieces) {
+			result ^= zobrist::PIECE[board[sq]][sq];
+		}
+
+		const Color side = board.side();
+		if (board.ep() != Square::NO_POS && BitBoard::pawnAttacks(side.getOpposite(), board.ep()).b_and(board.pawns(side))) {
+			result ^= zobrist::EP[board.ep().getFile()];
+		}
+
+		return result;
+	}
+
+	void indexChunk(const PgnChunk& chunk, const u32 maxPly, std::vector<PositionRecord>& records, std::atomic<u64>& gamesCount) {
+		PgnReader pgn;
+		if (!pgn.open(chunk)) {
+			return;
+		}
+
+		PgnGame game;
+		while (pgn.readGame(game)) {
+			bool success;
+			Board board = Board::fromFEN(game.initialFen, success);
+			if (!success) {
+				continue;
+			}
+
+			const size_t gameBegin = records.size();
+			const size_t plies = std::min<size_t>(game.moves.size(), maxPly);
+			records.push_back(PositionRecord { positionKey(board), game.offset });
+			for (size_t ply = 0; ply < plies; ply++) {
+				board.makeMove(game.moves[ply]);
+				records.push_back(PositionRecord { positionKey(board), game.offset });
+			}
+
+			// A position repeated within the game is recorded once
+			std::sort(records.begin() + gameBegin, records.end());
+			records.erase(std::unique(records.begin() + gameBegin, records.end()), records.end());
+
+			gamesCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	std::string PositionIndex::indexPath(const std::string& pgnFile) {
+		return pgnFile + INDEX_EXTENSION;
+	}
+
+	bool PositionIndex::build(const std::string& pgnFile, const u32 threadsCount, const u32 maxPly, PositionIndexReport& report) {
+		using namespace std::chrono;
+
+		const auto start = high_resolution_clock::now();
+		report = PositionIndexReport();
+
+		std::vector<PgnChunk> chunks;
+		if (!PgnReader::split(pgnFile, CHUNK_SIZE, chunks)) {
+			return false;
+		}
+
+		// Every thread collects and sorts its own records
+		std::vector<std::vector<PositionRecord>> threadRecords(std::max(threadsCount, 1u));
+		std::atomic<size_t> nextChunk = 0;
+		std::atomic<u64> gamesCount = 0;
+		const auto worker = [&](const u32 threadId) {
+			std::vector<PositionRecord>& records = threadRecords[threadId];
+			for (size_t chunk; (chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks.size();) {
+				indexChunk(chunks[chunk], maxPly, records, gamesCount);
+			}
+
+			std::sort(records.begin(), records.end());
+		};
+
+		std::vector<std::thread> threads;
+		for (u32 i = 1; i < threadRecords.size(); i++) {
+			threads.emplace_back(worker, i);
+		}
+
+		worker(0);
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+
+		PositionIndexHeader header { };
+		memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+		header.gamesCount = gamesCount.load(std::memory_order_relaxed);
+		header.pgnSize = std::filesystem::file_size(pgnFile);
+		for (const std::vector<PositionRecord>& records : threadRecords) {
+			header.recordsCount += records.size();
+		}
+
+		const std::string path = indexPath(pgnFile);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		// K-way merge of the threads' records
+		using HeapItem = std::pair<PositionRecord, size_t>;
+		const auto heapCompare = [](const HeapItem& a, const HeapItem& b) { return b.first < a.first; };
+		std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(heapCompare)> heap(heapCompare);
+		std::vector<size_t> positions(threadRecords.size(), 0);
+
+		for (size_t i = 0; i < threadRecords.size(); i++) {
+			if (!threadRecords[i].empty()) {
+				heap.emplace(threadRecords[i][positions[i]++], i);
+			}
+		}
+
+		std::vector<PositionRecord> buffer;
+		buffer.reserve(WRITE_BUFFER_SIZE);
+		while (!heap.empty()) {
+			const auto [record, source] = heap.top();
+			heap.pop();
+
+			if (positions[source] < threadRecords[source].size()) {
+				heap.emplace(threadRecords[source][positions[source]++], source);
+			}
+
+			buffer.push_back(record);
+			if (buffer.size() == WRITE_BUFFER_SIZE || heap.empty()) {
+				file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size() * sizeof(PositionRecord)));
+				buffer.clear();
+			}
+		}
+
+		file.close();
+
+		report.games = header.gamesCount;
+		report.positions = header.recordsCount;
+		report.time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+		report.fileSize = sizeof(header) + header.recordsCount * sizeof(PositionRecord);
+
+		return !file.fail();
+	}
+
+	bool PositionIndex::find(const std::string& pgnFile, const Board& board, std::vector<u64>& offsets) {
+		MappedFile file;
+		if (!file.open(indexPath(pgnFile)) || file.size() < sizeof(PositionIndexHeader)) {
+			return false;
+		}
+
+		PositionIndexHeader header;
+		memcpy(&header, file.data(), sizeof(PositionIndexHeader));
+
+		std::error_code error;
+		if (memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC))
+			|| file.size() != sizeof(PositionIndexHeader) + header.recordsCount * sizeof(PositionRecord)
+			|| std::filesystem::file_size(pgnFile, error) != header.pgnSize) {
+			return false;
+		}
+
+		const auto recordAt = [&file](const u64 index) {
+			PositionRecord record;
+			memcpy(&record, file.data() + sizeof(PositionIndexHeader) + index * sizeof(PositionRecord), sizeof(PositionRecord));
+			return record;
+		};
+
+		// Lower bound of the key
+		const Hash key = positionKey(board);
+		u64 low = 0;
+		u64 high = header.recordsCount;
+		while (low < high) {
+			const u64 middle = (low + high) / 2;
+			if (recordAt(middle).key < key) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+
+		for (PositionRecord record; low < header.recordsCount && (record = recordAt(low)).key == key; low++) {
+			offsets.push_back(record.offset);
+		}
+
+		return true;
+	}
+
+	IndexedGame PositionIndex::readGame(const std::string& pgnFile, const u64 offset) {
+		IndexedGame game;
+		game.offset = offset;
+
+		std::ifstream pgn(pgnFile, std::ios::binary);
+		pgn.seekg(std::streamoff(offset));
+
+		std::string line;
+		bool isInHeader = false;
+		while (std::getline(pgn, line)) {
+			if (line.empty() || line[0] != '[') {
+				if (isInHeader) {
+					break;
+				}
+
+				continue; // The blank lines before the game
+			}
+
+			isInHeader = true;
+
+			const size_t valueFrom = line.find('"');
+			const size_t valueTo = line.find_last_of('"');
+			if (valueFrom == std::string::npos || valueTo <= valueFrom) {
+				continue;
+			}
+
+			const std::string value = line.substr(valueFrom + 1, valueTo - valueFrom - 1);
+			if (line.starts_with("[White ")) {
+				game.white = value;
+			} else if (line.starts_with("[Black ")) {
+				game.black = value;
+			} else if (line.starts_with("[Result ")) {
+				game.result = value;
+			} else if (line.starts_with("[Date ")) {
+				game.date = value;
+			}
+		}
+
+		return game;
+	}
+}
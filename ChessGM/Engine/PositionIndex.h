@@ -0,0 +1,68 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Chess/Board.h"
+
+/*
+*	PositionIndex(.h/.cpp) contains the index of the positions reached in the games of a pgn file.
+* 
+*	The index file is written next to the pgn file (with the .cgpi extension added) and consists of a header
+*	and 16-byte records (position key, game offset in the pgn file) sorted by the key. The games are split
+*	between threads by chunks of the pgn file, every thread sorts its own records and then they are merged
+*	into the file. The lookups map the index file and find the records of a position with a binary search,
+*	so there is no loading phase and only the touched pages are read.
+*/
+
+namespace engine {
+	struct PositionIndexReport final {
+		u64 games = 0;
+		u64 positions = 0; // Records written, the repetitions within a game are counted once
+		u64 time = 0; // In milliseconds
+		u64 fileSize = 0;
+	};
+
+	// The tags of a game found in the index
+	struct IndexedGame final {
+		u64 offset = 0;
+		std::string white;
+		std::string black;
+		std::string result;
+		std::string date;
+	};
+
+	class PositionIndex final {
+	public:
+		static std::string indexPath(const std::string& pgnFile);
+
+		// Indexes the positions within <maxPly> half-moves from the start of each game
+		// Returns false if the pgn file could not be read or the index could not be written
+		static bool build(const std::string& pgnFile, const u32 threadsCount, const u32 maxPly, PositionIndexReport& report);
+
+		// Appends the offsets of the games that reached the position, in the order of the games in the file
+		// Returns false if there is no valid index for the pgn file
+		static bool find(const std::string& pgnFile, const Board& board, std::vector<u64>& offsets);
+
+		// Reads the tags of the game at the offset
+		static IndexedGame readGame(const std::string& pgnFile, const u64 offset);
+	};
+}
@@ -17,6 +17,7 @@
 */
 
 #include "Scores.h"
+#include <string>
 
 #define Z Score()
 #define S(mg, eg) Score(mg, eg)
@@ -233,4 +234,169 @@ namespace scores {
 			}
 		}
 	}
+	///  WEIGHTS  ///
+
+	// A named array of weights as it is declared in this file
+	struct WeightsArray final {
+		const char* declaration;
+		Score* data;
+		u32 size;
+		bool isArray;
+	};
+
+	constexpr WeightsArray WEIGHTS_ARRAYS[] = {
+		{ "Score TEMPO_SCORE", &TEMPO_SCORE, 1, false },
+		{ "Score PAWN_ISLANDS[5]", PAWN_ISLANDS, 5, true },
+		{ "Score DEFENDED_PAWN[Rank::VALUES_COUNT]", DEFENDED_PAWN, Rank::VALUES_COUNT, true },
+		{ "Score ISOLATED_PAWN", &ISOLATED_PAWN, 1, false },
+		{ "Score BACKWARD_PAWN", &BACKWARD_PAWN, 1, false },
+		{ "Score DOUBLE_PAWN", &DOUBLE_PAWN, 1, false },
+		{ "Score PAWN_DISTORTION", &PAWN_DISTORTION, 1, false },
+		{ "Score PASSED_PAWN[Rank::VALUES_COUNT]", PASSED_PAWN, Rank::VALUES_COUNT, true },
+		{ "Score ROOK_BEHIND_PASSED_PAWN", &ROOK_BEHIND_PASSED_PAWN, 1, false },
+		{ "Score MINOR_PASSED_BLOCKED", &MINOR_PASSED_BLOCKED, 1, false },
+		{ "Score OUTPOST", &OUTPOST, 1, false },
+		{ "Score KNIGHT_MOBILITY[9]", KNIGHT_MOBILITY, 9, true },
+		{ "Score BISHOP_MOBILITY[14]", BISHOP_MOBILITY, 14, true },
+		{ "Score BISHOP_PAIR", &BISHOP_PAIR, 1, false },
+		{ "Score ROOK_MOBILITY[15]", ROOK_MOBILITY, 15, true },
+		{ "Score ROOK_ON_OPEN_FILE", &ROOK_ON_OPEN_FILE, 1, false },
+		{ "Score ROOK_ON_SEMIOPEN_FILE", &ROOK_ON_SEMIOPEN_FILE, 1, false },
+		{ "Score QUEEN_MOBILITY[28]", QUEEN_MOBILITY, 28, true },
+		{ "Score PIECE_VALUE[PieceType::VALUES_COUNT]", PIECE_VALUE, PieceType::VALUES_COUNT, true }
+	};
+
+	constexpr u32 PST_HALF_SIZE = 32;
+	constexpr u32 PST_WEIGHTS_COUNT = PST_HALF_SIZE * (PieceType::VALUES_COUNT - 1); // All but PieceType::NONE
+
+	CM_PURE constexpr u32 countArrayWeights() {
+		u32 result = 0;
+		for (const WeightsArray& array : WEIGHTS_ARRAYS) {
+			result += array.size;
+		}
+
+		return result;
+	}
+
+	constexpr u32 ARRAY_WEIGHTS_COUNT = countArrayWeights();
+
+	// The square of the white piece that uses the given piece-square weight, as in initScores
+	CM_PURE Square pstWhiteSquare(const u32 halfIndex) noexcept {
+		return Square(File(halfIndex & 3), Rank(halfIndex >> 2)).getOpposite();
+	}
+
+	CM_PURE std::string toString(const Score score) {
+		if (score == Score()) {
+			return "Z";
+		}
+
+		return "S(" + std::to_string(score.middlegame()) + ", " + std::to_string(score.endgame()) + ")";
+	}
+
+	u32 Weights::count() noexcept {
+		return ARRAY_WEIGHTS_COUNT + PST_WEIGHTS_COUNT;
+	}
+
+	u32 Weights::indexOf(const Score& weight) noexcept {
+		u32 result = 0;
+		for (const WeightsArray& array : WEIGHTS_ARRAYS) {
+			if (&weight >= array.data && &weight < array.data + array.size) {
+				return result + u32(&weight - array.data);
+			}
+
+			result += array.size;
+		}
+
+		return result; // Not reached for the weights from the list
+	}
+
+	u32 Weights::pstIndexOf(const Piece piece, const Square sq) noexcept {
+		Square halfSq = piece.getColor() == Color::WHITE ? sq.getOpposite() : sq;
+		if (halfSq.getFile() > File::D) {
+			halfSq = halfSq.mirrorByFile();
+		}
+
+		return ARRAY_WEIGHTS_COUNT + (piece.getType() - PieceType::PAWN) * PST_HALF_SIZE + halfSq.getRank() * 4 + halfSq.getFile();
+	}
+
+	Score Weights::get(u32 index) noexcept {
+		for (const WeightsArray& array : WEIGHTS_ARRAYS) {
+			if (index < array.size) {
+				return array.data[index];
+			}
+
+			index -= array.size;
+		}
+
+		const PieceType pt = PieceType::Value(PieceType::PAWN + index / PST_HALF_SIZE);
+		return PST[Piece(Color::WHITE, pt)][pstWhiteSquare(index % PST_HALF_SIZE)] - PIECE_VALUE[pt];
+	}
+
+	void Weights::set(u32 index, const Score value) noexcept {
+		for (const WeightsArray& array : WEIGHTS_ARRAYS) {
+			if (index >= array.size) {
+				index -= array.size;
+				continue;
+			}
+
+			// The piece values are included into the piece-square tables
+			if (array.data == PIECE_VALUE) {
+				const PieceType pt = PieceType::Value(index);
+				const Score delta = value - PIECE_VALUE[pt];
+				for (const Color color : { Color::WHITE, Color::BLACK }) {
+					for (const Square sq : Square::iter()) {
+						PST[Piece(color, pt)][sq] += delta;
+					}
+
+					SIMPLIFIED_PIECE_VALUES[Piece(color, pt)] = (value.middlegame() + value.endgame()) / 2;
+				}
+			}
+
+			array.data[index] = value;
+			return;
+		}
+
+		const PieceType pt = PieceType::Value(PieceType::PAWN + index / PST_HALF_SIZE);
+		const Square sqW = pstWhiteSquare(index % PST_HALF_SIZE);
+		const Square sqB = sqW.getOpposite();
+		const Score score = value + PIECE_VALUE[pt];
+
+		PST[Piece(Color::WHITE, pt)][sqW] = PST[Piece(Color::WHITE, pt)][sqW.mirrorByFile()] = score;
+		PST[Piece(Color::BLACK, pt)][sqB] = PST[Piece(Color::BLACK, pt)][sqB.mirrorByFile()] = score;
+	}
+
+	void Weights::dump(std::ostream& out) {
+		constexpr u32 SCORES_PER_LINE = 10;
+		constexpr const char* PIECE_NAMES[PieceType::VALUES_COUNT] = { "None", "Pawn", "Knight", "Bishop", "Rook", "Queen", "King" };
+
+		for (const WeightsArray& array : WEIGHTS_ARRAYS) {
+			out << "\t" << array.declaration << " = ";
+			if (!array.isArray) {
+				out << toString(*array.data) << ";\n\n";
+				continue;
+			}
+
+			out << "{\n\t\t";
+			for (u32 i = 0; i < array.size; i++) {
+				out << toString(array.data[i]) << (i + 1 == array.size ? "\n" : (i + 1) % SCORES_PER_LINE ? ", " : ",\n\t\t");
+			}
+
+			out << "\t};\n\n";
+		}
+
+		out << "\tScore PST[Piece::VALUES_COUNT][Square::VALUES_COUNT] = {\n\t\t{ Z }, { Z }, // None\n";
+		u32 index = ARRAY_WEIGHTS_COUNT;
+		for (const PieceType pt : PieceType::iter()) {
+			if (pt == PieceType::NONE) {
+				continue;
+			}
+
+			out << (pt == PieceType::PAWN ? "\t\t{ }, { // " : "\t\t}, { }, { // ") << PIECE_NAMES[pt] << "\n";
+			for (u32 i = 0; i < PST_HALF_SIZE; i++, index++) {
+				out << (i % 4 ? "\t" : "\t\t\t ") << toString(get(index)) << "," << (i % 4 == 3 ? "\n" : "");
+			}
+		}
+
+		out << "\t\t}\n\t};\n";
+	}
 }
\ No newline at end of file
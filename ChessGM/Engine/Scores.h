@@ -17,6 +17,7 @@
 */
 
 #pragma once
+#include <ostream>
 #include "Chess/Score.h"
 #include "Chess/Defs.h"
 
@@ -65,10 +66,25 @@ namespace scores {
 
 	extern Score TEMPO_SCORE;
 
-	// TODO: implement
-	// Intended to be used for loading/storing the weights
+	// The flattened list of all the tunable Score weights, used for loading/storing the weights.
+	// The piece-square tables are represented by their halves as in Scores.cpp, without the piece values.
 	class Weights final {
+	public:
+		static u32 count() noexcept;
 
+		// Returns the index of a weight from any of the arrays except for PST
+		static u32 indexOf(const Score& weight) noexcept;
+
+		// Returns the index of the piece-square weight that is used for the piece on the square
+		static u32 pstIndexOf(const Piece piece, const Square sq) noexcept;
+
+		static Score get(const u32 index) noexcept;
+
+		// Also updates the values that depend on the weight (PST and SIMPLIFIED_PIECE_VALUES)
+		static void set(const u32 index, const Score value) noexcept;
+
+		// Prints the weights in the format of Scores.cpp
+		static void dump(std::ostream& out);
 	};
 
 	void initScores();
@@ -83,6 +99,7 @@ namespace engine {
 	constexpr Value INF = 31000;
 	constexpr Value MATE = 30000;
 	constexpr Value SURE_WIN = 20000; // A value that cannot be reached with normal evaluation
+	constexpr Value TB_WIN = MATE - MAX_DEPTH * 2 - 2; // A tablebase win, above any evaluation but below the mate values
 
 
 	///  AUXILIARY FUNCTIONS  ///
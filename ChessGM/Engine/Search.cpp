@@ -19,13 +19,26 @@
 #include "Search.h"
 #include <utility>
 #include <atomic>
+#include <memory>
+#include <iomanip>
+#include <fstream>
 #include <algorithm>
 
 #include "Utils/IO.h"
+#include "Utils/ThreadPool.h"
 #include "Eval.h"
 #include "Engine.h"
 #include "MovePicker.h"
 #include "TranspositionTable.h"
+#include "Watchdog.h"
+#include "KPKBitbase.h"
+#include "Syzygy.h"
+
+#ifdef ENABLE_SEARCH_STATS
+#define SEARCH_STAT(statement) statement
+#else
+#define SEARCH_STAT(statement)
+#endif
 
 namespace engine {
 	// Constants
@@ -48,15 +61,70 @@ namespace engine {
 
 
 	// Global variables
-	std::atomic_bool g_mustStop = false; // Must the search stop?
+	// The search state is thread local, so that several independent searches can run in parallel
+	thread_local std::atomic_bool g_mustStop = false; // Must the search stop?
+
+	thread_local NodesCount g_nodesCount = 0; // Nodes during the current search
+	thread_local NodesCount g_tbHits = 0;
+	thread_local Depth g_rootDepth = 0;
+	thread_local SearchStack g_searchStacks[2 * MAX_DEPTH + 2];
+	thread_local MoveList g_moveLists[2 * MAX_DEPTH];
+	thread_local MoveList g_PVs[2 * MAX_DEPTH];
+	thread_local MoveList g_tbRootMoves; // The root moves that keep the tablebase result, empty if the root is not in the tablebases
+
+	thread_local Limits g_limits;
+	thread_local bool g_isInputChecked = true;
+	thread_local void (*g_onIteration)(const SearchResult& result, Depth depth, const MoveList& pv) = nullptr;
+
+	// Lazy SMP: the helper threads search the same position and share the results through the transposition table
+	thread_local u32 g_threadsCount = 1;
+	thread_local u32 g_threadId = 0; // 0 for the thread that started the search, the helpers have the others
+	std::atomic_bool g_stopHelpers = false; // Set once the thread that started the search has finished it
+	std::unique_ptr<ThreadPool> g_helpersPool;
+
+	// The helpers publish their counters here, so that the main thread's info covers all the threads
+	struct alignas(64) HelperCounters {
+		std::atomic<NodesCount> nodes = 0;
+		std::atomic<NodesCount> tbHits = 0;
+	};
+	std::unique_ptr<HelperCounters[]> g_helperCounters;
+
+	thread_local SearchStats g_searchStats;
+	std::string g_searchStatsOutput;
+
+	template<NodeType NT>
+	INLINE SearchNodeStats& nodeStats(const Depth depth) {
+		return g_searchStats.byDepth[u8(NT)][std::min(depth, MAX_DEPTH)];
+	}
+
+	void dumpSearchStats();
+
+	// Called every 512 nodes, the helpers' counters lag behind by at most that much
+	INLINE void publishCounters() {
+		if (g_threadId != 0) {
+			g_helperCounters[g_threadId].nodes.store(g_nodesCount, std::memory_order_relaxed);
+			g_helperCounters[g_threadId].tbHits.store(g_tbHits, std::memory_order_relaxed);
+		}
+	}
 
-	NodesCount g_nodesCount = 0; // Nodes during the current search
-	Depth g_rootDepth = 0;
-	SearchStack g_searchStacks[2 * MAX_DEPTH + 2];
-	MoveList g_moveLists[2 * MAX_DEPTH];
-	MoveList g_PVs[2 * MAX_DEPTH];
+	// The counters of all the threads of the current search, for the main thread's info
+	NodesCount totalNodesCount() {
+		NodesCount result = g_nodesCount;
+		for (u32 i = 1; i < g_threadsCount; i++) {
+			result += g_helperCounters[i].nodes.load(std::memory_order_relaxed);
+		}
+
+		return result;
+	}
 
-	Limits g_limits;
+	NodesCount totalTbHits() {
+		NodesCount result = g_tbHits;
+		for (u32 i = 1; i < g_threadsCount; i++) {
+			result += g_helperCounters[i].tbHits.load(std::memory_order_relaxed);
+		}
+
+		return result;
+	}
 
 
 	///  SEARCH FUNCTIONS  ///
@@ -84,7 +152,69 @@ namespace engine {
 		return result;
 	}
 
+	SearchResult iterativeDeepening(Board& board);
+	SearchResult parallelSearch(Board& board);
+
 	SearchResult rootSearch(Board& board) {
+		SEARCH_STAT(g_searchStats = SearchStats());
+		const SearchResult result = g_threadsCount > 1 ? parallelSearch(board) : iterativeDeepening(board);
+		Watchdog::clear(g_mustStop);
+		SEARCH_STAT(dumpSearchStats());
+
+		return result;
+	}
+
+	// The helpers run the iterative deepening on their copies of the board with no limits till the main thread
+	// (the one that started the search) ends it, and only the main thread's result is used. The helpers share the
+	// table without locks: a torn entry can give a wrong value, but its move is only tried if it was generated
+	SearchResult parallelSearch(Board& board) {
+		if (!g_helpersPool || g_helpersPool->threadsCount() != g_threadsCount) {
+			g_helpersPool = std::make_unique<ThreadPool>(g_threadsCount);
+			g_helperCounters = std::make_unique<HelperCounters[]>(g_threadsCount);
+		}
+
+		// The copies are made before the main thread starts changing the board
+		std::vector<Board> boards;
+		boards.reserve(g_threadsCount - 1);
+		for (u32 i = 1; i < g_threadsCount; i++) {
+			boards.push_back(board.copy());
+		}
+
+		for (u32 i = 0; i < g_threadsCount; i++) {
+			g_helperCounters[i].nodes = 0;
+			g_helperCounters[i].tbHits = 0;
+		}
+
+		SearchResult result;
+
+		g_stopHelpers = false;
+		g_helpersPool->run([&](const u32 threadId) {
+			if (threadId == 0) {
+				result = iterativeDeepening(board);
+				g_stopHelpers = true;
+				return;
+			}
+
+			g_threadId = threadId;
+			g_isInputChecked = false;
+			g_onIteration = nullptr;
+			g_limits.makeInfinite();
+			TranspositionTable::useWholeTable();
+
+			iterativeDeepening(boards[threadId - 1]);
+			publishCounters();
+		});
+
+		g_stopHelpers = false;
+		for (u32 i = 1; i < g_threadsCount; i++) {
+			g_nodesCount += g_helperCounters[i].nodes;
+			g_tbHits += g_helperCounters[i].tbHits;
+		}
+
+		return result;
+	}
+
+	SearchResult iterativeDeepening(Board& board) {
 		//static MoveList moves;
 
 		Move lastBest;
@@ -96,16 +226,35 @@ namespace engine {
 		// Initializing the search
 		g_mustStop = false;
 		g_nodesCount = 0;
-		g_rootDepth = 0;
+		g_tbHits = 0;
+		g_rootDepth = g_threadId & 1; // Half of the helpers skip the first depth, so that the threads search different depths
 
 		MovePicker::resetHistoryTables();
 		TranspositionTable::setRootAge(board.moveCount());
 
 		memset(g_searchStacks, 0, sizeof(g_searchStacks));
 
+		// Leaving only the moves that keep the tablebase result
+		g_tbRootMoves.clear();
+		if (Syzygy::canProbe(board)) {
+			MoveList& moves = g_moveLists[0];
+			board.generateMoves(moves);
+			for (Move m : moves) {
+				if (board.isLegal(m)) {
+					g_tbRootMoves.push(m);
+				}
+			}
+
+			if (Syzygy::filterRootMoves(board, g_tbRootMoves)) {
+				++g_tbHits;
+			} else {
+				g_tbRootMoves.clear();
+			}
+		}
+
 		// Looking for the best move
 		while (!g_limits.isDepthLimitBroken(++g_rootDepth)) {
-
+			SEARCH_STAT(g_searchStats.rootDepth = g_rootDepth);
 
 			///  ASPIRATION WINDOW  ///
 
@@ -124,9 +273,11 @@ namespace engine {
 				}
 
 				if (result <= alpha && failedLowCnt < std::size(WINDOW_WIDTH) - 1) { // Failed low
+					SEARCH_STAT(++g_searchStats.aspirationResearches[std::min(g_rootDepth, MAX_DEPTH)]);
 					alpha = Value(std::max(i32(-INF), i32(result) - WINDOW_WIDTH[++failedLowCnt]));
 					beta = Value(std::min(i32(INF), i32(result) + WINDOW_WIDTH[failedHighCnt]));
-				} else if (result >= beta && failedHighCnt < std::size(WINDOW_WIDTH) - 1) { // Failed low
+				} else if (result >= beta && failedHighCnt < std::size(WINDOW_WIDTH) - 1) { // Failed high
+					SEARCH_STAT(++g_searchStats.aspirationResearches[std::min(g_rootDepth, MAX_DEPTH)]);
 					alpha = Value(std::max(i32(-INF), i32(result) - WINDOW_WIDTH[failedLowCnt]));
 					beta = Value(std::min(i32(INF), i32(result) + WINDOW_WIDTH[++failedHighCnt]));
 				} else {
@@ -134,13 +285,19 @@ namespace engine {
 				}
 			}
 
+			// The hard limit is watched once the first iteration has given a move to play
+			if (lastBest.isNullMove()) {
+				updateSearchDeadline();
+			}
+
 			// Printing the current search state
-			if (options::g_postMode) {
+			if (options::g_postMode && g_threadId == 0) {
 				if (io::getMode() == io::IOMode::UCI) {
 					io::g_out
 						<< "info depth " << g_rootDepth
-						<< " nodes " << g_nodesCount
-						<< " time " << g_limits.elapsedMilliseconds();
+						<< " nodes " << totalNodesCount()
+						<< " time " << g_limits.elapsedMilliseconds()
+						<< " tbhits " << totalTbHits();
 
 					if (isMateValue(result)) {
 						io::g_out << " score mate " << (result < 0 ? -gettingMatedIn(result) : givingMateIn(result));
@@ -153,11 +310,15 @@ namespace engine {
 					io::g_out << g_rootDepth << ' '
 						<< result << ' '
 						<< g_limits.elapsedCentiseconds() << ' '
-						<< g_nodesCount << ' '
+						<< totalNodesCount() << ' '
 						<< g_PVs[0].toString() << std::endl;
 				}
 			}
 
+			if (g_onIteration) {
+				g_onIteration(SearchResult { .best = g_PVs[0][0], .value = result }, g_rootDepth, g_PVs[0]);
+			}
+
 			// Check if we reached the soft limit
 			// Here is the perfect place to stop search
 			if (g_limits.isSoftLimitBroken()) {
@@ -183,19 +344,24 @@ namespace engine {
 			return alpha;
 		}
 
-		// Checking limits and input
+		// Checking the nodes limit and input (the time limit is watched by Watchdog, which raises g_mustStop)
 		if ((g_nodesCount & 0x1ff) == 0) {
-			if (g_limits.isHardLimitBroken() || g_limits.isNodesLimitBroken(g_nodesCount)) {
+			publishCounters();
+			if (g_limits.isNodesLimitBroken(g_nodesCount) || g_stopHelpers.load(std::memory_order_relaxed)) {
 				g_mustStop = true;
 				return alpha;
 			}
 
-			// Cheching for possible input once in 8192 nodes
-			if ((g_nodesCount & 0x1fff) == 0) {
-				checkInput();
+			// The input thread counts the urgent commands (stop, isready...), so it is just an atomic load
+			// The first iteration is always completed, so that there is a move to return
+			if (g_isInputChecked && g_rootDepth > 1 && io::hasUrgentCommands() && checkInput()) {
+				g_mustStop = true;
+				return alpha;
 			}
 		}
 
+		SEARCH_STAT(++nodeStats<NT>(depth).nodes);
+
 		//if constexpr (NT == NodeType::PV) {
 			g_PVs[ply].clear();
 		//}
@@ -210,6 +376,11 @@ namespace engine {
 			return alpha;
 		}
 
+		// The exact result of KPK is known from the bitbase, so there is nothing to search
+		if (ply > 0 && KPKBitbase::isKPK(board)) {
+			return eval(board);
+		}
+
 
 		///  MATE DISTANCE PRUNING  ///
 
@@ -228,6 +399,8 @@ namespace engine {
 		TableEntry* entry = TranspositionTable::probe(board.computeHash());
 		Move tableMove = Move::makeNullMove();
 		if (entry != nullptr) { // Current position was found
+			SEARCH_STAT(++nodeStats<NT>(depth).ttHits);
+
 			// Check if it is possible to just return the value from the table
 			if (entry->depth >= depth && ply && (entry->isPvNode() || NT != NodeType::PV)) {
 				Value value = entry->value;
@@ -240,13 +413,17 @@ namespace engine {
 				}
 
 				switch (entry->getBoundType()) {
-					case EntryType::EXACT: return value;
+					case EntryType::EXACT:
+						SEARCH_STAT(++nodeStats<NT>(depth).ttCutoffs);
+						return value;
 					case EntryType::ALPHA: 
 						if (value <= alpha) {
+							SEARCH_STAT(++nodeStats<NT>(depth).ttCutoffs);
 							return alpha;
 						} break;
 					case EntryType::BETA:
 						if (value >= beta) {
+							SEARCH_STAT(++nodeStats<NT>(depth).ttCutoffs);
 							return beta;
 						} break;
 				default: break;
@@ -257,6 +434,45 @@ namespace engine {
 		}
 
 
+		///  TABLEBASES  ///
+
+		// The material changes only after captures and pawn moves, so it is enough to probe right after them
+		Value tbMinValue = -INF;
+		Value tbMaxValue = INF;
+		if (ply && board.fiftyRule() == 0 && Syzygy::canProbe(board)) {
+			if (WDLScore wdl; Syzygy::probeWDL(board, wdl)) {
+				++g_tbHits;
+
+				// Cursed wins and blessed losses are draws by the 50-move rule
+				const Value value = wdl == WDLScore::WIN ? TB_WIN - ply
+					: wdl == WDLScore::LOSS ? -TB_WIN + ply
+					: 0;
+				const EntryType bound = wdl == WDLScore::WIN ? EntryType::BETA
+					: wdl == WDLScore::LOSS ? EntryType::ALPHA
+					: EntryType::EXACT;
+
+				if (bound == EntryType::EXACT || (bound == EntryType::BETA ? value >= beta : value <= alpha)) {
+					TranspositionTable::tryRecord(
+						EntryType(u8(bound) | u8(NT)),
+						board.computeHash(),
+						0,
+						value,
+						board.moveCount(),
+						std::min(depth + 6, MAX_DEPTH),
+						ply
+					);
+
+					return value;
+				}
+
+				// The PV nodes are still searched to get the PV, but the result is kept within the tablebase bound
+				if constexpr (NT == NodeType::PV) {
+					(bound == EntryType::BETA ? tbMinValue : tbMaxValue) = value;
+				}
+			}
+		}
+
+
 		///  PRUNINGS AND REDUCTIONS  ///
 
 		const bool isInCheck = board.isInCheck();
@@ -272,8 +488,10 @@ namespace engine {
 				const Value margin = FUTILITY_MARGIN[depth];
 
 				if (staticEval <= alpha - margin) {
+					SEARCH_STAT(++nodeStats<NT>(depth).futilityPrunes);
 					return quiescence(board, alpha, beta, ply, 0);
 				} if (staticEval >= beta + margin) {
+					SEARCH_STAT(++nodeStats<NT>(depth).futilityPrunes);
 					return beta;
 				}
 			}
@@ -292,6 +510,7 @@ namespace engine {
 					R = 0;
 				}
 
+				SEARCH_STAT(++nodeStats<NT>(depth).nullMoveTries);
 				board.makeNullMove();
 				Value tmp = -search<NodeType::NON_PV>(board, -beta, -beta + 1, depth - R, ply + 1);
 				board.unmakeNullMove();
@@ -309,9 +528,13 @@ namespace engine {
 						Value verification = search<NodeType::NON_PV>(board, beta - 1, beta, depth - R, ply);
 
 						if (verification >= beta) {
+							SEARCH_STAT(++nodeStats<NT>(depth).nullMoveCutoffs);
 							return tmp;
 						}
+
+						SEARCH_STAT(++nodeStats<NT>(depth).nullMoveVerificationFailures);
 					} else {
+						SEARCH_STAT(++nodeStats<NT>(depth).nullMoveCutoffs);
 						return tmp;
 					}
 				}
@@ -349,6 +572,11 @@ namespace engine {
 				continue;
 			}
 
+			// Skipping the root moves that spoil the tablebase result
+			if (!ply && g_tbRootMoves.size() && std::find(g_tbRootMoves.begin(), g_tbRootMoves.end(), m) == g_tbRootMoves.end()) {
+				continue;
+			}
+
 			++legalMovesCount;
 
 			const bool isQuiet = board.isQuiet(m);
@@ -358,6 +586,7 @@ namespace engine {
 				///  LOW DEPTH SEE PRUNING  ///
 
 				if (board.SEE(m) <= -scores::SIMPLIFIED_PIECE_VALUES[Piece::PAWN_WHITE] * depth) {
+					SEARCH_STAT(++nodeStats<NT>(depth).seePrunes);
 					continue; // Skip losing moves at low depth
 				}
 
@@ -369,6 +598,7 @@ namespace engine {
 
 					const Value historySuccessRate = MovePicker::getHistoryValue(board[m.getFrom()], m.getTo());
 					if (historySuccessRate < MAX_SUCCESS_RATE[depth] && !board.givesCheck(m)) {
+						SEARCH_STAT(++nodeStats<NT>(depth).historyPrunes);
 						continue;
 					}
 				}
@@ -416,12 +646,15 @@ namespace engine {
 
 			///  PRINCIPAL VARIATION SEARCH  ///
 
+			SEARCH_STAT(nodeStats<NT>(depth).lmrReductions += reduction > 0);
+
 			Value tmp;
 			if (legalMovesCount == 1) {
 				tmp = -search<NT>(board, -beta, -alpha, depth - 1, ply + 1);
 			} else {
 				tmp = -search<NodeType::NON_PV>(board, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
 				if (tmp > alpha && reduction) { // LMR failed
+					SEARCH_STAT(++nodeStats<NT>(depth).lmrResearches);
 					tmp = -search<NodeType::NON_PV>(board, -alpha - 1, -alpha, depth - 1, ply + 1);
 				} if (NT == NodeType::PV && tmp > alpha && tmp < beta) { // Full window search
 					tmp = -search<NodeType::PV>(board, -beta, -alpha, depth - 1, ply + 1);
@@ -456,6 +689,9 @@ namespace engine {
 			}
 
 			if (alpha >= beta) { // The actual pruning
+				SEARCH_STAT(++nodeStats<NT>(depth).betaCutoffs);
+				SEARCH_STAT(nodeStats<NT>(depth).firstMoveCutoffs += legalMovesCount == 1);
+
 				if (isQuiet && !isInCheck) { // Updating the history
 					MovePicker::addHistorySuccess(board, m, depth);
 					if (ss->firstKiller.getData() != m.getData()) { // Uodating killers
@@ -474,6 +710,13 @@ namespace engine {
 				: 0; // Stalemate
 		}
 
+		if constexpr (NT == NodeType::PV) {
+			if (alpha < tbMinValue || alpha > tbMaxValue) {
+				alpha = std::clamp(alpha, tbMinValue, tbMaxValue);
+				entryType = alpha >= beta ? EntryType::BETA : EntryType::EXACT;
+			}
+		}
+
 		// Saving the results in the transposition table
 		TranspositionTable::tryRecord(
 			EntryType(u8(entryType) | u8(NT)), 
@@ -494,19 +737,24 @@ namespace engine {
 			return alpha;
 		}
 
-		// Checking limits and input
+		// Checking the nodes limit and input (the time limit is watched by Watchdog, which raises g_mustStop)
 		if ((g_nodesCount & 0x1ff) == 0) {
-			if (g_limits.isHardLimitBroken() || g_limits.isNodesLimitBroken(g_nodesCount)) {
+			publishCounters();
+			if (g_limits.isNodesLimitBroken(g_nodesCount) || g_stopHelpers.load(std::memory_order_relaxed)) {
 				g_mustStop = true;
 				return alpha;
 			}
 
-			// Cheching for possible input once in 8192 nodes
-			if ((g_nodesCount & 0x1fff) == 0) {
-				checkInput();
+			// The input thread counts the urgent commands (stop, isready...), so it is just an atomic load
+			// The first iteration is always completed, so that there is a move to return
+			if (g_isInputChecked && g_rootDepth > 1 && io::hasUrgentCommands() && checkInput()) {
+				g_mustStop = true;
+				return alpha;
 			}
 		}
 
+		SEARCH_STAT(++g_searchStats.qnodes[u8(NT)]);
+
 		if constexpr (NT == NodeType::PV) {
 			g_PVs[ply].clear();
 		}
@@ -521,7 +769,12 @@ namespace engine {
 			return alpha;
 		}
 
-		Value staticEval = eval(board);
+		// The exact result of KPK is known from the bitbase
+		if (KPKBitbase::isKPK(board)) {
+			return eval(board);
+		}
+
+		Value staticEval = eval(board, alpha, beta);
 		if (!board.isInCheck()) {
 
 
@@ -622,7 +875,124 @@ namespace engine {
 		MovePicker::init();
 	}
 
-	void stopSearching() {
-		g_mustStop = true;
+	void updateSearchDeadline() {
+		Watchdog::set(g_mustStop, g_limits.hardLimitTime());
+	}
+
+
+	///  SEARCH STATISTICS  ///
+
+	void setSearchStatsOutput(std::string output) {
+		g_searchStatsOutput = std::move(output);
+	}
+
+	void dumpSearchStats() {
+		if (g_searchStatsOutput.empty()) {
+			return;
+		}
+
+		if (g_searchStatsOutput == "console") {
+			printSearchStats();
+		} else if (std::ofstream file(g_searchStatsOutput, std::ios::app); file) {
+			writeSearchStatsJSON(file);
+		}
+	}
+
+	// Returns the share of the part in percents
+	double percentOf(const NodesCount part, const NodesCount total) {
+		return total ? part * 100.0 / total : 0.0;
+	}
+
+	void printSearchStats() {
+		NodesCount nodes = 0;
+		for (const auto& byDepth : g_searchStats.byDepth) {
+			for (const SearchNodeStats& stats : byDepth) {
+				nodes += stats.nodes;
+			}
+		}
+
+		const NodesCount qnodes = g_searchStats.qnodes[0] + g_searchStats.qnodes[1];
+		io::g_out << "Search statistics (root depth " << g_searchStats.rootDepth << "):" << std::endl
+			<< "\tNodes: " << io::Color::Blue << nodes << io::Color::White
+			<< ", quiescence: " << io::Color::Blue << qnodes << io::Color::White 
+			<< " (" << std::fixed << std::setprecision(1) << percentOf(qnodes, nodes + qnodes) << "%)" << std::endl
+			<< "\tAspiration re-searches by the root depth:";
+
+		for (Depth depth = 1; depth <= std::min(g_searchStats.rootDepth, MAX_DEPTH); depth++) {
+			io::g_out << ' ' << g_searchStats.aspirationResearches[depth];
+		}
+
+		io::g_out << std::endl;
+		for (const NodeType nt : { NodeType::PV, NodeType::NON_PV }) {
+			io::g_out << (nt == NodeType::PV ? "PV nodes:" : "Non-PV nodes:") << std::endl << '\t' << std::setw(5) << "depth" << std::setw(11) << "nodes";
+			for (const char* column : { "tt hit", "tt cut", "null try", "null cut", "nullfail", "lmr red", "lmr re", "futility", "see", "history", "cutoffs", "1st cut%" }) {
+				io::g_out << std::setw(9) << column;
+			}
+
+			io::g_out << std::endl;
+
+			for (Depth depth = 0; depth <= MAX_DEPTH; depth++) {
+				const SearchNodeStats& stats = g_searchStats.byDepth[u8(nt)][depth];
+				if (!stats.nodes) {
+					continue;
+				}
+
+				io::g_out << '\t' << std::setw(5) << depth << std::setw(11) << stats.nodes;
+				for (const NodesCount count : { 
+					stats.ttHits, stats.ttCutoffs, stats.nullMoveTries, stats.nullMoveCutoffs, stats.nullMoveVerificationFailures,
+					stats.lmrReductions, stats.lmrResearches, stats.futilityPrunes, stats.seePrunes, stats.historyPrunes, stats.betaCutoffs
+				}) {
+					io::g_out << std::setw(9) << count;
+				}
+
+				io::g_out << std::setw(9) << percentOf(stats.firstMoveCutoffs, stats.betaCutoffs) << std::endl;
+			}
+		}
+
+		io::g_out << std::defaultfloat;
+	}
+
+	void writeSearchStatsJSON(std::ostream& out) {
+		out << "{\"rootDepth\":" << g_searchStats.rootDepth
+			<< ",\"qnodes\":{\"pv\":" << g_searchStats.qnodes[u8(NodeType::PV)] << ",\"nonPv\":" << g_searchStats.qnodes[u8(NodeType::NON_PV)] << '}'
+			<< ",\"aspirationResearches\":[";
+
+		for (Depth depth = 1; depth <= std::min(g_searchStats.rootDepth, MAX_DEPTH); depth++) {
+			out << (depth > 1 ? "," : "") << g_searchStats.aspirationResearches[depth];
+		}
+
+		out << ']';
+		for (const NodeType nt : { NodeType::PV, NodeType::NON_PV }) {
+			out << (nt == NodeType::PV ? ",\"pv\":[" : ",\"nonPv\":[");
+
+			bool isFirst = true;
+			for (Depth depth = 0; depth <= MAX_DEPTH; depth++) {
+				const SearchNodeStats& stats = g_searchStats.byDepth[u8(nt)][depth];
+				if (!stats.nodes) {
+					continue;
+				}
+
+				out << (isFirst ? "" : ",")
+					<< "{\"depth\":" << depth
+					<< ",\"nodes\":" << stats.nodes
+					<< ",\"ttHits\":" << stats.ttHits
+					<< ",\"ttCutoffs\":" << stats.ttCutoffs
+					<< ",\"nullMoveTries\":" << stats.nullMoveTries
+					<< ",\"nullMoveCutoffs\":" << stats.nullMoveCutoffs
+					<< ",\"nullMoveVerificationFailures\":" << stats.nullMoveVerificationFailures
+					<< ",\"lmrReductions\":" << stats.lmrReductions
+					<< ",\"lmrResearches\":" << stats.lmrResearches
+					<< ",\"futilityPrunes\":" << stats.futilityPrunes
+					<< ",\"seePrunes\":" << stats.seePrunes
+					<< ",\"historyPrunes\":" << stats.historyPrunes
+					<< ",\"betaCutoffs\":" << stats.betaCutoffs
+					<< ",\"firstMoveCutoffs\":" << stats.firstMoveCutoffs << '}';
+				isFirst = false;
+			}
+
+			out << ']';
+		}
+
+		out << '}' << std::endl;
 	}
 }
\ No newline at end of file
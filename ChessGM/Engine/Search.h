@@ -17,6 +17,9 @@
 */
 
 #pragma once
+#include <string>
+#include <ostream>
+
 #include "Chess/Board.h"
 #include "Limits.h"
 
@@ -44,8 +47,16 @@
 *		17) History Leaf Pruning
 *		18) Aspiration Window
 *		19) Internal Iterative Deepening
+*		20) Lazy evaluation in quiescence
+*		21) Immediate exact result for KPK positions from the bitbase
+*		22) Syzygy tablebases: WDL probes after zeroing moves, DTZ filtering of the root moves
+* 
+*	The search statistics (used to tune the pruning constants) are only counted if ENABLE_SEARCH_STATS
+*	is defined, in the compiler flags or below. Otherwise the counting is compiled out and costs nothing.
 */
 
+// #define ENABLE_SEARCH_STATS
+
 namespace engine {
 	enum class NodeType : ufast8 {
 		NON_PV = 0,
@@ -62,7 +73,54 @@ namespace engine {
 		Move secondKiller;
 	};
 
-	extern Limits g_limits;
+	// The counters of a single (node type, depth) pair
+	struct SearchNodeStats final {
+		NodesCount nodes;
+		NodesCount ttHits;
+		NodesCount ttCutoffs;
+		NodesCount nullMoveTries;
+		NodesCount nullMoveCutoffs;
+		NodesCount nullMoveVerificationFailures;
+		NodesCount lmrReductions;
+		NodesCount lmrResearches;
+		NodesCount futilityPrunes;
+		NodesCount seePrunes;
+		NodesCount historyPrunes;
+		NodesCount betaCutoffs;
+		NodesCount firstMoveCutoffs; // Beta cutoffs by the first legal move
+	};
+
+	// The statistics of the last search, reset at its beginning
+	struct SearchStats final {
+		SearchNodeStats byDepth[2][MAX_DEPTH + 1]; // By the node type and the remaining depth
+		NodesCount qnodes[2]; // Quiescence nodes by the node type
+		NodesCount aspirationResearches[MAX_DEPTH + 1]; // By the root depth
+		Depth rootDepth;
+	};
+
+#ifdef ENABLE_SEARCH_STATS
+	constexpr bool SEARCH_STATS_ENABLED = true;
+#else
+	constexpr bool SEARCH_STATS_ENABLED = false;
+#endif
+
+	// The search state is thread local, each thread runs its own search
+	extern thread_local SearchStats g_searchStats;
+
+	extern thread_local NodesCount g_nodesCount;
+	extern thread_local NodesCount g_tbHits; // Successful tablebase probes during the current search
+	extern thread_local Limits g_limits;
+
+	// The threads that search in the background (workers) must not poll the input
+	extern thread_local bool g_isInputChecked;
+
+	constexpr u32 MAX_THREADS_COUNT = 256;
+
+	// The number of threads of the searches started by this thread (Lazy SMP), 1 by default
+	extern thread_local u32 g_threadsCount;
+
+	// If set, it is called after each completed iteration of the thread's search with its best move and PV
+	extern thread_local void (*g_onIteration)(const SearchResult& result, Depth depth, const MoveList& pv);
 
 
 	///  SEARCH FUNCTIONS  ///
@@ -87,7 +145,14 @@ namespace engine {
 	// Initialization before a new game
 	void initSearch();
 
-	// When called - stops all searches
-	// Expected to be used when a command was given to stop thinking
-	void stopSearching();
+	// The hard time limit is watched by the Watchdog thread, which raises the stop flag of the search
+	// Must be called if g_limits is changed during the search (e.g. on ponderhit)
+	void updateSearchDeadline();
+
+	// Sets where the search statistics are dumped after each search:
+	// "" - nowhere, "console" - printed as tables, otherwise a file the JSON lines are appended to
+	void setSearchStatsOutput(std::string output);
+
+	void printSearchStats();
+	void writeSearchStatsJSON(std::ostream& out);
 }
\ No newline at end of file
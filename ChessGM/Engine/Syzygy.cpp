@@ -0,0 +1,1173 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Syzygy.h"
+#include <bit>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+#include "Utils/IO.h"
+#include "Utils/MappedFile.h"
+
+namespace engine {
+	u8 Syzygy::s_maxPieces = 0;
+
+	CM_PURE constexpr WDLScore operator-(const WDLScore wdl) noexcept {
+		return WDLScore(-i8(wdl));
+	}
+
+	enum TBType : u8 {
+		TB_WDL = 0,
+		TB_DTZ
+	};
+
+	// Flags of a single table within a file
+	enum TBFlag : u8 {
+		TB_STM = 1,
+		TB_MAPPED = 2,
+		TB_WIN_PLIES = 4,
+		TB_LOSS_PLIES = 8,
+		TB_WIDE = 16,
+		TB_SINGLE_VALUE = 128
+	};
+
+	enum class ProbeState : i8 {
+		FAIL = 0,
+		OK = 1,
+		CHANGE_STM = -1, // The DTZ table stores the other side to move only
+		ZEROING_BEST_MOVE = 2 // The best move is a capture or a pawn move
+	};
+
+
+	///  ENCODING TABLES  ///
+
+	i32 g_mapPawns[Square::VALUES_COUNT];
+	i32 g_mapB1H1H7[Square::VALUES_COUNT];
+	i32 g_mapA1D1D4[Square::VALUES_COUNT];
+	i32 g_mapKK[10][Square::VALUES_COUNT]; // [MapA1D1D4][Square]
+
+	i32 g_binomial[6][Square::VALUES_COUNT]; // [k][n] - the number of ways to choose k elements of n
+	i32 g_leadPawnIdx[6][Square::VALUES_COUNT]; // [lead pawns count][Square]
+	i32 g_leadPawnsSize[6][4]; // [lead pawns count][File A..D]
+
+	// Squares are plain indices here, as the tables encoding works with the raw numbers
+	CM_PURE constexpr i32 rankOf(const i32 sq) noexcept {
+		return sq >> 3;
+	}
+
+	CM_PURE constexpr i32 fileOf(const i32 sq) noexcept {
+		return sq & 7;
+	}
+
+	// Distance to the A1-H8 diagonal, negative below the diagonal
+	CM_PURE constexpr i32 offA1H8(const i32 sq) noexcept {
+		return rankOf(sq) - fileOf(sq);
+	}
+
+	// The leading pawn is the one with the maximal MapPawns value
+	CM_PURE bool pawnsComparator(const u8 a, const u8 b) noexcept {
+		return g_mapPawns[a] < g_mapPawns[b];
+	}
+
+	void initEncodingTables() {
+		// MapB1H1H7 encodes a square below the A1-H8 diagonal to 0..27
+		i32 code = 0;
+		for (i32 sq = 0; sq < 64; sq++) {
+			if (offA1H8(sq) < 0) {
+				g_mapB1H1H7[sq] = code++;
+			}
+		}
+
+		// MapA1D1D4 encodes a square in the A1-D1-D4 triangle to 0..9, the diagonal squares go last
+		std::vector<i32> diagonal;
+		code = 0;
+		for (i32 sq = 0; sq <= Square::D4; sq++) {
+			if (offA1H8(sq) < 0 && fileOf(sq) <= File::D) {
+				g_mapA1D1D4[sq] = code++;
+			} else if (!offA1H8(sq) && fileOf(sq) <= File::D) {
+				diagonal.push_back(sq);
+			}
+		}
+
+		for (const i32 sq : diagonal) {
+			g_mapA1D1D4[sq] = code++;
+		}
+
+		// MapKK encodes all the 462 legal positions of two kings where the first one is in the A1-D1-D4 triangle
+		// If the first king is on the A1-D4 diagonal, the second one is not above the A1-H8 diagonal
+		std::vector<std::pair<i32, i32>> bothOnDiagonal;
+		code = 0;
+		for (i32 idx = 0; idx < 10; idx++) {
+			for (i32 sq1 = 0; sq1 <= Square::D4; sq1++) {
+				if (g_mapA1D1D4[sq1] != idx || (!idx && sq1 != Square::B1)) { // B1 is mapped to 0
+					continue;
+				}
+
+				for (i32 sq2 = 0; sq2 < 64; sq2++) {
+					if (sq1 == sq2 || BitBoard::pseudoAttacks<PieceType::KING>(Square::Value(sq1)).test(Square::Value(sq2))) {
+						continue; // Illegal position
+					} else if (!offA1H8(sq1) && offA1H8(sq2) > 0) {
+						continue; // The first king is on the diagonal, the second one above it
+					} else if (!offA1H8(sq1) && !offA1H8(sq2)) {
+						bothOnDiagonal.emplace_back(idx, sq2);
+					} else {
+						g_mapKK[idx][sq2] = code++;
+					}
+				}
+			}
+		}
+
+		for (const auto& [idx, sq] : bothOnDiagonal) {
+			g_mapKK[idx][sq] = code++;
+		}
+
+		// Binomial coefficients with the Pascal's rule
+		g_binomial[0][0] = 1;
+		for (i32 n = 1; n < 64; n++) {
+			for (i32 k = 0; k < 6 && k <= n; k++) {
+				g_binomial[k][n] = (k > 0 ? g_binomial[k - 1][n - 1] : 0) + (k < n ? g_binomial[k][n - 1] : 0);
+			}
+		}
+
+		// MapPawns encodes the squares A2-H7 to 0..47, the number of squares available to the other pawns
+		// when the leading pawn is on the square. The leading pawn is the one closest to the edge and,
+		// among the pawns on the same file, the one with the lowest rank.
+		i32 availableSquares = 47;
+		for (i32 leadPawnsCount = 1; leadPawnsCount <= 5; leadPawnsCount++) {
+			for (i32 file = File::A; file <= File::D; file++) {
+				// The index restarts for every file since the tables are split by file
+				i32 idx = 0;
+				for (i32 rank = Rank::R2; rank <= Rank::R7; rank++) {
+					const i32 sq = rank * 8 + file;
+					if (leadPawnsCount == 1) {
+						g_mapPawns[sq] = availableSquares--;
+						g_mapPawns[sq ^ 7] = availableSquares--;
+					}
+
+					g_leadPawnIdx[leadPawnsCount][sq] = idx;
+					idx += g_binomial[leadPawnsCount - 1][g_mapPawns[sq]];
+				}
+
+				g_leadPawnsSize[leadPawnsCount][file] = idx;
+			}
+		}
+	}
+
+
+	///  TABLES DATA  ///
+
+	template<typename T, bool IsLittleEndian>
+	CM_PURE T readNumber(const u8* address) noexcept {
+		T value;
+		memcpy(&value, address, sizeof(T));
+
+		if constexpr ((std::endian::native == std::endian::little) != IsLittleEndian) {
+			u8* bytes = reinterpret_cast<u8*>(&value);
+			std::reverse(bytes, bytes + sizeof(T));
+		}
+
+		return value;
+	}
+
+	// Low level information to access a single table within a file: there are 1 or 2 (by side to move)
+	// tables in a file for positions without pawns, and 4 or 8 (by the leading pawn file as well) otherwise
+	struct TBPairsData final {
+		u8 flags = 0;
+		u8 maxSymLen = 0; // Maximal length of the Huffman symbols in bits
+		u8 minSymLen = 0; // Minimal length of the Huffman symbols in bits (or the value for single value tables)
+		u32 blocksCount = 0;
+		size_t blockSize = 0;
+		size_t span = 0; // There is a sparse index entry every <span> values
+		const u8* lowestSym = nullptr; // lowestSym[l] is the symbol of length l with the lowest value
+		const u8* btree = nullptr; // 3 bytes per symbol - the left and right symbols that it expands into
+		const u8* blockLength = nullptr; // Number of the values in a block minus one
+		u32 blockLengthSize = 0;
+		const u8* sparseIndex = nullptr; // 6 bytes per entry - the block number and the offset within the block
+		size_t sparseIndexSize = 0;
+		const u8* data = nullptr; // Huffman compressed data
+		std::vector<u64> base64; // base64[l - minSymLen] is the lowest symbol of length l padded to 64 bits
+		std::vector<u8> symlen; // Number of values represented by a symbol minus one
+		u8 pieces[Syzygy::MAX_PIECES]; // Pieces in the order that defines the groups
+		u64 groupIdx[Syzygy::MAX_PIECES + 1]; // Start index for the encoding of the group
+		i32 groupLen[Syzygy::MAX_PIECES + 1]; // Number of pieces in the group, zero-terminated
+		u16 mapIdx[4]; // For DTZ: win, loss, cursed win, blessed loss offsets in the map
+
+		CM_PURE u16 leftSymbol(const u16 sym) const noexcept {
+			return u16(((btree[3 * sym + 1] & 0xf) << 8) | btree[3 * sym]);
+		}
+
+		CM_PURE u16 rightSymbol(const u16 sym) const noexcept {
+			return u16((btree[3 * sym + 2] << 4) | (btree[3 * sym + 1] >> 4));
+		}
+	};
+
+	// A single tablebase file with the indexing information, it is mapped at the first access
+	template<TBType Type>
+	struct TBTable final {
+		constexpr inline static i32 SIDES = Type == TB_WDL ? 2 : 1;
+
+		std::atomic_bool isReady = false;
+		MappedFile file;
+		const u8* map = nullptr; // DTZ values map
+		std::string name; // Like KRvK
+		u64 key = 0; // Material key with the first side being white
+		u64 key2 = 0; // Material key with the first side being black
+		u8 piecesCount = 0;
+		bool hasPawns = false;
+		bool hasUniquePieces = false;
+		u8 pawnsCount[2] = { 0, 0 }; // [leading color, other color]
+		TBPairsData items[SIDES][4]; // [side to move][File A..D or 0]
+
+		INLINE TBPairsData* get(const i32 stm, const i32 file) noexcept {
+			return &items[stm % SIDES][hasPawns ? file : 0];
+		}
+	};
+
+	struct TBTablesEntry final {
+		TBTable<TB_WDL>* wdl;
+		TBTable<TB_DTZ>* dtz;
+	};
+
+	std::vector<std::string> g_tbPaths;
+	std::deque<TBTable<TB_WDL>> g_wdlTables;
+	std::deque<TBTable<TB_DTZ>> g_dtzTables;
+	std::unordered_map<u64, TBTablesEntry> g_tbTables; // By material key
+
+	// Piece code as it is stored in the files
+	CM_PURE constexpr u8 toTBPiece(const Piece piece) noexcept {
+		return u8(piece.getType()) | (piece.getColor() == Color::BLACK ? 8 : 0);
+	}
+
+	// Fills the information on the table from its name, like KRvK
+	template<TBType Type>
+	bool initTable(TBTable<Type>& table, const std::string& name) {
+		u8 counts[Color::VALUES_COUNT][PieceType::VALUES_COUNT] = { };
+		Color color = Color::WHITE;
+		i32 kingsCount = 0;
+
+		for (const char ch : name) {
+			if (ch == 'v') {
+				if (color == Color::BLACK) {
+					return false;
+				}
+
+				color = Color::BLACK;
+				continue;
+			}
+
+			const char* pos = strchr("PNBRQK", ch);
+			if (!pos || !ch) {
+				return false;
+			}
+
+			const PieceType pt = PieceType::Value(pos - "PNBRQK" + PieceType::PAWN);
+			kingsCount += pt == PieceType::KING;
+			counts[color][pt]++;
+			table.piecesCount++;
+		}
+
+		if (color != Color::BLACK || kingsCount != 2 || counts[Color::WHITE][PieceType::KING] != 1 || table.piecesCount > Syzygy::MAX_PIECES) {
+			return false;
+		}
+
+		table.name = name;
+		for (u8 pt = PieceType::PAWN; pt <= PieceType::KING; pt++) {
+			const u64 white = counts[Color::WHITE][pt];
+			const u64 black = counts[Color::BLACK][pt];
+
+			table.key += white * Board::materialKeyOf(Piece(Color::WHITE, PieceType::Value(pt)))
+				+ black * Board::materialKeyOf(Piece(Color::BLACK, PieceType::Value(pt)));
+			table.key2 += black * Board::materialKeyOf(Piece(Color::WHITE, PieceType::Value(pt)))
+				+ white * Board::materialKeyOf(Piece(Color::BLACK, PieceType::Value(pt)));
+
+			if (pt != PieceType::KING && (white == 1 || black == 1)) {
+				table.hasUniquePieces = true;
+			}
+		}
+
+		const u8 whitePawns = counts[Color::WHITE][PieceType::PAWN];
+		const u8 blackPawns = counts[Color::BLACK][PieceType::PAWN];
+		table.hasPawns = whitePawns + blackPawns > 0;
+
+		// The leading color is the one with less pawns for better compression
+		const bool isWhiteLeading = !blackPawns || (whitePawns && blackPawns >= whitePawns);
+		table.pawnsCount[0] = isWhiteLeading ? whitePawns : blackPawns;
+		table.pawnsCount[1] = isWhiteLeading ? blackPawns : whitePawns;
+
+		return true;
+	}
+
+
+	///  TABLES SETUP  ///
+
+	// Groups the pieces that are encoded together. A group consists of the pieces of the same type and color,
+	// except for the leading group that can be formed by 3 different pieces or by the kings pair if there
+	// are no unique pieces (without pawns), or by the leading pawns.
+	// E.g. KRvKN -> KRK + N, KNNvK -> KK + NN, KPPvKP -> P + PP + K + K
+	template<TBType Type>
+	void setGroups(const TBTable<Type>& table, TBPairsData* d, const i32 order[], const i32 file) {
+		i32 n = 0;
+		i32 firstLen = table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2;
+		d->groupLen[n] = 1;
+
+		for (i32 i = 1; i < table.piecesCount; i++) {
+			if (--firstLen > 0 || d->pieces[i] == d->pieces[i - 1]) {
+				d->groupLen[n]++;
+			} else {
+				d->groupLen[++n] = 1;
+			}
+		}
+
+		d->groupLen[++n] = 0;
+
+		// The encoding of the position is g1 * N(g2) * N(g3) + g2 * N(g3) + g3, where N(g) is the number of
+		// ways to place the group's pieces. The order of the groups is stored in the file: the leading group
+		// is at order[0], the remaining pawns (if any) are at order[1].
+		const bool bothSidesHavePawns = table.hasPawns && table.pawnsCount[1];
+		i32 next = bothSidesHavePawns ? 2 : 1;
+		i32 freeSquares = 64 - d->groupLen[0] - (bothSidesHavePawns ? d->groupLen[1] : 0);
+		u64 idx = 1;
+
+		for (i32 k = 0; next < n || k == order[0] || k == order[1]; k++) {
+			if (k == order[0]) { // Leading pawns or pieces
+				d->groupIdx[0] = idx;
+				idx *= table.hasPawns ? g_leadPawnsSize[d->groupLen[0]][file]
+					: table.hasUniquePieces ? 31332 : 462;
+			} else if (k == order[1]) { // Remaining pawns
+				d->groupIdx[1] = idx;
+				idx *= g_binomial[d->groupLen[1]][48 - d->groupLen[0]];
+			} else { // Remaining pieces
+				d->groupIdx[next] = idx;
+				idx *= g_binomial[d->groupLen[next]][freeSquares];
+				freeSquares -= d->groupLen[next++];
+			}
+		}
+
+		d->groupIdx[n] = idx;
+	}
+
+	// Each symbol of the Recursive Pairing compression is a pair of the child symbols, the number of values
+	// represented by the symbol is computed by expanding it up to the leaves
+	u8 setSymlen(TBPairsData* d, const u16 sym, std::vector<bool>& visited) {
+		visited[sym] = true; // The tree is acyclic
+
+		const u16 right = d->rightSymbol(sym);
+		if (right == 0xfff) {
+			return 0;
+		}
+
+		const u16 left = d->leftSymbol(sym);
+		if (!visited[left]) {
+			d->symlen[left] = setSymlen(d, left, visited);
+		}
+
+		if (!visited[right]) {
+			d->symlen[right] = setSymlen(d, right, visited);
+		}
+
+		return d->symlen[left] + d->symlen[right] + 1;
+	}
+
+	const u8* setSizes(TBPairsData* d, const u8* data) {
+		d->flags = *data++;
+
+		if (d->flags & TB_SINGLE_VALUE) {
+			d->blocksCount = 0;
+			d->span = 0;
+			d->sparseIndexSize = 0;
+			d->minSymLen = *data++; // The single value itself
+			return data;
+		}
+
+		// The last groupIdx is the size of the table
+		const u64 tableSize = d->groupIdx[std::find(d->groupLen, d->groupLen + Syzygy::MAX_PIECES, 0) - d->groupLen];
+
+		d->blockSize = size_t(1) << *data++;
+		d->span = size_t(1) << *data++;
+		d->sparseIndexSize = size_t((tableSize + d->span - 1) / d->span);
+		const u8 padding = *data++;
+		d->blocksCount = readNumber<u32, true>(data);
+		data += sizeof(u32);
+		d->blockLengthSize = d->blocksCount + padding; // Padded so that the sparse index does not point out of range
+		d->maxSymLen = *data++;
+		d->minSymLen = *data++;
+		d->lowestSym = data;
+		d->base64.resize(d->maxSymLen - d->minSymLen + 1);
+
+		// The canonical Huffman code is ordered so that the longer symbols have the lower values,
+		// base64[i] is the lowest symbol of length i padded to 64 bits, so that base64[i] >= base64[i + 1]
+		for (i32 i = i32(d->base64.size()) - 2; i >= 0; i--) {
+			d->base64[i] = (d->base64[i + 1]
+				+ readNumber<u16, true>(d->lowestSym + 2 * i)
+				- readNumber<u16, true>(d->lowestSym + 2 * (i + 1))) / 2;
+		}
+
+		for (size_t i = 0; i < d->base64.size(); i++) {
+			d->base64[i] <<= 64 - i - d->minSymLen;
+		}
+
+		data += d->base64.size() * sizeof(u16);
+		d->symlen.resize(readNumber<u16, true>(data));
+		data += sizeof(u16);
+		d->btree = data;
+
+		std::vector<bool> visited(d->symlen.size());
+		for (size_t sym = 0; sym < d->symlen.size(); sym++) {
+			if (!visited[sym]) {
+				d->symlen[sym] = setSymlen(d, u16(sym), visited);
+			}
+		}
+
+		return data + d->symlen.size() * 3 + (d->symlen.size() & 1);
+	}
+
+	// DTZ values are sorted by frequency and stored as 0, 1, 2... separately for each of the WDL results,
+	// the map restores the original values
+	const u8* setDTZMap(TBTable<TB_DTZ>& table, const u8* data, const i32 maxFile) {
+		table.map = data;
+
+		for (i32 file = File::A; file <= maxFile; file++) {
+			TBPairsData* d = table.get(0, file);
+			if (!(d->flags & TB_MAPPED)) {
+				continue;
+			}
+
+			if (d->flags & TB_WIDE) {
+				data += uintptr_t(data) & 1; // Word alignment
+				for (i32 i = 0; i < 4; i++) {
+					d->mapIdx[i] = u16(((data - table.map) >> 1) + 1);
+					data += 2 * readNumber<u16, true>(data) + 2;
+				}
+			} else {
+				for (i32 i = 0; i < 4; i++) {
+					d->mapIdx[i] = u16(data - table.map + 1);
+					data += *data + 1;
+				}
+			}
+		}
+
+		return data + (uintptr_t(data) & 1);
+	}
+
+	// Fills the pairs data of the table from the just mapped file
+	template<TBType Type>
+	bool setupTable(TBTable<Type>& table, const u8* data) {
+		constexpr u8 SPLIT = 1;
+		constexpr u8 HAS_PAWNS = 2;
+
+		if (bool(*data & HAS_PAWNS) != table.hasPawns || bool(*data & SPLIT) != (table.key != table.key2)) {
+			return false;
+		}
+
+		data++;
+
+		const i32 sides = TBTable<Type>::SIDES == 2 && table.key != table.key2 ? 2 : 1;
+		const i32 maxFile = table.hasPawns ? File::D : File::A;
+		const bool bothSidesHavePawns = table.hasPawns && table.pawnsCount[1];
+
+		for (i32 file = File::A; file <= maxFile; file++) {
+			for (i32 i = 0; i < sides; i++) {
+				*table.get(i, file) = TBPairsData();
+			}
+
+			const i32 order[2][2] = {
+				{ *data & 0xf, bothSidesHavePawns ? *(data + 1) & 0xf : 0xf },
+				{ *data >> 4, bothSidesHavePawns ? *(data + 1) >> 4 : 0xf }
+			};
+			data += 1 + bothSidesHavePawns;
+
+			for (i32 k = 0; k < table.piecesCount; k++, data++) {
+				for (i32 i = 0; i < sides; i++) {
+					table.get(i, file)->pieces[k] = i ? *data >> 4 : *data & 0xf;
+				}
+			}
+
+			for (i32 i = 0; i < sides; i++) {
+				setGroups(table, table.get(i, file), order[i], file);
+			}
+		}
+
+		data += uintptr_t(data) & 1; // Word alignment
+
+		for (i32 file = File::A; file <= maxFile; file++) {
+			for (i32 i = 0; i < sides; i++) {
+				data = setSizes(table.get(i, file), data);
+			}
+		}
+
+		if constexpr (Type == TB_DTZ) {
+			data = setDTZMap(table, data, maxFile);
+		}
+
+		for (i32 file = File::A; file <= maxFile; file++) {
+			for (i32 i = 0; i < sides; i++) {
+				TBPairsData* d = table.get(i, file);
+				d->sparseIndex = data;
+				data += d->sparseIndexSize * 6;
+			}
+		}
+
+		for (i32 file = File::A; file <= maxFile; file++) {
+			for (i32 i = 0; i < sides; i++) {
+				TBPairsData* d = table.get(i, file);
+				d->blockLength = data;
+				data += d->blockLengthSize * sizeof(u16);
+			}
+		}
+
+		for (i32 file = File::A; file <= maxFile; file++) {
+			for (i32 i = 0; i < sides; i++) {
+				data = table.file.data() + ((data - table.file.data() + 0x3f) & ~0x3f); // 64 byte alignment
+				TBPairsData* d = table.get(i, file);
+				d->data = data;
+				data += d->blocksCount * d->blockSize;
+			}
+		}
+
+		return data <= table.file.data() + table.file.size();
+	}
+
+	// Maps the file at the first access, returns whether the table is available
+	// It is thread safe, so that it can be called concurrently from the search
+	template<TBType Type>
+	bool mapTable(TBTable<Type>& table) {
+		static std::mutex s_mutex;
+
+		if (table.isReady.load(std::memory_order_acquire)) {
+			return table.file.isOpen();
+		}
+
+		std::lock_guard<std::mutex> lock(s_mutex);
+		if (table.isReady.load(std::memory_order_relaxed)) {
+			return table.file.isOpen();
+		}
+
+		constexpr u8 MAGICS[2][4] = { { 0x71, 0xe8, 0x23, 0x5d }, { 0xd7, 0x66, 0x0c, 0xa5 } };
+		const std::string fileName = table.name + (Type == TB_WDL ? ".rtbw" : ".rtbz");
+
+		for (const std::string& path : g_tbPaths) {
+			if (table.file.open((std::filesystem::path(path) / fileName).string())) {
+				break;
+			}
+		}
+
+		if (table.file.isOpen()) {
+			if (table.file.size() % 64 != 16 || memcmp(table.file.data(), MAGICS[Type], 4) || !setupTable(table, table.file.data() + 4)) {
+				io::g_out << "Corrupted tablebase file " << fileName << std::endl;
+				table.file.close();
+			}
+		}
+
+		table.isReady.store(true, std::memory_order_release);
+		return table.file.isOpen();
+	}
+
+
+	///  TABLES PROBING  ///
+
+	// The tables are compressed with the canonical Huffman code. The data is split into blocks of
+	// the same size, each block stores a variable number of symbols. Each symbol is either a value,
+	// or a pair of other symbols (recursively), so a block represents up to 65536 values.
+	i32 decompressPairs(const TBPairsData* d, const u64 idx) {
+		if (d->flags & TB_SINGLE_VALUE) {
+			return d->minSymLen;
+		}
+
+		// The sparse index entry k points to the block and the offset within it of the value
+		// with index k * span + span / 2, so the right block is found from the nearest entry
+		const u32 k = u32(idx / d->span);
+		u32 block = readNumber<u32, true>(d->sparseIndex + 6 * k);
+		i32 offset = readNumber<u16, true>(d->sparseIndex + 6 * k + 4);
+		offset += i32(idx % d->span) - i32(d->span / 2);
+
+		while (offset < 0) {
+			offset += readNumber<u16, true>(d->blockLength + 2 * --block) + 1;
+		}
+
+		while (offset > readNumber<u16, true>(d->blockLength + 2 * block)) {
+			offset -= readNumber<u16, true>(d->blockLength + 2 * block++) + 1;
+		}
+
+		// Reading the symbols of the block until the one containing the offset
+		const u8* ptr = d->data + u64(block) * d->blockSize;
+		u64 buf64 = readNumber<u64, false>(ptr);
+		ptr += sizeof(u64);
+		i32 buf64Size = 64;
+		u16 sym;
+
+		while (true) {
+			// The length of the symbol (minus minSymLen) is found from base64, since all
+			// the symbols of a given length are consecutive
+			i32 len = 0;
+			while (buf64 < d->base64[len]) {
+				++len;
+			}
+
+			sym = u16((buf64 - d->base64[len]) >> (64 - len - d->minSymLen));
+			sym += readNumber<u16, true>(d->lowestSym + 2 * len);
+
+			if (offset < d->symlen[sym] + 1) {
+				break;
+			}
+
+			offset -= d->symlen[sym] + 1;
+			len += d->minSymLen;
+			buf64 <<= len;
+			buf64Size -= len;
+
+			if (buf64Size <= 32) { // Refilling the buffer
+				buf64Size += 32;
+				buf64 |= u64(readNumber<u32, false>(ptr)) << (64 - buf64Size);
+				ptr += sizeof(u32);
+			}
+		}
+
+		// Expanding the symbol into the left and right child symbols until the leaf
+		while (d->symlen[sym]) {
+			const u16 left = d->leftSymbol(sym);
+
+			if (offset < d->symlen[left] + 1) {
+				sym = left;
+			} else {
+				offset -= d->symlen[left] + 1;
+				sym = d->rightSymbol(sym);
+			}
+		}
+
+		return d->leftSymbol(sym);
+	}
+
+	CM_PURE constexpr i32 signOf(const i32 value) noexcept {
+		return (0 < value) - (value < 0);
+	}
+
+	// DTZ tables do not store the scores for the positions where the best move is zeroing,
+	// the DTZ before the zeroing move is restored from the WDL result
+	CM_PURE constexpr i32 dtzBeforeZeroing(const WDLScore wdl) noexcept {
+		switch (wdl) {
+			case WDLScore::WIN: return 1;
+			case WDLScore::CURSED_WIN: return 101;
+			case WDLScore::BLESSED_LOSS: return -101;
+			case WDLScore::LOSS: return -1;
+		default: return 0;
+		}
+	}
+
+	// Converts the stored value into the WDL score or DTZ in plies
+	template<TBType Type>
+	i32 mapScore(TBTable<Type>& table, const i32 file, i32 value, const WDLScore wdl) {
+		if constexpr (Type == TB_WDL) {
+			return value - 2;
+		} else {
+			constexpr i32 WDL_MAP[] = { 1, 3, 0, 2, 0 };
+
+			const TBPairsData* d = table.get(0, file);
+			if (d->flags & TB_MAPPED) {
+				const u16 idx = d->mapIdx[WDL_MAP[i8(wdl) + 2]];
+				value = (d->flags & TB_WIDE)
+					? readNumber<u16, true>(table.map + 2 * (idx + value))
+					: table.map[idx + value];
+			}
+
+			// DTZ is stored either in moves or in plies
+			if ((wdl == WDLScore::WIN && !(d->flags & TB_WIN_PLIES))
+				|| (wdl == WDLScore::LOSS && !(d->flags & TB_LOSS_PLIES))
+				|| wdl == WDLScore::CURSED_WIN
+				|| wdl == WDLScore::BLESSED_LOSS) {
+				value *= 2;
+			}
+
+			return value + 1;
+		}
+	}
+
+	// Computes the index of the position in the table and looks up the value.
+	// k pieces of the same type and color on the squares s1 < s2 < ... < sk are encoded as
+	// Binomial[1][s1] + Binomial[2][s2] + ... + Binomial[k][sk].
+	template<TBType Type>
+	i32 probeTable(const Board& board, TBTable<Type>& table, const WDLScore wdl, ProbeState& state) {
+		u8 squares[Syzygy::MAX_PIECES] = {};
+		u8 pieces[Syzygy::MAX_PIECES];
+		u64 idx;
+		i32 size = 0;
+		i32 leadPawnsCount = 0;
+		BitBoard leadPawns = BitBoard::EMPTY;
+		i32 tbFile = File::A;
+
+		// The tables are stored for the stronger side being white, and only for white to move if both sides
+		// have the same pieces. Otherwise the colors are swapped and the squares are flipped.
+		const bool isSymmetricBlackToMove = table.key == table.key2 && board.side() == Color::BLACK;
+		const bool isBlackStronger = board.materialKey() != table.key;
+		const bool isFlipped = isSymmetricBlackToMove || isBlackStronger;
+		const u8 flipColor = isFlipped * 8;
+		const u8 flipSquares = isFlipped * 56;
+		const i32 stm = isFlipped ^ (board.side() == Color::BLACK);
+
+		// Tables with pawns are split by the file of the leading pawn, the one with the maximal MapPawns value
+		if (table.hasPawns) {
+			const u8 pawn = table.get(0, 0)->pieces[0] ^ flipColor;
+			BitBoard pawns = leadPawns = board.pawns(pawn & 8 ? Color::BLACK : Color::WHITE);
+			BB_FOR_EACH(sq, pawns) {
+				squares[size++] = sq ^ flipSquares;
+			}
+
+			leadPawnsCount = size;
+			std::swap(squares[0], *std::max_element(squares, squares + leadPawnsCount, pawnsComparator));
+			tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+		}
+
+		// DTZ tables are one-sided
+		if constexpr (Type == TB_DTZ) {
+			if ((table.get(stm, tbFile)->flags & TB_STM) != stm && (table.key != table.key2 || table.hasPawns)) {
+				state = ProbeState::CHANGE_STM;
+				return 0;
+			}
+		}
+
+		BitBoard others = board.allPieces().b_xor(leadPawns);
+		BB_FOR_EACH(sq, others) {
+			squares[size] = sq ^ flipSquares;
+			pieces[size++] = toTBPiece(board[sq]) ^ flipColor;
+		}
+
+		const TBPairsData* d = table.get(stm, tbFile);
+
+		// Reordering the pieces as in the table
+		for (i32 i = leadPawnsCount; i < size - 1; i++) {
+			for (i32 j = i + 1; j < size; j++) {
+				if (d->pieces[i] == pieces[j]) {
+					std::swap(pieces[i], pieces[j]);
+					std::swap(squares[i], squares[j]);
+					break;
+				}
+			}
+		}
+
+		// The leading piece is moved to the A1-D1-D4 triangle
+		if (fileOf(squares[0]) > File::D) {
+			for (i32 i = 0; i < size; i++) {
+				squares[i] ^= 7;
+			}
+		}
+
+		if (table.hasPawns) {
+			idx = g_leadPawnIdx[leadPawnsCount][squares[0]];
+
+			std::stable_sort(squares + 1, squares + leadPawnsCount, pawnsComparator);
+			for (i32 i = 1; i < leadPawnsCount; i++) {
+				idx += g_binomial[i][g_mapPawns[squares[i]]];
+			}
+		} else {
+			if (rankOf(squares[0]) > Rank::R4) {
+				for (i32 i = 0; i < size; i++) {
+					squares[i] ^= 56;
+				}
+			}
+
+			// The first piece of the leading group that is not on the A1-H8 diagonal is mapped below it
+			for (i32 i = 0; i < d->groupLen[0]; i++) {
+				if (!offA1H8(squares[i])) {
+					continue;
+				}
+
+				if (offA1H8(squares[i]) > 0) {
+					for (i32 j = i; j < size; j++) {
+						squares[j] = u8(((squares[j] >> 3) | (squares[j] << 3)) & 63);
+					}
+				}
+
+				break;
+			}
+
+			if (table.hasUniquePieces) {
+				// With 3 unique pieces they are encoded together, the squares occupied by
+				// the previous pieces are skipped
+				const i32 adjust1 = squares[1] > squares[0];
+				const i32 adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+				if (offA1H8(squares[0])) { // The first piece is below the diagonal
+					idx = (g_mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+				} else if (offA1H8(squares[1])) { // The first piece is on the diagonal, the second one below
+					idx = (6 * 63 + rankOf(squares[0]) * 28 + g_mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+				} else if (offA1H8(squares[2])) { // The first two pieces are on the diagonal, the third one below
+					idx = 6 * 63 * 62 + 4 * 28 * 62
+						+ rankOf(squares[0]) * 7 * 28
+						+ (rankOf(squares[1]) - adjust1) * 28
+						+ g_mapB1H1H7[squares[2]];
+				} else { // All the 3 pieces are on the diagonal
+					idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28
+						+ rankOf(squares[0]) * 7 * 6
+						+ (rankOf(squares[1]) - adjust1) * 6
+						+ (rankOf(squares[2]) - adjust2);
+				}
+			} else { // Just the kings
+				idx = g_mapKK[g_mapA1D1D4[squares[0]]][squares[1]];
+			}
+		}
+
+		// Encoding the remaining pawns and pieces
+		idx *= d->groupIdx[0];
+		u8* groupSq = squares + d->groupLen[0];
+		bool hasRemainingPawns = table.hasPawns && table.pawnsCount[1];
+
+		for (i32 next = 1; d->groupLen[next]; next++) {
+			std::stable_sort(groupSq, groupSq + d->groupLen[next]);
+
+			u64 n = 0;
+			for (i32 i = 0; i < d->groupLen[next]; i++) {
+				// The squares of the previous groups are skipped
+				const i32 adjust = i32(std::count_if(squares, groupSq, [&](const u8 sq) { return groupSq[i] > sq; }));
+				n += g_binomial[i + 1][groupSq[i] - adjust - 8 * hasRemainingPawns];
+			}
+
+			hasRemainingPawns = false;
+			idx += n * d->groupIdx[next];
+			groupSq += d->groupLen[next];
+		}
+
+		return mapScore(table, tbFile, decompressPairs(d, idx), wdl);
+	}
+
+	template<TBType Type>
+	i32 probeTable(const Board& board, ProbeState& state, const WDLScore wdl = WDLScore::DRAW) {
+		if (board.allPieces().popcnt() == 2) { // KvK
+			return 0;
+		}
+
+		const auto it = g_tbTables.find(board.materialKey());
+		if (it == g_tbTables.end()) {
+			state = ProbeState::FAIL;
+			return 0;
+		}
+
+		TBTable<Type>* table;
+		if constexpr (Type == TB_WDL) {
+			table = it->second.wdl;
+		} else {
+			table = it->second.dtz;
+		}
+
+		if (!mapTable(*table)) {
+			state = ProbeState::FAIL;
+			return 0;
+		}
+
+		return probeTable(board, *table, wdl, state);
+	}
+
+
+	///  SEARCH OVER THE TABLES  ///
+
+	CM_PURE bool isZeroingMove(const Board& board, const Move m) noexcept {
+		return board[m.getTo()] != Piece::NONE
+			|| m.getMoveType() == MoveType::ENPASSANT
+			|| board[m.getFrom()].getType() == PieceType::PAWN;
+	}
+
+	CM_PURE bool hasLegalMoves(const Board& board) noexcept {
+		MoveList moves;
+		board.generateMoves(moves);
+
+		return std::any_of(moves.begin(), moves.end(), [&](const Move m) { return board.isLegal(m); });
+	}
+
+	// The generator stores "don't care" values for the positions where the side to move has a winning
+	// capture (and the position may be stored as a loss if there is a drawing capture), so the captures
+	// must be probed as well and the best result is the correct one.
+	// DTZ tables do not store the values if the best move is zeroing, so for DTZ the pawn moves are checked too.
+	template<bool CheckZeroingMoves>
+	WDLScore searchWDL(Board& board, ProbeState& state) {
+		WDLScore value;
+		WDLScore bestValue = WDLScore::LOSS;
+
+		MoveList moves;
+		board.generateMoves(moves);
+
+		u32 legalMovesCount = 0;
+		u32 movesCount = 0;
+		for (Move m : moves) {
+			if (!board.isLegal(m)) {
+				continue;
+			}
+
+			++legalMovesCount;
+			const bool isCapture = board[m.getTo()] != Piece::NONE || m.getMoveType() == MoveType::ENPASSANT;
+			if (!isCapture && (!CheckZeroingMoves || board[m.getFrom()].getType() != PieceType::PAWN)) {
+				continue;
+			}
+
+			++movesCount;
+			board.makeMove(m);
+			value = -searchWDL<false>(board, state);
+			board.unmakeMove(m);
+
+			if (state == ProbeState::FAIL) {
+				return WDLScore::DRAW;
+			}
+
+			if (value > bestValue) {
+				bestValue = value;
+
+				if (value >= WDLScore::WIN) {
+					state = ProbeState::ZEROING_BEST_MOVE;
+					return value;
+				}
+			}
+		}
+
+		// If all the legal moves were searched the stored value may be wrong (e.g. the tables
+		// do not contain the positions with en passant), so the table is not probed
+		const bool noMoreMoves = movesCount && movesCount == legalMovesCount;
+		if (noMoreMoves) {
+			value = bestValue;
+		} else {
+			value = WDLScore(probeTable<TB_WDL>(board, state));
+			if (state == ProbeState::FAIL) {
+				return WDLScore::DRAW;
+			}
+		}
+
+		if (bestValue >= value) {
+			state = bestValue > WDLScore::DRAW || noMoreMoves ? ProbeState::ZEROING_BEST_MOVE : ProbeState::OK;
+			return bestValue;
+		}
+
+		state = ProbeState::OK;
+		return value;
+	}
+
+	i32 searchDTZ(Board& board, ProbeState& state) {
+		state = ProbeState::OK;
+		const WDLScore wdl = searchWDL<true>(board, state);
+
+		if (state == ProbeState::FAIL || wdl == WDLScore::DRAW) { // DTZ tables do not store draws
+			return 0;
+		}
+
+		if (state == ProbeState::ZEROING_BEST_MOVE) {
+			return dtzBeforeZeroing(wdl);
+		}
+
+		i32 dtz = probeTable<TB_DTZ>(board, state, wdl);
+		if (state == ProbeState::FAIL) {
+			return 0;
+		}
+
+		if (state != ProbeState::CHANGE_STM) {
+			return (dtz + 100 * (wdl == WDLScore::BLESSED_LOSS || wdl == WDLScore::CURSED_WIN)) * signOf(i8(wdl));
+		}
+
+		// The table stores the other side to move, so the 1-ply search finds the winning move with the minimal DTZ
+		i32 minDTZ = 0xffff;
+
+		MoveList moves;
+		board.generateMoves(moves);
+		for (Move m : moves) {
+			if (!board.isLegal(m)) {
+				continue;
+			}
+
+			const bool isZeroing = isZeroingMove(board, m);
+			board.makeMove(m);
+
+			// For the zeroing moves the DTZ before the move is used, otherwise the DTZ of the next sequence is found
+			dtz = isZeroing ? -dtzBeforeZeroing(searchWDL<false>(board, state)) : -searchDTZ(board, state);
+
+			// A mating move
+			if (dtz == 1 && board.isInCheck() && !hasLegalMoves(board)) {
+				minDTZ = 1;
+			}
+
+			if (!isZeroing) {
+				dtz += signOf(dtz);
+			}
+
+			if (dtz < minDTZ && signOf(dtz) == signOf(i8(wdl))) {
+				minDTZ = dtz;
+			}
+
+			board.unmakeMove(m);
+			if (state == ProbeState::FAIL) {
+				return 0;
+			}
+		}
+
+		// No legal moves means the position is a mate
+		return minDTZ == 0xffff ? -1 : minDTZ;
+	}
+
+
+	///  SYZYGY CLASS  ///
+
+	void Syzygy::init(const std::string& paths) {
+		static bool s_areTablesInitialized = false;
+		if (!s_areTablesInitialized) {
+			initEncodingTables();
+			s_areTablesInitialized = true;
+		}
+
+		g_tbTables.clear();
+		g_wdlTables.clear();
+		g_dtzTables.clear();
+		g_tbPaths.clear();
+		s_maxPieces = 0;
+
+#ifdef _WIN32
+		constexpr char PATHS_SEPARATOR = ';';
+#else
+		constexpr char PATHS_SEPARATOR = ':';
+#endif // _WIN32
+
+		std::stringstream ss(paths);
+		std::string path;
+		while (std::getline(ss, path, PATHS_SEPARATOR)) {
+			if (!path.empty() && path != "<empty>") {
+				g_tbPaths.push_back(path);
+			}
+		}
+
+		// Only the WDL files are looked for, the DTZ files are checked at the first access
+		std::error_code error;
+		for (const std::string& dir : g_tbPaths) {
+			for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+				if (entry.path().extension() != ".rtbw") {
+					continue;
+				}
+
+				const std::string name = entry.path().stem().string();
+				TBTable<TB_WDL>& wdl = g_wdlTables.emplace_back();
+				if (!initTable(wdl, name) || g_tbTables.contains(wdl.key)) {
+					g_wdlTables.pop_back();
+					continue;
+				}
+
+				TBTable<TB_DTZ>& dtz = g_dtzTables.emplace_back();
+				initTable(dtz, name);
+
+				// Both KRvK with the white rook and KvKR with the black rook
+				g_tbTables[wdl.key] = g_tbTables[wdl.key2] = TBTablesEntry { .wdl = &wdl, .dtz = &dtz };
+				s_maxPieces = std::max(s_maxPieces, wdl.piecesCount);
+			}
+		}
+	}
+
+	size_t Syzygy::tablesCount() noexcept {
+		return g_wdlTables.size();
+	}
+
+	bool Syzygy::probeWDL(Board& board, WDLScore& result) {
+		ProbeState state = ProbeState::OK;
+		result = searchWDL<false>(board, state);
+
+		return state != ProbeState::FAIL;
+	}
+
+	bool Syzygy::probeDTZ(Board& board, i32& result) {
+		ProbeState state;
+		result = searchDTZ(board, state);
+
+		return state != ProbeState::FAIL;
+	}
+
+	bool Syzygy::filterRootMoves(Board& board, MoveList& moves) {
+		constexpr i32 WDL_TO_DTZ[] = { -1, -101, 0, 101, 1 };
+
+		ProbeState state;
+		const i32 dtz = searchDTZ(board, state);
+		if (state == ProbeState::FAIL) {
+			return false;
+		}
+
+		// DTZ of every root move counting from the root position
+		i32 scores[MoveList::MAX_MOVES];
+		for (u32 i = 0; i < moves.size(); i++) {
+			const Move m = moves[i];
+			board.makeMove(m);
+
+			i32 value = 0;
+			if (board.isInCheck() && dtz > 0 && !hasLegalMoves(board)) { // Mate
+				value = 1;
+			} else if (board.fiftyRule() != 0) {
+				value = -searchDTZ(board, state);
+				value += signOf(value);
+			} else {
+				state = ProbeState::OK;
+				value = WDL_TO_DTZ[i8(-searchWDL<false>(board, state)) + 2];
+			}
+
+			board.unmakeMove(m);
+			if (state == ProbeState::FAIL) {
+				return false;
+			}
+
+			scores[i] = value;
+		}
+
+		// When winning, any move that wins within the 50-move rule is kept, otherwise the fastest one.
+		// When losing, all the moves are kept unless the 50-move draw is close, then the slowest losses.
+		const i32 fiftyRule = board.fiftyRule();
+		i32 minScore = 0;
+		i32 maxScore = 0;
+
+		if (dtz > 0) {
+			i32 best = 0xffff;
+			for (u32 i = 0; i < moves.size(); i++) {
+				if (scores[i] > 0 && scores[i] < best) {
+					best = scores[i];
+				}
+			}
+
+			minScore = 1;
+			maxScore = best + fiftyRule <= 99 ? 99 - fiftyRule : best;
+		} else if (dtz < 0) {
+			i32 best = 0;
+			for (u32 i = 0; i < moves.size(); i++) {
+				best = std::min(best, scores[i]);
+			}
+
+			if (-best * 2 + fiftyRule < 100) {
+				return true;
+			}
+
+			minScore = maxScore = best;
+		}
+
+		Move kept[MoveList::MAX_MOVES];
+		u32 keptCount = 0;
+		for (u32 i = 0; i < moves.size(); i++) {
+			if (scores[i] >= minScore && scores[i] <= maxScore) {
+				kept[keptCount++] = moves[i];
+			}
+		}
+
+		moves.clear();
+		for (u32 i = 0; i < keptCount; i++) {
+			moves.push(kept[i]);
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,82 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+
+#include "Chess/Board.h"
+
+/*
+*	Syzygy(.h/.cpp) contains the probing of Syzygy endgame tablebases.
+* 
+*	The WDL (.rtbw) and DTZ (.rtbz) files are looked for in the directories from SyzygyPath
+*	(separated with ';' on Windows and ':' otherwise) and are memory mapped at the first access.
+*	WDL tables are probed in the search right after captures and pawn moves, DTZ tables are
+*	used to filter the root moves.
+* 
+*	The decoding of the tables follows the original probing code by Ronald de Man
+*	and its adaptation in Stockfish.
+*/
+
+namespace engine {
+	// Win/draw/loss from the side to move POV, cursed win/blessed loss are the results
+	// that are a draw by the 50-move rule
+	enum class WDLScore : i8 {
+		LOSS = -2,
+		BLESSED_LOSS = -1,
+		DRAW = 0,
+		CURSED_WIN = 1,
+		WIN = 2
+	};
+
+	class Syzygy final {
+	public:
+		constexpr inline static u8 MAX_PIECES = 7;
+
+	private:
+		static u8 s_maxPieces; // The maximal number of pieces among the found tables
+
+	public:
+		// (Re)loads the tables from the given paths, an empty path disables the tablebases
+		static void init(const std::string& paths);
+
+		// Number of the tables found with init
+		static size_t tablesCount() noexcept;
+
+		CM_PURE static u8 maxPieces() noexcept {
+			return s_maxPieces;
+		}
+
+		// Whether the position can be probed (the number of pieces is within the tables and no castling rights)
+		CM_PURE static bool canProbe(const Board& board) noexcept {
+			return board.allPieces().popcnt() <= s_maxPieces && !board.castleRight();
+		}
+
+		// Probes the WDL tables, returns false if the position is not in the tables
+		static bool probeWDL(Board& board, WDLScore& result);
+
+		// Probes the DTZ tables, returns false if the position is not in the tables
+		// DTZ is the number of plies to the next zeroing move, positive if the side to move wins
+		static bool probeDTZ(Board& board, i32& result);
+
+		// Leaves only the moves that preserve the best DTZ result in the list of legal root moves
+		// Returns false if the position is not in the tables, the list is left unchanged then
+		static bool filterRootMoves(Board& board, MoveList& moves);
+	};
+}
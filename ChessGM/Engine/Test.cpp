@@ -19,12 +19,36 @@
 #include "Test.h"
 
 #include <chrono>
+#include <thread>
 #include <tuple>
+#include <random>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
 
 #include "Utils/IO.h"
+#include "Utils/SpscQueue.h"
 #include "Chess/BitBoard.h"
 #include "Engine/Scores.h"
 #include "Engine/Search.h"
+#include "Engine/Eval.h"
+#include "Engine/Options.h"
+#include "Engine/PawnHashTable.h"
+#include "Engine/KPKBitbase.h"
+#include "Engine/BitbaseGenerator.h"
+#include "Engine/Book.h"
+#include "Engine/BookBuilder.h"
+#include "Engine/PositionIndex.h"
+#include "Engine/PgnReader.h"
+#include "Engine/Tuning.h"
+#include "Engine/Bench.h"
+#include "Engine/EpdTest.h"
+#include "Engine/BatchAnalysis.h"
+#include "Engine/GameReview.h"
+#include "Engine/TranspositionTable.h"
+#include "Engine/Watchdog.h"
+#include "Engine/Syzygy.h"
 
 
 ///  UTILS FOR TESTS  ///
@@ -262,6 +286,1296 @@ template<> bool test<8>() {
 }
 
 
+///  EVALUATION TESTS  ///
+
+template<> bool test<9>() {
+	constexpr auto testName = "EvalTest(lazyEvalTest)";
+
+	const bool wasLazyEval = options::g_lazyEval;
+	for (const auto& fen : TEST_FENS) {
+		bool success;
+		Board board = Board::fromFEN(fen, success);
+
+		options::g_lazyEval = false;
+		const Value fullEval = engine::eval(board);
+
+		// With the infinite window the evaluation must be exact
+		options::g_lazyEval = true;
+		EXPECT_EQ(engine::eval(board), fullEval);
+
+		// Otherwise, the evaluation must stay on the same side of the window
+		EXPECT_TRUE(engine::eval(board, fullEval + 2000, fullEval + 2001) <= fullEval + 2000);
+		EXPECT_TRUE(engine::eval(board, fullEval - 2001, fullEval - 2000) >= fullEval - 2000);
+	}
+
+	options::g_lazyEval = wasLazyEval;
+	return true;
+}
+
+
+template<> bool test<10>() {
+	constexpr auto testName = "EvalTest(packedScoreTest)";
+
+	const Value VALUES[] = { 0, 1, -1, 7, -7, 100, -100, 255, -256, 1000, -1000, 4096, -4096 };
+	for (Value mg1 : VALUES) {
+		for (Value eg1 : VALUES) {
+			const Score a = Score(mg1, eg1);
+			EXPECT_EQ(a.middlegame(), mg1);
+			EXPECT_EQ(a.endgame(), eg1);
+
+			for (Value mg2 : VALUES) {
+				for (Value eg2 : VALUES) {
+					const Score b = Score(mg2, eg2);
+
+					EXPECT_TRUE(a + b == Score(mg1 + mg2, eg1 + eg2));
+					EXPECT_TRUE(a - b == Score(mg1 - mg2, eg1 - eg2));
+					EXPECT_TRUE(-b == Score(-mg2, -eg2));
+
+					Score c = a;
+					c += b;
+					EXPECT_EQ(c.middlegame(), Value(mg1 + mg2));
+					EXPECT_EQ(c.endgame(), Value(eg1 + eg2));
+
+					c -= b * 3;
+					EXPECT_EQ(c.middlegame(), Value(mg1 - mg2 * 2));
+					EXPECT_EQ(c.endgame(), Value(eg1 - eg2 * 2));
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+// Evaluations of the positions computed with the previous (not packed) scores
+const std::pair<std::string, Value> EVAL_TESTS[] = {
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 15 },
+	{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 108 },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", -28 },
+	{ "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 165 },
+	{ "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 200 },
+	{ "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 142 },
+	{ "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 15 },
+	{ "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4", -29 },
+	{ "rnbqkb1r/pp3ppp/4pn2/2pp4/2PP4/2N1PN2/PP3PPP/R1BQKB1R b KQkq - 0 5", -47 },
+	{ "2rq1rk1/pb1nbppp/1p2pn2/2pp4/2PP4/1PN1PN2/PB2BPPP/2RQ1RK1 w - - 2 11", 53 },
+	{ "r1b2rk1/2q1bppp/p2ppn2/1p6/3BPP2/2N2B2/PPPQ2PP/R4R1K w - - 0 15", 77 },
+	{ "4r1k1/pp3ppp/2p5/3p4/3P4/2P1R3/PP3PPP/6K1 w - - 0 25", 6 },
+	{ "8/5pk1/6p1/7p/7P/6P1/5PK1/8 w - - 0 40", 3 },
+	{ "8/8/4k3/8/2P5/8/4K3/8 w - - 0 50", 0 }, // A draw by the KPK bitbase
+	{ "8/8/8/4k3/8/8/2BNK3/8 w - - 0 60", 19977 }, // KBNK used to be evaluated as a draw
+	{ "8/8/8/4k3/8/8/3QK3/8 b - - 0 60", -20010 },
+	{ "8/8/3bk3/8/8/8/3NK3/8 w - - 0 60", 0 },
+	{ "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 30", 707 },
+	{ "r4rk1/pp2ppbp/2n3p1/q1pp4/3P1B2/2P1PN2/PP1Q1PPP/R3KB1R w KQ - 0 11", 328 },
+	{ "3r2k1/1p3ppp/p1n1b3/4p3/4P3/1NN1B3/PPP3PP/5RK1 b - - 3 20", -316 },
+	{ "8/p7/1p6/2p5/2P2k2/1P6/P4K2/8 b - - 0 45", 35 },
+	{ "2kr3r/ppp2ppp/2n5/2b1p3/4P1q1/2NP1N2/PPP2PPP/R1BQ1RK1 w - - 0 10", 384 },
+
+	// Specialized endgames
+	{ "8/8/8/4k3/8/8/2BBK3/8 w - - 0 60", 20010 },
+	{ "8/8/8/4k3/8/8/3BKB2/8 w - - 0 60", 0 },
+	{ "8/8/5b2/4k3/8/8/3BKB2/8 w - - 0 60", 0 },
+	{ "8/8/5n2/4k3/8/8/3BKN2/8 w - - 0 60", 0 },
+	{ "7k/8/8/8/8/7P/8/K7 w - - 0 1", 0 },
+};
+
+template<> bool test<11>() {
+	constexpr auto testName = "EvalTest(evalRegressionTest)";
+
+	for (const auto& [fen, expectedValue] : EVAL_TESTS) {
+		bool success;
+		Board board = Board::fromFEN(fen, success);
+
+		EXPECT_TRUE(success);
+		EXPECT_EQ(engine::eval(board), expectedValue);
+	}
+
+	return true;
+}
+
+
+///  PAWN HASH TABLE TESTS  ///
+
+// Per-pawn pawn structure scan, the reference for PawnHashTable::scanPawnStructure
+template<Color::Value Side>
+void scanPawnsReference(engine::PawnHashEntry& entry) {
+	constexpr Color::Value OppositeSide = Color(Side).getOpposite().value();
+	constexpr Direction::Value Up = Direction::makeRelativeDirection(Side, Direction::UP).value();
+
+	const BitBoard pawns = entry.pawns[Side];
+	const BitBoard enemyPawns = entry.pawns[OppositeSide];
+	const BitBoard ourPawnAttacks = pawns.pawnAttackedSquares<Side>();
+
+	for (u8 i = 0; i < 10; i++) {
+		entry.mostAdvanced[Color::WHITE][i] = Rank::R1;
+		entry.mostAdvanced[Color::BLACK][i] = Rank::R8;
+	}
+
+	BitBoard pieces = pawns;
+	BB_FOR_EACH(sq, pieces) {
+		entry.mostAdvanced[Side][sq.getFile() + 1] = std::max(entry.mostAdvanced[Side][sq.getFile() + 1], Rank::makeRelativeRank(Side, sq.getRank()));
+
+		if (File f = sq.getFile(); f == File::H || BitBoard::fromFile(File::Value(f + 1)).b_and(pawns) == BitBoard::EMPTY) {
+			entry.islandsCount[Side]++;
+		} else if (BitBoard pawnsOnNextFile = BitBoard::fromFile(File::Value(f + 1)).b_and(pawns); pawnsOnNextFile != BitBoard::EMPTY) {
+			entry.distortion[Side] += std::max(0, std::abs(pawnsOnNextFile.lsb().getRank() - sq.getRank()) - 1);
+		}
+
+		if (ourPawnAttacks.test(sq)) {
+			entry.pawnEvaluation[Side] += scores::DEFENDED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())];
+		}
+
+		if (BitBoard::threeFilesForward<Side>(sq).b_and(enemyPawns) == BitBoard::EMPTY
+			&& BitBoard::directionBits<Up>(sq).b_and(pawns) == BitBoard::EMPTY) {
+			entry.pawnEvaluation[Side] += scores::PASSED_PAWN[Rank::makeRelativeRank(Side, sq.getRank())];
+			entry.passed.set(sq);
+		}
+
+		if (BitBoard::adjacentFiles(sq.getFile()).b_and(pawns) == BitBoard::EMPTY) {
+			entry.pawnEvaluation[Side] += scores::ISOLATED_PAWN;
+			entry.isolated.set(sq);
+		}
+
+		if (BitBoard::directionBits<Up>(sq).b_and(pawns) != BitBoard::EMPTY) {
+			entry.pawnEvaluation[Side] += scores::DOUBLE_PAWN;
+			entry.doubled.set(sq);
+		}
+
+		if (BitBoard::adjacentFilesForward<OppositeSide>(sq.shift(Up)).b_and(pawns) == BitBoard::EMPTY
+			&& BitBoard::pawnAttacks(Side, sq.shift(Up)).b_and(enemyPawns)) {
+			entry.pawnEvaluation[Side] += scores::BACKWARD_PAWN;
+			entry.backward.set(sq);
+		}
+	}
+
+	entry.pawnEvaluation[Side] += scores::PAWN_ISLANDS[std::min(entry.islandsCount[Side], u8(4))];
+	entry.pawnEvaluation[Side] += scores::PAWN_DISTORTION * entry.distortion[Side];
+}
+
+template<> bool test<12>() {
+	constexpr auto testName = "PawnHashTableTest(scanPawnsDifferentialTest)";
+
+	std::mt19937_64 random(0x5eed);
+	for (u32 i = 0; i < 20000; ++i) {
+		engine::PawnHashEntry entry, expected;
+		memset(&entry, 0, sizeof(entry));
+		memset(&expected, 0, sizeof(expected));
+
+		// Random pawns on the ranks 2-7, sparse enough to get passed and isolated pawns as well
+		const u64 middleRanks = 0x00ffffffffffff00ull;
+		const u64 occupied = random() & random() & middleRanks;
+		const u64 white = occupied & random();
+
+		entry.pawns[Color::WHITE] = expected.pawns[Color::WHITE] = BitBoard(white);
+		entry.pawns[Color::BLACK] = expected.pawns[Color::BLACK] = BitBoard(occupied & ~white);
+
+		engine::PawnHashTable::scanPawnStructure(entry);
+		scanPawnsReference<Color::WHITE>(expected);
+		scanPawnsReference<Color::BLACK>(expected);
+
+		EXPECT_EQ(u64(entry.passed), u64(expected.passed));
+		EXPECT_EQ(u64(entry.isolated), u64(expected.isolated));
+		EXPECT_EQ(u64(entry.doubled), u64(expected.doubled));
+		EXPECT_EQ(u64(entry.backward), u64(expected.backward));
+		EXPECT_EQ(entry.islandsCount[Color::WHITE], expected.islandsCount[Color::WHITE]);
+		EXPECT_EQ(entry.islandsCount[Color::BLACK], expected.islandsCount[Color::BLACK]);
+		EXPECT_EQ(entry.distortion[Color::WHITE], expected.distortion[Color::WHITE]);
+		EXPECT_EQ(entry.distortion[Color::BLACK], expected.distortion[Color::BLACK]);
+		EXPECT_TRUE(entry.pawnEvaluation[Color::WHITE] == expected.pawnEvaluation[Color::WHITE]);
+		EXPECT_TRUE(entry.pawnEvaluation[Color::BLACK] == expected.pawnEvaluation[Color::BLACK]);
+		EXPECT_TRUE(memcmp(&entry, &expected, sizeof(entry)) == 0);
+	}
+
+	return true;
+}
+
+
+///  KPK BITBASE TESTS  ///
+
+// Textbook KPK positions and whether they are won for the side with the pawn
+const std::pair<std::string, bool> KPK_TESTS[] = {
+	{ "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", true }, // King on the 6th in front of the pawn
+	{ "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", true },
+	{ "8/4k3/8/4K3/4P3/8/8/8 w - - 0 1", false }, // Black has the opposition
+	{ "8/4k3/8/4K3/4P3/8/8/8 b - - 0 1", true }, // White has the opposition
+	{ "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", false }, // Stalemate
+	{ "8/8/8/8/8/8/4P3/K6k w - - 0 1", true }, // Outside of the square
+	{ "8/8/8/8/8/8/4P3/K3k3 b - - 0 1", false }, // The pawn is captured
+	{ "7k/8/8/8/8/7P/8/K7 w - - 0 1", false } // Rook pawn with the king in the corner
+};
+
+// Swaps the colors of the pieces and the side to move, for positions without castlings and en passant
+std::string mirrorFEN(const std::string& fen) {
+	const size_t piecesEnd = fen.find(' ');
+	std::string ranks[8];
+	for (size_t i = 0, rank = 0; i < piecesEnd; i++) {
+		if (fen[i] == '/') {
+			rank++;
+		} else {
+			ranks[rank] += char(isupper(fen[i]) ? tolower(fen[i]) : toupper(fen[i]));
+		}
+	}
+
+	std::string result;
+	for (i32 rank = 7; rank >= 0; rank--) {
+		result.append(ranks[rank]).append(rank ? "/" : "");
+	}
+
+	const char side = fen[piecesEnd + 1] == 'w' ? 'b' : 'w';
+	return result.append(1, ' ').append(1, side).append(fen.substr(piecesEnd + 2));
+}
+
+template<> bool test<13>() {
+	constexpr auto testName = "KPKBitbaseTest(textbookPositionsTest)";
+
+	for (const auto& [fen, isWin] : KPK_TESTS) {
+		bool success;
+		Board board = Board::fromFEN(fen, success);
+		EXPECT_TRUE(success);
+
+		EXPECT_TRUE(engine::KPKBitbase::isKPK(board));
+		EXPECT_EQ(engine::KPKBitbase::probe<Color::WHITE>(board), isWin);
+		EXPECT_EQ(engine::eval(board) != 0, isWin);
+
+		// The same position with the colors swapped
+		Board mirrored = Board::fromFEN(mirrorFEN(fen), success);
+		EXPECT_TRUE(success);
+		EXPECT_EQ(engine::KPKBitbase::probe<Color::BLACK>(mirrored), isWin);
+		EXPECT_EQ(engine::eval(mirrored), engine::eval(board));
+	}
+
+	return true;
+}
+
+
+///  GENERATED BITBASES TESTS  ///
+
+// The generated KPvK bitbase must agree with the KPK bitbase in every position
+template<> bool test<14>() {
+	constexpr auto testName = "BitbaseTest(generatedKPKTest)";
+
+	const std::string oldPath = engine::Bitbases::tablesCount() ? engine::Bitbases::path() : "";
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "chessgm_bitbase_test";
+	std::filesystem::remove_all(path);
+	engine::Bitbases::init(path.string());
+
+	engine::BitbaseMaterial material;
+	EXPECT_TRUE(engine::BitbaseMaterial::fromString("KvKP", material));
+	EXPECT_EQ(material.toString(), std::string("KPvK"));
+
+	std::vector<engine::BitbaseGenerationReport> reports;
+	EXPECT_TRUE(engine::BitbaseGenerator::generate(material, 2, reports));
+	EXPECT_EQ(reports.size(), size_t(6)); // KvK, KQvK, KRvK, KBvK, KNvK, KPvK
+
+	const Piece pieces[] = { Piece::KING_WHITE, Piece::KING_BLACK, Piece::PAWN_WHITE };
+	for (auto whiteKing : Square::iter()) {
+		for (auto blackKing : Square::iter()) {
+			for (u8 pawn = Square::A2; pawn <= Square::H7; pawn++) {
+				if (Square::distance(whiteKing, blackKing) <= 1 || pawn == whiteKing || pawn == blackKing) {
+					continue;
+				}
+
+				for (Color side : Color::iter()) {
+					const Square squares[] = { whiteKing, blackKing, Square::Value(pawn) };
+					Board board = Board::fromPieces(pieces, squares, 3, side);
+					if (board.computeAttackersOf(side, board.king(side.getOpposite()))) {
+						continue;
+					}
+
+					engine::BitbaseResult result;
+					EXPECT_TRUE(engine::Bitbases::probe(board, result));
+
+					const engine::BitbaseResult expected = !engine::KPKBitbase::probe<Color::WHITE>(board)
+						? engine::BitbaseResult::DRAW
+						: side == Color::WHITE ? engine::BitbaseResult::WIN : engine::BitbaseResult::LOSS;
+					EXPECT_EQ(u32(result), u32(expected));
+				}
+			}
+		}
+	}
+
+	// The same position with the colors swapped
+	bool success;
+	Board board = Board::fromFEN(mirrorFEN("8/8/8/8/4k3/8/4P3/4K3 b - - 0 1"), success);
+	EXPECT_TRUE(success);
+
+	engine::BitbaseResult result;
+	EXPECT_TRUE(engine::Bitbases::probe(board, result));
+	EXPECT_EQ(result == engine::BitbaseResult::LOSS, engine::KPKBitbase::probe<Color::BLACK>(board));
+
+	engine::Bitbases::init(oldPath);
+	std::filesystem::remove_all(path);
+
+	return true;
+}
+
+
+
+///  OPENING BOOK TESTS  ///
+
+template<> bool test<15>() {
+	constexpr auto testName = "BookTest(polyglotBookTest)";
+
+	bool success;
+	Board initial = Board::fromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", success);
+	Board castles = Board::fromFEN("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", success);
+	const u64 initialKey = engine::Book::polyglotKey(initial);
+	const u64 castlesKey = engine::Book::polyglotKey(castles);
+
+	// The keys from the Polyglot format description
+	constexpr std::pair<const char*, u64> POLYGLOT_KEYS[] = {
+		{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463b96181691fc9c },
+		{ "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196 },
+		{ "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0 },
+		{ "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4 },
+		{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78 },
+		{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1 },
+		{ "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9 },
+		{ "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637 },
+		{ "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560 }
+	};
+
+	for (const auto& [fen, key] : POLYGLOT_KEYS) {
+		EXPECT_EQ(engine::Book::polyglotKey(Board::fromFEN(fen, success)), key);
+	}
+
+	EXPECT_EQ(initialKey, u64(0x463b96181691fc9c));
+
+	// The same position after a transposition has the same key, en passant only counts if it can be captured
+	for (auto move : { "g1f3", "g8f6", "f3g1", "f6g8" }) {
+		initial.makeMove(initial.makeMoveFromString(move));
+	}
+
+	EXPECT_EQ(engine::Book::polyglotKey(initial), initialKey);
+
+	const Move e2e4 = initial.makeMoveFromString("e2e4");
+	initial.makeMove(e2e4);
+	EXPECT_EQ(engine::Book::polyglotKey(initial), u64(0x823c9b50fd114196));
+	Board noEnPassant = Board::fromFEN("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1", success);
+	EXPECT_EQ(engine::Book::polyglotKey(initial), engine::Book::polyglotKey(noEnPassant));
+	initial.unmakeMove(e2e4);
+
+	// Castling is the king capturing its own rook
+	const Move castle = castles.makeMoveFromString("0-0");
+	EXPECT_EQ(engine::Book::toPolyglotMove(castles, castle), u16(Square::H1 | (Square::E1 << 6)));
+	EXPECT_TRUE(engine::Book::fromPolyglotMove(castles, u16(Square::H1 | (Square::E1 << 6))) == castle);
+
+	// A small book with an illegal move that must be skipped
+	const engine::BookEntry entries[] = {
+		{ initialKey, engine::Book::toPolyglotMove(initial, initial.makeMoveFromString("e2e4")), 3, 0 },
+		{ initialKey, engine::Book::toPolyglotMove(initial, initial.makeMoveFromString("d2d4")), 1, 0 },
+		{ initialKey, u16(Square::E5 | (Square::E2 << 6)), 5, 0 },
+		{ castlesKey, engine::Book::toPolyglotMove(castles, castle), 1, 0 }
+	};
+
+	std::vector<engine::BookEntry> sorted(std::begin(entries), std::end(entries));
+	std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+
+	std::vector<u8> data(sorted.size() * engine::Book::ENTRY_SIZE);
+	for (size_t i = 0; i < sorted.size(); i++) {
+		engine::Book::writeEntry(data.data() + i * engine::Book::ENTRY_SIZE, sorted[i]);
+	}
+
+	const std::string path = (std::filesystem::temp_directory_path() / "chessgm_book_test.bin").string();
+	std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+	EXPECT_TRUE(engine::Book::open(path));
+	EXPECT_EQ(engine::Book::entriesCount(), size_t(4));
+
+	std::vector<engine::BookEntry> found;
+	engine::Book::getEntries(initial, found);
+	EXPECT_EQ(found.size(), size_t(2));
+	EXPECT_EQ(found[0].weight, u16(3));
+
+	const Move bookMove = engine::Book::probe(initial);
+	EXPECT_TRUE(bookMove == initial.makeMoveFromString("e2e4") || bookMove == initial.makeMoveFromString("d2d4"));
+	EXPECT_TRUE(engine::Book::probe(castles) == castle);
+	EXPECT_TRUE(engine::Book::probe(noEnPassant).isNullMove());
+
+	engine::Book::close();
+	std::filesystem::remove(path);
+
+	return true;
+}
+
+template<> bool test<16>() {
+	constexpr auto testName = "BookTest(bookBuildingTest)";
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "chessgm_book_build_test";
+	std::filesystem::create_directories(directory);
+
+	const std::string pgnPath = (directory / "games.pgn").string();
+	const std::string bookPath = (directory / "book.bin").string();
+	std::ofstream(pgnPath, std::ios::binary) 
+		<< "[Event \"1\"]\n[Result \"1-0\"]\n\n1. e2e4 e7e5 2. g1f3 1-0\n\n"
+		<< "[Event \"2\"]\n[Result \"0-1\"]\n\n1. e2e4 {A comment. 2. d2d4} c7c5 (1... e7e6 2. d2d4) 0-1\n\n"
+		<< "[Event \"3\"]\n[Result \"1/2-1/2\"]\n\n1. d2d4 d7d5\n1/2-1/2\n\n"
+		<< "[Event \"4\"]\n[Result \"*\"]\n\n1. g2g3 b7b6 *\n"; // Skipped, since its result is unknown
+
+	// A tiny memory limit makes every counter spill to the disk
+	engine::BookBuildSettings settings;
+	settings.minGames = 1;
+	settings.maxPly = 2;
+	settings.threadsCount = 2;
+	settings.memoryLimit = 1;
+
+	engine::BookBuildReport report;
+	EXPECT_TRUE(engine::BookBuilder::build({ pgnPath }, bookPath, settings, report));
+	EXPECT_EQ(report.games, u64(3));
+	EXPECT_EQ(report.moves, u64(6));
+	EXPECT_TRUE(report.runs > 0);
+	EXPECT_EQ(report.entries, u64(4)); // All but e7e5, since a lost move has no weight
+
+	bool success;
+	Board board = Board::fromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", success);
+	EXPECT_TRUE(engine::Book::open(bookPath));
+
+	std::vector<engine::BookEntry> entries;
+	engine::Book::getEntries(board, entries);
+	EXPECT_EQ(entries.size(), size_t(2));
+	for (const engine::BookEntry& entry : entries) {
+		EXPECT_EQ(entry.key, u64(0x463b96181691fc9c)); // The start position's Polyglot key, as in the books built by other tools
+		const Move move = engine::Book::fromPolyglotMove(board, entry.move);
+		EXPECT_EQ(entry.weight, u16(move == board.makeMoveFromString("e2e4") ? 2 : 1));
+	}
+
+	board.makeMove(board.makeMoveFromString("e2e4"));
+	entries.clear();
+	engine::Book::getEntries(board, entries);
+	EXPECT_EQ(entries.size(), size_t(1));
+	EXPECT_TRUE(engine::Book::fromPolyglotMove(board, entries[0].move) == board.makeMoveFromString("c7c5"));
+	engine::Book::close();
+
+	// Only e2e4 was played twice
+	settings.minGames = 2;
+	EXPECT_TRUE(engine::BookBuilder::build({ pgnPath }, bookPath, settings, report));
+	EXPECT_EQ(report.entries, u64(1));
+
+	// Every pawn move for both sides, so that the spilled runs are many more than merged at once
+	const std::string files = "abcdefgh";
+	const std::string results[] = { "1-0", "0-1", "1/2-1/2" };
+	std::ofstream manyGames(pgnPath, std::ios::binary);
+	for (size_t white = 0; white < 16; white++) {
+		for (size_t black = 0; black < 16; black++) {
+			const std::string& result = results[(white + black) % 3];
+			manyGames << "[Result \"" << result << "\"]\n\n1. " 
+				<< files[white / 2] << '2' << files[white / 2] << (white % 2 ? '4' : '3') << ' '
+				<< files[black / 2] << '7' << files[black / 2] << (black % 2 ? '5' : '6') << ' ' << result << "\n\n";
+		}
+	}
+
+	manyGames.close();
+
+	const auto readFile = [](const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	};
+
+	settings.minGames = 1;
+	EXPECT_TRUE(engine::BookBuilder::build({ pgnPath }, bookPath, settings, report));
+	EXPECT_EQ(report.games, u64(256));
+	EXPECT_TRUE(report.runs > 16); // Nearly one per counter, merged in several passes
+	const std::string spilledBook = readFile(bookPath);
+
+	settings.memoryLimit = 64ull << 20;
+	EXPECT_TRUE(engine::BookBuilder::build({ pgnPath }, bookPath, settings, report));
+	EXPECT_EQ(report.runs, u64(0));
+	EXPECT_EQ(report.entries, u64(16 + 170)); // The black moves of the games won by white have no weight
+	EXPECT_TRUE(readFile(bookPath) == spilledBook);
+	EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 2); // No runs left
+
+	std::filesystem::remove_all(directory);
+
+	return true;
+}
+
+template<> bool test<17>() {
+	constexpr auto testName = "PositionIndexTest(pgnIndexTest)";
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "chessgm_position_index_test";
+	std::filesystem::create_directories(directory);
+
+	const std::string pgnPath = (directory / "games.pgn").string();
+	const std::string games[] = {
+		"[Event \"1\"]\n[White \"A\"]\n[Black \"B\"]\n[Result \"1-0\"]\n\n1. g1f3 g8f6 2. d2d4 1-0\n\n",
+		"[Event \"2\"]\n[White \"C\"]\n[Black \"D\"]\n[Result \"0-1\"]\n\n1. d2d4 g8f6 2. g1f3 0-1\n\n",
+		"[Event \"3\"]\n[White \"E\"]\n[Black \"F\"]\n[Result \"1/2-1/2\"]\n\n1. e2e4 e7e5 1/2-1/2\n\n"
+	};
+
+	std::ofstream(pgnPath, std::ios::binary) << games[0] << games[1] << games[2];
+
+	engine::PositionIndexReport report;
+	EXPECT_TRUE(engine::PositionIndex::build(pgnPath, 2, UINT32_MAX, report));
+	EXPECT_EQ(report.games, u64(3));
+	EXPECT_EQ(report.positions, u64(4 + 4 + 3));
+
+	// The first two games transpose into the same position
+	bool success;
+	Board board = Board::fromFEN("rnbqkb1r/pppppppp/5n2/8/3P4/5N2/PPP1PPPP/RNBQKB1R b KQkq - 2 2", success);
+
+	std::vector<u64> offsets;
+	EXPECT_TRUE(engine::PositionIndex::find(pgnPath, board, offsets));
+	EXPECT_EQ(offsets.size(), size_t(2));
+	EXPECT_EQ(u64(offsets[0]), u64(0));
+	EXPECT_EQ(u64(offsets[1]), u64(games[0].size()));
+
+	const engine::IndexedGame game = engine::PositionIndex::readGame(pgnPath, offsets[1]);
+	EXPECT_EQ(game.white, std::string("C"));
+	EXPECT_EQ(game.result, std::string("0-1"));
+
+	offsets.clear();
+	board = Board::fromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", success);
+	EXPECT_TRUE(engine::PositionIndex::find(pgnPath, board, offsets));
+	EXPECT_EQ(offsets.size(), size_t(3));
+
+	// The index of a changed pgn file is not used
+	std::ofstream(pgnPath, std::ios::binary | std::ios::app) << games[2];
+	EXPECT_TRUE(!engine::PositionIndex::find(pgnPath, board, offsets));
+
+	std::filesystem::remove_all(directory);
+
+	return true;
+}
+
+template<> bool test<18>() {
+	constexpr auto testName = "PgnTest(sanParsingTest)";
+
+	// FEN, SAN, the same move in the long algebraic form or "-" for the illegal ones
+	const std::tuple<std::string_view, std::string_view, std::string_view> cases[] = {
+		{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "e4", "e2e4" },
+		{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "Nf3", "g1f3" },
+		{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "e5", "-" },
+		{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "Nd2", "-" },
+		{ "4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1", "Rd1", "a1d1" },
+		{ "4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1", "O-O", "0-0" },
+		{ "4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1", "O-O-O+", "0-0-0" },
+		{ "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "Nd2", "-" },
+		{ "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "Nbd2", "b1d2" },
+		{ "4k3/8/8/8/8/1N6/8/1N2K3 w - - 0 1", "N1d2", "b1d2" },
+		{ "4k3/4r3/8/8/8/8/4N3/1N2K3 w - - 0 1", "Nc3", "b1c3" },
+		{ "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "exd6", "e5d6" },
+		{ "3r4/4P1k1/8/8/8/8/8/4K3 w - - 0 1", "e8=Q", "e7e8q" },
+		{ "3r4/4P1k1/8/8/8/8/8/4K3 w - - 0 1", "e8N", "e7e8n" },
+		{ "3r4/4P1k1/8/8/8/8/8/4K3 w - - 0 1", "exd8=R!?", "e7d8r" },
+		{ "3r4/4P1k1/8/8/8/8/8/4K3 w - - 0 1", "e8", "-" },
+		{ "4k3/8/8/8/8/8/3N4/r3K3 w - - 0 1", "Nb1", "d2b1" },
+		{ "4k3/8/8/8/8/8/3N4/r3K3 w - - 0 1", "Nf3", "-" },
+		{ "4k3/8/8/8/8/8/3N4/r3K3 w - - 0 1", "Kd1", "-" },
+		{ "4k3/8/8/8/8/8/3N4/r3K3 w - - 0 1", "Ke2", "e1e2" },
+		{ "r3k2r/8/8/8/8/8/8/4K3 b kq - 0 1", "O-O-O", "0-0-0" }
+	};
+
+	for (const auto& [fen, san, expected] : cases) {
+		bool success;
+		const Board board = Board::fromFEN(fen, success);
+		const Move move = board.makeMoveFromSAN(san);
+
+		EXPECT_TRUE(expected == "-" ? move.isNullMove() : (!move.isNullMove() && move == board.makeMoveFromString(expected)));
+	}
+
+	// A pgn in SAN with comments, variations and NAGs, the second game has neither a blank line nor a result
+	const std::string pgnPath = (std::filesystem::temp_directory_path() / "chessgm_pgn_test.pgn").string();
+	const std::string firstGame = "[Event \"1\"]\n[Result \"0-1\"]\n\n"
+		"1.e4 {A comment (with a variation)} e5 $1 2. Nf3 (2. f4 exf4; a comment\n3. Nf3) 2... Nc6 3.Bb5 a6 4. Bxc6 dxc6 5. O-O f6 0-1\n\n";
+	std::ofstream(pgnPath, std::ios::binary) << firstGame
+		<< "[Event \"2\"]\n[FEN \"4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1\"]\n1. O-O Kd7 2. Rad1+\n";
+
+	engine::PgnReader reader;
+	engine::PgnGame game;
+	EXPECT_TRUE(reader.open(pgnPath));
+	EXPECT_TRUE(reader.readGame(game));
+	EXPECT_EQ(game.moves.size(), size_t(10));
+	EXPECT_EQ(game.result, 0.f);
+	EXPECT_TRUE(!game.isCorrupted);
+
+	EXPECT_TRUE(reader.readGame(game));
+	EXPECT_EQ(game.offset, u64(firstGame.size()));
+	EXPECT_EQ(game.moves.size(), size_t(3));
+	EXPECT_EQ(game.result, 0.5f);
+	EXPECT_TRUE(!reader.readGame(game));
+
+	// Each chunk is read separately
+	std::vector<engine::PgnChunk> chunks;
+	EXPECT_TRUE(engine::PgnReader::split(pgnPath, 16, chunks));
+	EXPECT_EQ(chunks.size(), size_t(2));
+	EXPECT_TRUE(reader.open(chunks[0]) && reader.readGame(game) && !reader.readGame(game));
+
+	std::filesystem::remove(pgnPath);
+
+	return true;
+}
+
+
+///  TUNING TESTS  ///
+
+template<> bool test<19>() {
+	constexpr auto testName = "TuningTest(parallelErrorTest)";
+
+	const std::string fens[] = {
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 res 0.5",
+		"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4 res 1.0",
+		"8/5pk1/6p1/3P4/2P5/8/5PPP/6K1 b - - 0 40 res 1.0",
+		"r4rk1/1pp2ppp/p1n5/3q4/3P4/P1Q2N2/1P3PPP/R4RK1 b - - 0 16 res 0.0"
+	};
+
+	// Several blocks of positions, the last one is incomplete
+	const std::string path = (std::filesystem::temp_directory_path() / "chessgm_tuning_test.fen").string();
+	{
+		std::ofstream file(path);
+		for (size_t i = 0; i < engine::Tuning::ERR_BLOCK_SIZE * 2 + 100; i++) {
+			file << fens[i % std::size(fens)] << "\n";
+		}
+	}
+
+	engine::Tuning tuning;
+	tuning.loadPositions(path);
+	const double err = tuning.computeErr();
+	EXPECT_TRUE(err > 0 && err < 1);
+
+	// The error must be exactly the same with any threads count
+	for (const u32 threadsCount : { 2u, 3u, 16u, 1u }) {
+		tuning.setThreadsCount(threadsCount);
+		EXPECT_EQ(tuning.computeErr(), err);
+	}
+
+	std::filesystem::remove(path);
+
+	return true;
+}
+
+template<> bool test<20>() {
+	constexpr auto testName = "TuningTest(evalTraceTest)";
+
+	// The piece-square weights are the halves of PST without the piece values
+	for (const Piece piece : Piece::iter()) {
+		if (piece.getType() == PieceType::NONE) {
+			continue;
+		}
+
+		for (const Square sq : Square::iter()) {
+			const Score weight = scores::Weights::get(scores::Weights::pstIndexOf(piece, sq));
+			EXPECT_TRUE(scores::PST[piece][sq] == scores::PIECE_VALUE[piece.getType()] + weight);
+		}
+	}
+
+	// Changing a piece value changes its PST as well
+	const u32 knightIndex = scores::Weights::indexOf(scores::PIECE_VALUE[PieceType::KNIGHT]);
+	const Score knightValue = scores::Weights::get(knightIndex);
+	const Score knightPst = scores::PST[Piece::KNIGHT_BLACK][Square::C6];
+	scores::Weights::set(knightIndex, knightValue + Score(10, 20));
+	EXPECT_TRUE(scores::PST[Piece::KNIGHT_BLACK][Square::C6] == knightPst + Score(10, 20));
+	scores::Weights::set(knightIndex, knightValue);
+	EXPECT_TRUE(scores::PST[Piece::KNIGHT_BLACK][Square::C6] == knightPst);
+
+	// The weights multiplied by the coefficients give the evaluation up to the rounding
+	const std::string fens[] = {
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 4 4",
+		"8/5pk1/6p1/3P4/2P5/8/5PPP/6K1 b - - 0 40",
+		"r4rk1/1pp2ppp/p1n5/3q4/3P4/P1Q2N2/1P3PPP/R4RK1 w - - 0 16",
+		"2r3k1/1b3pp1/p3p2p/1p1nP3/3N4/P1R3P1/1P3PBP/6K1 w - - 0 28",
+		"8/8/4k3/8/2B5/3KN3/8/8 w - - 0 1" // Not linear
+	};
+
+	engine::EvalTrace trace;
+	for (const std::string& fen : fens) {
+		bool success;
+		Board board = Board::fromFEN(fen, success);
+		engine::traceEval(board, trace);
+
+		const Value staticEval = board.side() == Color::WHITE ? engine::eval(board) : -engine::eval(board);
+		if (!trace.isLinear) {
+			EXPECT_TRUE(trace.coefficients.empty());
+			continue;
+		}
+
+		double traced = 0.0;
+		for (const auto& [index, coefficient] : trace.coefficients) {
+			const Score weight = scores::Weights::get(index);
+			traced += coefficient * (weight.middlegame() * trace.phase + weight.endgame() * (1.0 - trace.phase));
+		}
+
+		EXPECT_TRUE(std::abs(traced - staticEval) <= 2.0);
+	}
+
+	return true;
+}
+
+template<> bool test<21>() {
+	constexpr auto testName = "TuningTest(localSearchTest)";
+
+	const std::string fens[] = {
+		"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4 res 1.0",
+		"8/5pk1/6p1/3P4/2P5/8/5PPP/6K1 b - - 0 40 res 1.0",
+		"r4rk1/1pp2ppp/p1n5/3q4/3P4/P1Q2N2/1P3PPP/R4RK1 b - - 0 16 res 0.0",
+		"2r3k1/1b3pp1/p3p2p/1p1nP3/3N4/P1R3P1/1P3PBP/6K1 w - - 0 28 res 0.5",
+		"8/8/4k3/8/2B5/3KN3/8/8 w - - 0 1 res 1.0"
+	};
+
+	const std::string path = (std::filesystem::temp_directory_path() / "chessgm_local_search_test.fen").string();
+	std::ofstream(path) << fens[0] << "\n" << fens[1] << "\n" << fens[2] << "\n" << fens[3] << "\n" << fens[4] << "\n";
+
+	std::vector<Score> initialWeights;
+	for (u32 i = 0; i < scores::Weights::count(); i++) {
+		initialWeights.push_back(scores::Weights::get(i));
+	}
+
+	// A pawn structure weight, a piece value, a piece-square weight and one not used at all
+	const std::vector<u32> weights = {
+		scores::Weights::indexOf(scores::PASSED_PAWN[4]),
+		scores::Weights::indexOf(scores::PIECE_VALUE[PieceType::ROOK]),
+		scores::Weights::pstIndexOf(Piece::QUEEN_WHITE, Square::C3),
+		scores::Weights::indexOf(scores::QUEEN_MOBILITY[27])
+	};
+
+	engine::Tuning tuning;
+	tuning.loadPositions(path);
+	const double initialErr = tuning.computeErr();
+
+	std::cout.setstate(std::ios::failbit); // The tuning progress is not needed here
+	const double err = tuning.optimizeScores(weights, 2);
+	std::cout.clear();
+
+	// The incrementally updated error is the same as the full one
+	EXPECT_TRUE(err < initialErr);
+	EXPECT_TRUE(std::abs(tuning.computeErr() - err) < 1e-9);
+	EXPECT_TRUE(scores::Weights::get(weights[3]) == initialWeights[weights[3]]);
+
+	for (u32 i = 0; i < scores::Weights::count(); i++) {
+		scores::Weights::set(i, initialWeights[i]);
+	}
+
+	std::filesystem::remove(path);
+
+	return true;
+}
+
+template<> bool test<22>() {
+	constexpr auto testName = "TuningTest(packedPositionsTest)";
+
+	const std::string fens[] = {
+		"r3k2r/pppq1ppp/2n2n2/3pp3/1bB1P3/2NP1N2/PPPQ1PPP/R3K2R w Kq d6 0 9",
+		"8/5pk1/6p1/3P4/2P5/8/5PPP/6K1 b - - 0 40",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+	};
+
+	// The move counters are not packed
+	const auto withoutCounters = [](const std::string& fen) {
+		return fen.substr(0, fen.rfind(' ', fen.rfind(' ') - 1));
+	};
+
+	// All the pieces, the castling rights and en passant survive packing
+	for (const std::string& fen : fens) {
+		bool success;
+		const Board board = Board::fromFEN(fen, success);
+		const engine::PackedPosition packed = engine::PackedPosition::pack(board, 0.5f, 40);
+		const Board unpacked = packed.unpack();
+
+		EXPECT_TRUE(withoutCounters(unpacked.toFEN()) == withoutCounters(fen));
+		EXPECT_TRUE(unpacked.score() == board.score());
+		EXPECT_EQ(packed.gameResult(), 0.5f);
+		EXPECT_EQ(packed.length, u16(40));
+	}
+
+	// The converted file is mapped and gives the same error as the text
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "chessgm_packed_test";
+	std::filesystem::create_directories(directory);
+
+	const std::string textPath = (directory / "positions.fen").string();
+	const std::string packedPath = (directory / "positions.cgtp").string();
+	std::ofstream(textPath) << fens[0] << " res 1.0; len 60;\n" << fens[1] << " res 0.5;\nwrong line\n" << fens[2] << " res 0.0; len 80;\n";
+
+	EXPECT_TRUE(engine::Tuning::convertPositions(textPath, packedPath));
+	EXPECT_EQ(std::filesystem::file_size(packedPath), uintmax_t(engine::PackedPositions::HEADER_SIZE + 3 * sizeof(engine::PackedPosition)));
+
+	{
+		engine::Tuning text;
+		text.loadPositions(textPath);
+		engine::Tuning packed;
+		packed.loadPositions(packedPath);
+
+		EXPECT_EQ(text.positionsCount(), size_t(3));
+		EXPECT_EQ(packed.positionsCount(), size_t(3));
+		EXPECT_EQ(packed.computeErr(), text.computeErr());
+	}
+
+	std::filesystem::remove_all(directory);
+
+	return true;
+}
+
+template<> bool test<23>() {
+	constexpr auto testName = "BenchTest(signatureTest)";
+
+	engine::BenchSettings settings;
+	settings.depth = 5;
+	settings.hashSize = 4;
+
+	const uint32_t hashSize = engine::TranspositionTable::size();
+	const bool postMode = options::g_postMode;
+
+	// The node count does not depend on what was searched before
+	const engine::BenchReport first = engine::Bench::run(settings);
+	const engine::BenchReport second = engine::Bench::run(settings);
+
+	EXPECT_EQ(first.positions, u32(50));
+	EXPECT_TRUE(first.nodes != 0);
+	EXPECT_EQ(first.nodes, second.nodes);
+
+	// The settings of the engine are restored
+	EXPECT_EQ(engine::TranspositionTable::size(), hashSize);
+	EXPECT_EQ(options::g_postMode, postMode);
+	EXPECT_TRUE(engine::g_isInputChecked);
+
+	return true;
+}
+
+template<> bool test<24>() {
+	constexpr auto testName = "EpdTest(solveTest)";
+
+	std::vector<engine::EpdPosition> positions(3);
+	EXPECT_TRUE(engine::EpdTest::parse("2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - bm Qg6; id \"WAC.001\";", positions[0]));
+	EXPECT_TRUE(engine::EpdTest::parse("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - bm d1d8; id \"mate in 1\";", positions[1]));
+	EXPECT_TRUE(engine::EpdTest::parse("6k1/5ppp/8/8/8/8/3r1PPP/3R2K1 w - - am Kf1;", positions[2]));
+
+	EXPECT_EQ(positions[0].id, std::string("WAC.001"));
+	EXPECT_EQ(positions[0].fen, std::string("2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1"));
+	EXPECT_EQ(positions[1].bestMoves.size(), size_t(1));
+	EXPECT_EQ(positions[1].bestMoves[0].toString(), std::string("d1d8"));
+	EXPECT_EQ(positions[2].avoidMoves.size(), size_t(1));
+
+	// Illegal moves and the records without bm/am are skipped
+	engine::EpdPosition skipped;
+	EXPECT_TRUE(!engine::EpdTest::parse("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - bm Rd7d8;", skipped));
+	EXPECT_TRUE(!engine::EpdTest::parse("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - id \"none\";", skipped));
+
+	const uint32_t hashSize = engine::TranspositionTable::size();
+
+	engine::EpdTestSettings settings;
+	settings.limitType = engine::LimitType::DEPTH;
+	settings.limit = 6;
+	settings.threadsCount = 2;
+
+	const engine::EpdTestReport report = engine::EpdTest::run(positions, settings);
+	EXPECT_EQ(report.solved, u32(3));
+	EXPECT_EQ(report.results[1].solutionDepth, Depth(1));
+	EXPECT_TRUE(report.results[0].solutionNodes <= report.results[0].nodes);
+
+	// The engine is back to the whole table and to polling the input
+	EXPECT_EQ(engine::TranspositionTable::size(), hashSize);
+	EXPECT_TRUE(engine::g_isInputChecked);
+
+	return true;
+}
+
+
+template<> bool test<25>() {
+	constexpr auto testName = "BatchAnalysisTest(jsonLinesTest)";
+
+	std::istringstream input(
+		"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1\n"
+		"\n"
+		"# A comment\n"
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -\n"
+		"not a fen\n");
+	std::ostringstream output;
+
+	engine::BatchSettings settings;
+	settings.limitType = engine::LimitType::DEPTH;
+	settings.limit = 4;
+	settings.threadsCount = 2;
+
+	const engine::BatchReport report = engine::BatchAnalysis::run(input, output, settings);
+	EXPECT_EQ(report.positions, u64(3));
+
+	// The lines can come in any order, each has the id of the position
+	std::vector<std::string> lines(3);
+	std::istringstream result(output.str());
+	for (std::string line; std::getline(result, line); ) {
+		const size_t id = size_t(line[6] - '0');
+		EXPECT_TRUE(line.starts_with("{\"id\":") && id < lines.size() && line.ends_with("}"));
+		lines[id] = line;
+	}
+
+	EXPECT_TRUE(lines[0].find("\"bestmove\":\"d1d8\",\"score\":{\"mate\":1}") != std::string::npos);
+	EXPECT_TRUE(lines[0].find("\"pv\":[\"d1d8\"]") != std::string::npos);
+	EXPECT_TRUE(lines[1].find("\"depth\":4,") != std::string::npos);
+	EXPECT_TRUE(lines[2].find("\"error\"") != std::string::npos);
+	EXPECT_TRUE(engine::g_isInputChecked);
+
+	return true;
+}
+
+template<> bool test<26>() {
+	constexpr auto testName = "GameReviewTest(blunderTest)";
+
+	// The scholar's mate, where 3... Nf6 misses the mate in 1
+	engine::PgnGame game;
+	game.initialFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+	bool success;
+	Board board = Board::fromFEN(game.initialFen, success);
+	for (const std::string_view san : { "e4", "e5", "Bc4", "Nc6", "Qh5", "Nf6", "Qxf7#" }) {
+		const Move move = board.makeMoveFromSAN(san);
+		EXPECT_TRUE(!move.isNullMove());
+
+		game.moves.push_back(move);
+		board.makeMove(move);
+	}
+
+	engine::ReviewSettings settings;
+	settings.limitType = engine::LimitType::DEPTH;
+	settings.limit = 5;
+	settings.compareWithForward = true;
+
+	engine::GameReport report;
+	EXPECT_TRUE(engine::GameReview::review(game, settings, report));
+	EXPECT_EQ(report.moves.size(), size_t(7));
+	EXPECT_TRUE(report.moves[5].mark == engine::MoveMark::BLUNDER);
+	EXPECT_TRUE(report.moves[5].loss > engine::GameReview::MATE_CENTIPAWNS);
+	EXPECT_TRUE(report.moves[6].move == report.moves[6].best && report.moves[6].mark == engine::MoveMark::NONE);
+	EXPECT_TRUE(report.backward.nodes != 0 && report.forward.nodes != 0);
+	EXPECT_TRUE(engine::g_isInputChecked);
+
+	return true;
+}
+
+template<> bool test<27>() {
+	constexpr auto testName = "ParallelSearchTest(lazySmpTest)";
+
+	bool success;
+	Board board = Board::fromFEN("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", success);
+	Board copy = board.copy();
+	EXPECT_EQ(copy.toFEN(), board.toFEN());
+	EXPECT_EQ(copy.hash(), board.hash());
+
+	// The helpers search their copies of the board, the result is that of the main thread
+	const bool wasPostMode = options::g_postMode;
+	const u32 oldThreadsCount = engine::g_threadsCount;
+	options::g_postMode = false;
+	engine::g_isInputChecked = false;
+	engine::g_threadsCount = 3;
+
+	engine::TranspositionTable::clear();
+	engine::initSearch();
+	engine::g_limits.makeInfinite();
+	engine::g_limits.setDepthLimit(6);
+
+	const engine::SearchResult result = engine::rootSearch(board);
+	EXPECT_EQ(result.best.toString(), std::string("d1d8"));
+	EXPECT_EQ(board.toFEN(), copy.toFEN());
+
+	engine::g_threadsCount = oldThreadsCount;
+	engine::g_isInputChecked = true;
+	options::g_postMode = wasPostMode;
+
+	// 1, 2 and 3 threads, each compared with 1 thread
+	engine::BenchSettings settings;
+	settings.depth = 5;
+	settings.threadsCount = 3;
+
+	const std::vector<engine::ScalingReport> reports = engine::Bench::runScaling(settings);
+	EXPECT_EQ(reports.size(), size_t(3));
+	EXPECT_EQ(reports[2].threadsCount, u32(3));
+	EXPECT_TRUE(reports[0].npsScaling == 1.0 && reports[0].nodesOverhead == 0.0);
+	EXPECT_TRUE(reports[2].report.nodes != 0);
+	EXPECT_EQ(engine::g_threadsCount, oldThreadsCount);
+
+	std::ostringstream csv;
+	engine::Bench::writeScalingCSV(csv, reports);
+	EXPECT_TRUE(csv.str().starts_with("threads,nodes,time_ms,nps,nps_scaling,time_to_depth_speedup,nodes_overhead\n1,"));
+
+	return true;
+}
+
+template<> bool test<28>() {
+	constexpr auto testName = "WatchdogTest(hardLimitTest)";
+
+	using namespace std::chrono;
+	const auto now = []() -> time_t { return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count(); };
+
+	// The flag is raised at the deadline, unless the alarm is cleared before
+	std::atomic_bool raised = false;
+	std::atomic_bool cleared = false;
+	engine::Watchdog::set(raised, now() + 20);
+	engine::Watchdog::set(cleared, now() + 20);
+	engine::Watchdog::clear(cleared);
+
+	std::this_thread::sleep_for(milliseconds(100));
+	EXPECT_TRUE(raised.load());
+	EXPECT_TRUE(!cleared.load());
+
+	// The search is stopped at the hard limit (95% of the time for a fixed time per move) with no clock checks
+	bool success;
+	Board board = Board::fromFEN("r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 0 1", success);
+
+	const bool wasPostMode = options::g_postMode;
+	const engine::Limits oldLimits = engine::g_limits;
+	options::g_postMode = false;
+	engine::g_isInputChecked = false;
+
+	engine::TranspositionTable::clear();
+	engine::initSearch();
+	engine::g_limits.makeFixed(engine::LimitType::TIME, 200);
+
+	const time_t start = now();
+	const engine::SearchResult result = engine::rootSearch(board);
+	const time_t elapsed = now() - start;
+
+	engine::g_isInputChecked = true;
+	engine::g_limits = oldLimits;
+	options::g_postMode = wasPostMode;
+
+	EXPECT_TRUE(!result.best.isNullMove());
+	EXPECT_TRUE(elapsed <= 200);
+
+	return true;
+}
+
+///  TABLEBASES TESTS  ///
+
+template<> bool test<29>() {
+	constexpr auto testName = "SyzygyTest(missingAndCorruptedFilesTest)";
+
+	bool success;
+	Board kqk = Board::fromFEN("8/8/8/4k3/8/8/8/KQ6 w - - 0 1", success);
+	engine::WDLScore wdl;
+	i32 dtz;
+
+	// No tables are found in a missing directory
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "chessgm_syzygy_test";
+	std::filesystem::remove_all(directory);
+	engine::Syzygy::init(directory.string());
+	EXPECT_EQ(engine::Syzygy::tablesCount(), size_t(0));
+	EXPECT_TRUE(!engine::Syzygy::canProbe(kqk));
+	EXPECT_TRUE(!engine::Syzygy::probeWDL(kqk, wdl));
+
+	// Only the files named after a material are tables, the corrupted ones are rejected at the first probe:
+	// KQvK has a wrong magic, KRvK has a wrong size and KBvK is not split by the side to move as it must be
+	std::filesystem::create_directories(directory);
+	const auto writeFile = [&directory](const char* name, const std::vector<u8>& data) {
+		std::ofstream(directory / name, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+	};
+
+	constexpr u8 WDL_MAGIC[] = { 0x71, 0xe8, 0x23, 0x5d };
+	const std::vector<u8> wrongMagic(80, 0);
+	std::vector<u8> wrongSize(std::begin(WDL_MAGIC), std::end(WDL_MAGIC));
+	wrongSize.resize(20, 1);
+	std::vector<u8> wrongHeader(80, 0);
+	memcpy(wrongHeader.data(), WDL_MAGIC, sizeof(WDL_MAGIC));
+
+	writeFile("KQvK.rtbw", wrongMagic);
+	writeFile("KRvK.rtbw", wrongSize);
+	writeFile("KBvK.rtbw", wrongHeader);
+	writeFile("KvQ.rtbw", wrongHeader);
+	writeFile("KNvK.rtbz", wrongHeader);
+	writeFile("KPvK.txt", wrongHeader);
+
+	engine::Syzygy::init(directory.string());
+	EXPECT_EQ(engine::Syzygy::tablesCount(), size_t(3));
+	EXPECT_EQ(engine::Syzygy::maxPieces(), u8(3));
+
+	for (const char* fen : { "8/8/8/4k3/8/8/8/KQ6 w - - 0 1", "8/8/8/4k3/8/8/8/KR6 b - - 0 1", "kb6/8/8/8/8/8/8/7K w - - 0 1", "8/8/8/4k3/8/8/8/KN6 w - - 0 1" }) {
+		Board board = Board::fromFEN(fen, success);
+		EXPECT_TRUE(engine::Syzygy::canProbe(board));
+		EXPECT_TRUE(!engine::Syzygy::probeWDL(board, wdl));
+		EXPECT_TRUE(!engine::Syzygy::probeDTZ(board, dtz));
+
+		MoveList moves;
+		board.generateMoves(moves);
+		const u32 movesCount = moves.size();
+		EXPECT_TRUE(!engine::Syzygy::filterRootMoves(board, moves));
+		EXPECT_EQ(moves.size(), movesCount);
+	}
+
+	// KvK is a draw with no table
+	Board kk = Board::fromFEN("8/8/8/4k3/8/8/8/K7 w - - 0 1", success);
+	EXPECT_TRUE(engine::Syzygy::probeWDL(kk, wdl) && wdl == engine::WDLScore::DRAW);
+	EXPECT_TRUE(engine::Syzygy::probeDTZ(kk, dtz) && dtz == 0);
+
+	engine::Syzygy::init("");
+	EXPECT_EQ(engine::Syzygy::tablesCount(), size_t(0));
+	std::filesystem::remove_all(directory);
+
+	return true;
+}
+
+template<> bool test<30>() {
+	constexpr auto testName = "EpdTest(engineThreadsTest)";
+
+	std::vector<engine::EpdPosition> positions(4);
+	EXPECT_TRUE(engine::EpdTest::parse("2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - bm Qg6;", positions[0]));
+	EXPECT_TRUE(engine::EpdTest::parse("r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - bm Bh6;", positions[1]));
+	EXPECT_TRUE(engine::EpdTest::parse("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - bm d1d8;", positions[2]));
+	EXPECT_TRUE(engine::EpdTest::parse("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - bm e2e4;", positions[3]));
+
+	engine::EpdTestSettings settings;
+	settings.limitType = engine::LimitType::DEPTH;
+	settings.limit = 7;
+	settings.threadsCount = 2;
+
+	// The workers search on a single thread each whatever the engine's threads count is,
+	// so the depth limited searches count the same nodes as with one engine thread
+	const u32 oldThreadsCount = engine::g_threadsCount;
+	engine::g_threadsCount = 1;
+	const engine::EpdTestReport single = engine::EpdTest::run(positions, settings);
+	engine::g_threadsCount = 4;
+	const engine::EpdTestReport several = engine::EpdTest::run(positions, settings);
+	const u32 threadsCountAfter = engine::g_threadsCount;
+	engine::g_threadsCount = oldThreadsCount;
+
+	EXPECT_EQ(threadsCountAfter, u32(4));
+	for (size_t i = 0; i < positions.size(); i++) {
+		EXPECT_EQ(several.results[i].nodes, single.results[i].nodes);
+	}
+
+	return true;
+}
+
+///  INPUT QUEUE TESTS  ///
+
+template<> bool test<31>() {
+	constexpr auto testName = "InputQueueTest(handledCommandsTest)";
+
+	struct Command {
+		std::string line;
+		bool isUrgent = false;
+		bool isHandled = false;
+	};
+
+	// As in a long search: a command waits for the search to end, while more urgent commands
+	// than the queue can hold are answered, and the stop behind them must still be read
+	constexpr u32 READY_COMMANDS_COUNT = 300;
+	SpscQueue<Command, 256> queue;
+
+	std::jthread input([&] {
+		queue.push(Command { "position startpos" });
+		for (u32 i = 0; i < READY_COMMANDS_COUNT; i++) {
+			queue.push(Command { "isready", true });
+		}
+
+		queue.push(Command { "stop", true });
+	});
+
+	u32 answered = 0;
+	bool isStopped = false;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (!isStopped && std::chrono::steady_clock::now() < deadline) {
+		queue.forEach([&](Command& command) {
+			if (command.line == "isready" && !command.isHandled) {
+				command.isHandled = true;
+				answered++;
+			} else if (command.line == "stop") {
+				isStopped = true;
+			}
+		});
+
+		queue.removeIf([](const Command& command) { return command.isHandled; });
+		std::this_thread::yield();
+	}
+
+	// The commands that were not handled are left in their order
+	std::vector<std::string> left;
+	do {
+		queue.wait();
+		left.push_back(queue.front().line);
+		queue.pop();
+	} while (left.back() != "stop");
+
+	input.join();
+
+	EXPECT_TRUE(isStopped);
+	EXPECT_EQ(answered, READY_COMMANDS_COUNT);
+	EXPECT_EQ(left.size(), size_t(2));
+	EXPECT_TRUE(left[0] == "position startpos");
+	EXPECT_TRUE(left[1] == "stop");
+
+	return true;
+}
+
+template<> bool test<32>() {
+	constexpr auto testName = "SyzygyTest(probingTest)";
+
+	// The KQvK and KRvK tables in TestData/Syzygy, the expected results are the known ones for these endgames
+	const std::filesystem::path directory = std::filesystem::path(__FILE__).parent_path().parent_path() / "TestData" / "Syzygy";
+	EXPECT_TRUE(std::filesystem::exists(directory / "KQvK.rtbz"));
+
+	engine::Syzygy::init(directory.string());
+	EXPECT_EQ(engine::Syzygy::tablesCount(), size_t(2));
+
+	const std::tuple<const char*, engine::WDLScore, i32> positions[] = {
+		{ "7k/8/6K1/8/8/8/8/1Q6 w - - 0 1", engine::WDLScore::WIN, 1 }, // Qb8#
+		{ "k7/1Q6/1K6/8/8/8/8/8 b - - 0 1", engine::WDLScore::LOSS, -1 }, // Mate
+		{ "k7/2Q5/1K6/8/8/8/8/8 b - - 0 1", engine::WDLScore::DRAW, 0 }, // Stalemate
+		{ "8/8/8/3k4/3Q4/8/8/K7 b - - 0 1", engine::WDLScore::DRAW, 0 }, // Kxd4
+		{ "8/8/8/5k2/8/8/1Q6/K7 w - - 0 1", engine::WDLScore::WIN, 19 }, // The longest KQvK mate, in 10 moves
+		{ "k7/1q6/8/8/5K2/8/8/8 b - - 0 1", engine::WDLScore::WIN, 19 }, // The same with the colors swapped
+		{ "8/8/8/4k3/8/8/1R6/K7 w - - 0 1", engine::WDLScore::WIN, 31 }, // The longest KRvK mate, in 16 moves
+		{ "k7/8/1K6/8/8/8/8/7R b - - 0 1", engine::WDLScore::LOSS, -2 }, // Kb8 is forced, then Rh8#
+		{ "8/8/8/8/8/8/1R6/k1K5 b - - 0 1", engine::WDLScore::DRAW, 0 }, // Stalemate
+		{ "8/8/8/8/8/2k5/3R4/7K b - - 0 1", engine::WDLScore::DRAW, 0 } // Kxd2
+	};
+
+	bool success;
+	for (const auto& [fen, expectedWDL, expectedDTZ] : positions) {
+		Board board = Board::fromFEN(fen, success);
+		engine::WDLScore wdl;
+		i32 dtz;
+
+		EXPECT_TRUE(engine::Syzygy::probeWDL(board, wdl) && wdl == expectedWDL);
+		EXPECT_TRUE(engine::Syzygy::probeDTZ(board, dtz));
+		EXPECT_EQ(dtz, expectedDTZ);
+	}
+
+	// Only the moves that save the rook are kept at the root
+	Board board = Board::fromFEN("8/8/8/8/8/2k5/3R4/7K w - - 0 1", success);
+	MoveList moves;
+	board.generateMoves(moves);
+
+	MoveList legalMoves;
+	MoveList kept;
+	for (const Move m : moves) {
+		if (board.isLegal(m)) {
+			legalMoves.push(m);
+			kept.push(m);
+		}
+	}
+
+	EXPECT_TRUE(engine::Syzygy::filterRootMoves(board, kept));
+	EXPECT_TRUE(kept.size() > 0 && kept.size() < legalMoves.size());
+	for (const Move m : legalMoves) {
+		board.makeMove(m);
+		engine::WDLScore wdl;
+		EXPECT_TRUE(engine::Syzygy::probeWDL(board, wdl));
+		board.unmakeMove(m);
+
+		EXPECT_EQ(std::find(kept.begin(), kept.end(), m) != kept.end(), wdl == engine::WDLScore::LOSS);
+	}
+
+	// The search probes the tables after the capture and sees the win
+	const bool wasPostMode = options::g_postMode;
+	options::g_postMode = false;
+	engine::g_isInputChecked = false;
+
+	board = Board::fromFEN("8/8/8/4k3/8/8/1R4n1/K7 w - - 0 1", success);
+	engine::TranspositionTable::clear();
+	engine::initSearch();
+	engine::g_limits.makeInfinite();
+	engine::g_limits.setDepthLimit(4);
+
+	const engine::SearchResult result = engine::rootSearch(board);
+	EXPECT_EQ(result.best.toString(), std::string("b2g2"));
+	EXPECT_TRUE(result.value >= engine::TB_WIN - engine::MAX_DEPTH);
+	EXPECT_TRUE(engine::g_tbHits > 0);
+
+	engine::g_isInputChecked = true;
+	options::g_postMode = wasPostMode;
+
+	engine::Syzygy::init("");
+
+	return true;
+}
+
 template<u32 Id>
 void runTestsSequence() {
 	using namespace std::chrono;
@@ -282,5 +1596,5 @@ void runTestsSequence() {
 }
 
 void runTests() {
-	runTestsSequence<8>();
+	runTestsSequence<32>();
 }
\ No newline at end of file
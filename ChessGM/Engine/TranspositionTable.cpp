@@ -20,35 +20,58 @@
 #include <cstring>
 
 namespace engine {
-	TableEntryCluster* TranspositionTable::s_table = nullptr;
-	uint32_t TranspositionTable::s_tableSize = 0;
-	u16 TranspositionTable::s_rootAge = 0;
+	TableEntryCluster* TranspositionTable::s_memory = nullptr;
+	uint32_t TranspositionTable::s_memorySize = 0;
+	thread_local TableEntryCluster* TranspositionTable::s_table = nullptr;
+	thread_local uint32_t TranspositionTable::s_tableSize = 0;
+	thread_local u16 TranspositionTable::s_rootAge = 0;
 
 	void TranspositionTable::init() {
-		s_table = reinterpret_cast<TableEntryCluster*>(malloc(DEFAULT_TABLE_SIZE));
-		assert(s_table != nullptr);
+		s_memory = reinterpret_cast<TableEntryCluster*>(malloc(DEFAULT_TABLE_SIZE));
+		assert(s_memory != nullptr);
 
-		memset(s_table, 0, DEFAULT_TABLE_SIZE);
-		s_tableSize = DEFAULT_TABLE_SIZE / sizeof(TableEntryCluster);
+		memset(s_memory, 0, DEFAULT_TABLE_SIZE);
+		s_memorySize = DEFAULT_TABLE_SIZE / sizeof(TableEntryCluster);
+		useWholeTable();
 	}
 
 	void TranspositionTable::setSize(uint32_t size) {
 		uint32_t sizeInNodes = size / sizeof(TableEntryCluster);
-		if (s_tableSize == sizeInNodes) {
+		if (s_memorySize == sizeInNodes) {
+			useWholeTable();
 			return;
 		}
 
-		s_table = reinterpret_cast<TableEntryCluster*>(realloc(s_table, size));
-		memset(s_table, 0, DEFAULT_TABLE_SIZE);
+		s_memory = reinterpret_cast<TableEntryCluster*>(realloc(s_memory, size));
+		memset(s_memory, 0, size);
 
-		s_tableSize = sizeInNodes;
+		s_memorySize = sizeInNodes;
+		useWholeTable();
+	}
+
+	void TranspositionTable::useSlice(const u32 index, const u32 count) {
+		assert(index < count);
+
+		const uint32_t sliceSize = s_memorySize / count;
+		s_table = s_memory + size_t(sliceSize) * index;
+		s_tableSize = sliceSize;
+	}
+
+	void TranspositionTable::useWholeTable() {
+		s_table = s_memory;
+		s_tableSize = s_memorySize;
+	}
+
+	void TranspositionTable::clear() {
+		memset(s_table, 0, s_tableSize * sizeof(TableEntryCluster));
 	}
 
 	void TranspositionTable::destroy() { 
-		if (s_table) {
-			free(s_table);
-			s_table = nullptr;
-			s_tableSize = 0;
+		if (s_memory) {
+			free(s_memory);
+			s_memory = nullptr;
+			s_memorySize = 0;
+			useWholeTable();
 		}
 	}
 }
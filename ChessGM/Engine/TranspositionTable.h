@@ -19,6 +19,7 @@
 #pragma once
 #include "Chess/Defs.h"
 #include "Scores.h"
+#include "Utils/Profiler.h"
 
 /*
 *	TranspositionTable(.h/.cpp) contains the implementation of, well, transposition table.
@@ -75,15 +76,34 @@ namespace engine {
 		constexpr inline static uint32_t DEFAULT_TABLE_SIZE = 256 * 1024 * 1024;
 
 	private:
-		static TableEntryCluster* s_table;
-		static uint32_t s_tableSize;
-		static u16 s_rootAge;
+		// The whole allocated table
+		static TableEntryCluster* s_memory;
+		static uint32_t s_memorySize; // In clusters
+
+		// The part of the table the current thread works with (see useSlice), the whole table by default
+		// A thread other than the one that allocated the table must choose its part before the search
+		thread_local static TableEntryCluster* s_table;
+		thread_local static uint32_t s_tableSize;
+		thread_local static u16 s_rootAge;
 
 	public:
 		static void init();
 		static void setSize(uint32_t size);
 		static void destroy();
 
+		// Returns the table size in bytes
+		INLINE static uint32_t size() {
+			return s_memorySize * sizeof(TableEntryCluster);
+		}
+
+		// Makes the current thread use only the index-th of count equal parts of the table,
+		// so that the independent searches running in parallel do not share the entries
+		static void useSlice(const u32 index, const u32 count);
+		static void useWholeTable();
+
+		// Resets all the entries in the part of the table used by the current thread
+		static void clear();
+
 		INLINE static void setRootAge(const u16 age) {
 			s_rootAge = age;
 		}
@@ -91,6 +111,7 @@ namespace engine {
 		// Looks for the record in the table
 		// Returns an entry if it was found and nullptr otherwise
 		CM_PURE static TableEntry* probe(const Hash hash) noexcept {
+			PROFILE_ZONE(TT_PROBE);
 			assert(s_tableSize != 0);
 
 			TableEntryCluster* entry = &s_table[hash % s_tableSize];
@@ -111,6 +132,7 @@ namespace engine {
 			const u8 depth, 
 			const Depth ply
 		) {
+			PROFILE_ZONE(TT_STORE);
 			assert(s_tableSize != 0);
 
 			TableEntryCluster* entry = &s_table[hash % s_tableSize];
@@ -19,6 +19,7 @@
 #include "Tuning.h"
 #include <cmath>
 #include <random>
+#include <atomic>
 #include <fstream>
 #include <iomanip>
 
@@ -26,83 +27,71 @@
 #include "Utils/IO.h"
 #include "Eval.h"
 #include "PawnHashTable.h"
+#include "PgnReader.h"
 
 namespace engine {
-    void extractHeader(std::ifstream& pgn, std::string& initialFen, float &result) {
-        std::string line;
+    // The evaluation that corresponds to the winning probability of about 73%
+    constexpr double EVAL_SCALE = 190.0;
 
-        initialFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -"; // FEN by default
-        while (std::getline(pgn, line) && (line[0] == '[' || line.size() < 2)) {
-            if (line.starts_with("[Result")) {
-                if (line == "[Result \"1/2-1/2\"]") {
-                    result = 0.5f;
-                } else if (line == "[Result \"0-1\"]") {
-                    result = 0.f;
-                } else {
-                    result = 1.f;
-                }
-            } else if (line.starts_with("[FEN")) {
-                const size_t fenTo = line.find_last_of('"');
-                initialFen = line.substr(6, fenTo - 6);
-            }
-        }
+    CM_PURE double winningProbability(const double staticEval) {
+        return 1.0 / (1.0 + exp(-staticEval / EVAL_SCALE));
     }
 
-    void skipTillMoves(std::ifstream& pgn, std::string& line) {
-        while (std::getline(pgn, line) && line[0] != '1');
+    CM_PURE double squaredError(const Value staticEval, const float result) {
+        const double error = winningProbability(staticEval) - result;
+        return error * error;
     }
 
-    void extractMoves(
-        std::ifstream& pgn, 
-        std::string& line,
-        u32& movesCount,
-        const std::string& initialFen,
-        std::vector<std::string>& fens,
-        std::vector<u32>& fenMoveCounter
-    ) {
-        std::vector<std::string_view> moves;
-        bool success;
-        Board board = Board::fromFEN(initialFen, success);
+    // The evaluation of the position from white's POV
+    Value whiteEval(const PackedPosition& pos) {
+        thread_local Board s_board;
+        Board& board = s_board;
 
-        fens.clear();
-        fenMoveCounter.clear();
-        movesCount = 0;
-        if (!success) {
-            return;
+        pos.unpack(board);
+        const Value staticEval = eval(board);
+
+        return board.side() == Color::WHITE ? staticEval : -staticEval;
+    }
+
+    // Parses a line like "<fen> res 1.0; len 30;", the length is optional
+    bool parsePosition(const std::string& line, PackedPosition& pos) {
+        const size_t resPos = line.find("res");
+        if (resPos == std::string::npos || resPos + 6 >= line.size()) {
+            return false;
         }
 
-        bool wasQuiet = true; // Was the previous move quiet?
-        do {
-            moves = str_utils::split(line, ". \n\t", std::move(moves));
+        std::string fen = line.substr(0, resPos - 1);
+        float result = line[resPos + 4] == '1' 
+                ? 1.f 
+            : line[resPos + 6] == '5' 
+                ? 0.5f 
+                : 0.f;
 
-            for (auto& moveStr : moves) {
-                if (moveStr == "{") {
-                    std::getline(pgn, line);
-                    return;
-                }
+        u32 length = 0;
+        if (const size_t lenPos = line.find("len ", resPos); lenPos != std::string::npos) {
+            length = str_utils::fromString<u32>(std::string_view(line).substr(lenPos + 4));
+        }
 
-                if (std::isalpha(moveStr[0])) {
-                    Move m = board.makeMoveFromString(moveStr);
-                    if (m.isNullMove() || !board.isLegal(m)) {
-                        return;
-                    }
+        bool success;
+        Board board = Board::fromFEN(fen, success);
+        if (success) {
+            pos = PackedPosition::pack(board, result, length);
+        }
 
-                    if (!board.givesCheck(m) && board.isQuiet(m)) {
-                        if (!board.isInCheck() && wasQuiet) {
-                            fens.push_back(board.toFEN());
-                            fenMoveCounter.push_back(movesCount);
-                        }
+        return success;
+    }
 
-                        wasQuiet = true;
-                    } else {
-                        wasQuiet = false;
-                    }
+    // Evaluation of the traced position with the given weights (middlegame and endgame values interleaved)
+    CM_PURE double linearEval(const Tuning::TracedPosition& pos, const std::pair<u16, i16>* coefficients, const double* weights) {
+        double mg = 0.0;
+        double eg = 0.0;
+        for (u32 i = 0; i < pos.coefficientsCount; i++) {
+            const auto [index, coefficient] = coefficients[i];
+            mg += coefficient * weights[2 * index];
+            eg += coefficient * weights[2 * index + 1];
+        }
 
-                    ++movesCount;
-                    board.makeMove(m);
-                }
-            }
-        } while (std::getline(pgn, line) && line.size() > 1);
+        return pos.offset + mg * pos.phase + eg * (1.0 - pos.phase);
     }
 
     void Tuning::extractPositions(const std::string& pgnFileName, const std::string& positionsFileName) {
@@ -112,91 +101,159 @@ namespace engine {
             return;
         }
 
-        std::ifstream pgn(pgnFileName);
-        std::ofstream out(positionsFileName);
+        PgnReader pgn;
+        if (!pgn.open(pgnFileName)) {
+            return;
+        }
+
+        const bool isPacked = PackedPositions::hasExtension(positionsFileName);
+        std::ofstream out(positionsFileName, isPacked ? std::ios::binary : std::ios::out);
+        if (isPacked) {
+            PackedPositions::writeHeader(out);
+        }
+
         std::vector<std::string> fens;
+        std::vector<PackedPosition> packed;
         std::vector<u32> fenMoveCounters;
-        std::string initialFen;
-        std::string line;
-        float result;
-        u32 movesCount;
+        PgnGame game;
+
+        while (pgn.readGame(game)) {
+            bool success;
+            Board board = Board::fromFEN(game.initialFen, success);
+
+            fens.clear();
+            packed.clear();
+            fenMoveCounters.clear();
+
+            bool wasQuiet = true; // Was the previous move quiet?
+            const u32 movesCount = static_cast<u32>(game.moves.size());
+            for (u32 i = 0; i < movesCount; i++) {
+                const Move m = game.moves[i];
+                if (!board.givesCheck(m) && board.isQuiet(m)) {
+                    if (!board.isInCheck() && wasQuiet) {
+                        if (isPacked) {
+                            packed.push_back(PackedPosition::pack(board, game.result, movesCount - i));
+                        } else {
+                            fens.push_back(board.toFEN());
+                        }
+
+                        fenMoveCounters.push_back(i);
+                    }
 
-        while (!pgn.eof() && pgn.is_open() && pgn.good()) {
-            extractHeader(pgn, initialFen, result);
-            skipTillMoves(pgn, line);
-            extractMoves(pgn, line, movesCount, initialFen, fens, fenMoveCounters);
+                    wasQuiet = true;
+                } else {
+                    wasQuiet = false;
+                }
+
+                board.makeMove(m);
+            }
 
-            u32 step = static_cast<u32>((fens.size() <= FENS_PER_GAME) ? 1 : (fens.size() / FENS_PER_GAME));
+            const size_t count = fenMoveCounters.size();
+            u32 step = static_cast<u32>((count <= FENS_PER_GAME) ? 1 : (count / FENS_PER_GAME));
              
-            for (u32 i = 0; i < fens.size(); i += step) {
+            for (u32 i = 0; i < count; i += step) {
+                if (isPacked) {
+                    PackedPositions::write(out, packed[i]);
+                    continue;
+                }
+
                 u32 len = movesCount - fenMoveCounters[i];
-                out << fens[i] << " res " << result << "; len " << len << ";" << std::endl;
+                out << fens[i] << " res " << game.result << "; len " << len << ";" << std::endl;
             }
         }
     }
 
+    bool Tuning::convertPositions(const std::string& textFileName, const std::string& packedFileName) {
+        std::ifstream file(textFileName);
+        std::ofstream out(packedFileName, std::ios::binary);
+        if (!file || !out) {
+            return false;
+        }
+
+        PackedPositions::writeHeader(out);
+
+        std::string line;
+        PackedPosition pos;
+        while (std::getline(file, line)) {
+            if (parsePosition(line, pos)) {
+                PackedPositions::write(out, pos);
+            }
+        }
+
+        return bool(out);
+    }
+
     void Tuning::loadPositions(const std::string& fileName) {
+        m_loadedPositions.clear();
+        if (PackedPositions::map(fileName, m_positionsFile, m_positions, m_positionsCount)) {
+            return;
+        }
+
         std::ifstream file(fileName);
         std::string line;
+        PackedPosition pos;
 
         while (std::getline(file, line)) {
-            size_t resPos = line.find("res");
-            std::string fen = line.substr(0, resPos - 1);
-            float result = line[resPos + 4] == '1' 
-                    ? 1.f 
-                : line[resPos + 6] == '5' 
-                    ? 0.5f 
-                    : 0.f;
-            
-            bool success;
-            if (Board board = Board::fromFEN(fen, success); success) {
-                m_positions.emplace_back(Position { std::move(board), result });
+            if (parsePosition(line, pos)) {
+                m_loadedPositions.push_back(pos);
             }
         }
+
+        m_positions = m_loadedPositions.data();
+        m_positionsCount = m_loadedPositions.size();
     }
 
-    void Tuning::optimizeScores(const std::vector<Value*>& scores, u32 iterationsCount) {
-        double err = computeErr();
-        io::g_out << "Tuning begins, initial error: " << io::Color::Cyan << std::setprecision(10) << err << std::endl;
+    double Tuning::optimizeScores(const std::vector<u32>& weights, u32 iterationsCount) {
+        const auto printWeights = [&weights]() {
+            io::g_out << "Weights:" << std::endl;
+            for (const u32 weight : weights) {
+                const Score score = scores::Weights::get(weight);
+                io::g_out << "\t" << weight << ": S(" << score.middlegame() << ", " << score.endgame() << ")" << std::endl;
+            }
+        };
 
-        io::g_out << "Weights:" << std::endl;
-        for (Value* pScore : scores) {
-            io::g_out << "\t" << *pScore << std::endl;
-        }
+        buildWeightsIndex();
+
+        double err = sqrt(m_squaredErrorsSum / m_positionsCount);
+        io::g_out << "Tuning begins, initial error: " << io::Color::Cyan << std::setprecision(10) << err << std::endl;
+        printWeights();
 
         for (u32 iteration = 0; iteration < iterationsCount; iteration++) {
             double iterationInitialErr = err;
 
-            for (Value* pScore : scores) {
-                Value& score = *pScore;
-
-                // Trying to change the score for a step, decreasing the step on failure
-                Value step = iteration 
-                    ? (iteration == 1 
-                       ? 8 
-                       : 1) 
-                    : 32;
-
-                while (step) {
-                    // A step higher
-                    score += step;
-                    double tmp = computeErr();
-                    if (tmp < err) {
-                        err = tmp;
-                        continue;
-                    }
+            for (const u32 weight : weights) {
+                for (const bool isMiddlegame : { true, false }) {
+                    // Trying to change the score for a step, decreasing the step on failure
+                    Value step = iteration 
+                        ? (iteration == 1 
+                           ? 8 
+                           : 1) 
+                        : 32;
+
+                    while (step) {
+                        const Score score = scores::Weights::get(weight);
+                        const Score delta = isMiddlegame ? Score(step, 0) : Score(0, step);
+
+                        // A step higher
+                        double tmp = probeWeight(weight, score + delta);
+                        if (tmp < err) {
+                            acceptProbe(weight);
+                            err = tmp;
+                            continue;
+                        }
 
-                    // A step lower
-                    score -= step * 2;
-                    tmp = computeErr();
-                    if (tmp < err) {
-                        err = tmp;
-                        continue;
-                    }
+                        // A step lower
+                        tmp = probeWeight(weight, score - delta);
+                        if (tmp < err) {
+                            acceptProbe(weight);
+                            err = tmp;
+                            continue;
+                        }
 
-                    // Recovering the original score and decreasing the step
-                    score += step;
-                    step /= 2;
+                        // Recovering the original score and decreasing the step
+                        scores::Weights::set(weight, score);
+                        step /= 2;
+                    }
                 }
             }
 
@@ -208,32 +265,290 @@ namespace engine {
                 << ", error: " << io::Color::Cyan << std::setprecision(10) << err << "(-" << (iterationInitialErr - err) 
                 << ")" << std::endl;
 
-            io::g_out << "Weights:" << std::endl;
-            for (Value* pScore : scores) {
-                io::g_out << "\t" << *pScore << std::endl;
+            printWeights();
+        }
+
+        return err;
+    }
+
+    void Tuning::optimizeWeights(const u32 epochsCount, const double learningRate) {
+        constexpr double BETA1 = 0.9;
+        constexpr double BETA2 = 0.999;
+        constexpr double EPSILON = 1e-8;
+        constexpr u32 REPORT_PERIOD = 50;
+
+        const u32 weightsCount = scores::Weights::count();
+        const size_t n = m_positionsCount;
+        if (n == 0) {
+            return;
+        }
+
+        std::vector<double> weights(2 * weightsCount);
+        for (u32 i = 0; i < weightsCount; i++) {
+            const Score weight = scores::Weights::get(i);
+            weights[2 * i] = weight.middlegame();
+            weights[2 * i + 1] = weight.endgame();
+        }
+
+        tracePositions(weights);
+
+        // Each block of positions has its own gradient, they are added in the order of blocks
+        const size_t blocksCount = (n + ERR_BLOCK_SIZE - 1) / ERR_BLOCK_SIZE;
+        std::vector<double> blockGradients(blocksCount * weights.size());
+        std::vector<double> blockErrors(blocksCount);
+        std::vector<double> gradient(weights.size());
+        std::vector<double> moment(weights.size(), 0.0);
+        std::vector<double> velocity(weights.size(), 0.0);
+
+        io::g_out << "Tuning " << io::Color::Blue << weightsCount << io::Color::White << " weights on "
+            << io::Color::Blue << n << io::Color::White << " positions" << std::endl;
+
+        double err = 0.0;
+        for (u32 epoch = 0; epoch <= epochsCount; epoch++) {
+            std::atomic<size_t> nextBlock = 0;
+            m_pool->run([&](const u32) {
+                for (size_t block; (block = nextBlock.fetch_add(1, std::memory_order_relaxed)) < blocksCount;) {
+                    double* blockGradient = blockGradients.data() + block * weights.size();
+                    std::fill_n(blockGradient, weights.size(), 0.0);
+
+                    const size_t end = std::min(n, (block + 1) * ERR_BLOCK_SIZE);
+                    double blockError = 0.0;
+                    for (size_t i = block * ERR_BLOCK_SIZE; i < end; i++) {
+                        const TracedPosition& pos = m_traced[i];
+                        const std::pair<u16, i16>* coefficients = m_coefficients.data() + pos.firstCoefficient;
+
+                        const double probability = winningProbability(linearEval(pos, coefficients, weights.data()));
+                        const double error = probability - pos.result;
+                        blockError += error * error;
+
+                        // The derivative of the squared error by the evaluation, without the constant factor
+                        const double derivative = error * probability * (1.0 - probability);
+                        for (u32 j = 0; j < pos.coefficientsCount; j++) {
+                            const auto [index, coefficient] = coefficients[j];
+                            blockGradient[2 * index] += derivative * coefficient * pos.phase;
+                            blockGradient[2 * index + 1] += derivative * coefficient * (1.0 - pos.phase);
+                        }
+                    }
+
+                    blockErrors[block] = blockError;
+                }
+            });
+
+            std::fill(gradient.begin(), gradient.end(), 0.0);
+            err = 0.0;
+            for (size_t block = 0; block < blocksCount; block++) {
+                err += blockErrors[block];
+                for (size_t i = 0; i < weights.size(); i++) {
+                    gradient[i] += blockGradients[block * weights.size() + i];
+                }
+            }
+
+            err = sqrt(err / n);
+            if (epoch % REPORT_PERIOD == 0 || epoch == epochsCount) {
+                io::g_out << "Epoch " << io::Color::Blue << epoch << io::Color::White
+                    << ", error: " << io::Color::Cyan << std::setprecision(10) << err << std::endl;
+            }
+
+            if (epoch == epochsCount) {
+                break;
+            }
+
+            // Adam step
+            const double gradientFactor = 2.0 / (EVAL_SCALE * n);
+            const double moment1Correction = 1.0 - pow(BETA1, epoch + 1);
+            const double moment2Correction = 1.0 - pow(BETA2, epoch + 1);
+            for (size_t i = 0; i < weights.size(); i++) {
+                const double g = gradient[i] * gradientFactor;
+                moment[i] = BETA1 * moment[i] + (1.0 - BETA1) * g;
+                velocity[i] = BETA2 * velocity[i] + (1.0 - BETA2) * g * g;
+                weights[i] -= learningRate * (moment[i] / moment1Correction) / (sqrt(velocity[i] / moment2Correction) + EPSILON);
+            }
+        }
+
+        for (u32 i = 0; i < weightsCount; i++) {
+            scores::Weights::set(i, Score(Value(std::lround(weights[2 * i])), Value(std::lround(weights[2 * i + 1]))));
+        }
+    }
+
+    void Tuning::tracePositions(const std::vector<double>& weights) {
+        const size_t n = m_positionsCount;
+        const size_t blocksCount = (n + ERR_BLOCK_SIZE - 1) / ERR_BLOCK_SIZE;
+        std::vector<std::vector<std::pair<u16, i16>>> blockCoefficients(blocksCount);
+        std::atomic<size_t> nextBlock = 0;
+
+        m_traced.resize(n);
+        m_pool->run([&](const u32) {
+            PawnHashTable::reset();
+            EvalTrace trace;
+            Board board;
+
+            for (size_t block; (block = nextBlock.fetch_add(1, std::memory_order_relaxed)) < blocksCount;) {
+                const size_t end = std::min(n, (block + 1) * ERR_BLOCK_SIZE);
+                std::vector<std::pair<u16, i16>>& coefficients = blockCoefficients[block];
+
+                for (size_t i = block * ERR_BLOCK_SIZE; i < end; i++) {
+                    const PackedPosition& pos = m_positions[i];
+                    pos.unpack(board);
+                    traceEval(board, trace);
+
+                    Value staticEval = eval(board);
+                    staticEval = board.side() == Color::WHITE ? staticEval : -staticEval; // Always consider from white POV
+
+                    TracedPosition& traced = m_traced[i];
+                    traced.firstCoefficient = u32(coefficients.size()); // Relative to the block for now
+                    traced.coefficientsCount = u32(trace.coefficients.size());
+                    traced.phase = trace.phase;
+                    traced.result = pos.gameResult();
+                    traced.isLinear = trace.isLinear;
+                    traced.offset = 0.f;
+                    traced.offset = float(staticEval - linearEval(traced, trace.coefficients.data(), weights.data()));
+
+                    coefficients.insert(coefficients.end(), trace.coefficients.begin(), trace.coefficients.end());
+                }
+            }
+        });
+
+        m_coefficients.clear();
+        for (size_t block = 0; block < blocksCount; block++) {
+            const u32 blockBegin = u32(m_coefficients.size());
+            const size_t end = std::min(n, (block + 1) * ERR_BLOCK_SIZE);
+            for (size_t i = block * ERR_BLOCK_SIZE; i < end; i++) {
+                m_traced[i].firstCoefficient += blockBegin;
+            }
+
+            m_coefficients.insert(m_coefficients.end(), blockCoefficients[block].begin(), blockCoefficients[block].end());
+            blockCoefficients[block] = { };
+        }
+    }
+
+    void Tuning::buildWeightsIndex() {
+        const u32 weightsCount = scores::Weights::count();
+        const size_t n = m_positionsCount;
+
+        std::vector<double> weights(2 * weightsCount);
+        for (u32 i = 0; i < weightsCount; i++) {
+            const Score weight = scores::Weights::get(i);
+            weights[2 * i] = weight.middlegame();
+            weights[2 * i + 1] = weight.endgame();
+        }
+
+        tracePositions(weights);
+
+        m_weightPositions.assign(weightsCount, { });
+        m_nonlinearPositions.clear();
+        m_evals.resize(n);
+        m_squaredErrorsSum = 0.0;
+
+        for (u32 i = 0; i < n; i++) {
+            const TracedPosition& pos = m_traced[i];
+            if (!pos.isLinear) {
+                m_nonlinearPositions.push_back(i);
+            }
+
+            for (u32 j = 0; j < pos.coefficientsCount; j++) {
+                m_weightPositions[m_coefficients[pos.firstCoefficient + j].first].push_back(i);
             }
+
+            // With the initial weights, it is the evaluation itself
+            m_evals[i] = Value(std::lround(linearEval(pos, m_coefficients.data() + pos.firstCoefficient, weights.data())));
+            m_squaredErrorsSum += squaredError(m_evals[i], pos.result);
         }
+
+        // The coefficients are not needed anymore
+        m_traced = { };
+        m_coefficients = { };
+    }
+
+    double Tuning::probeWeight(const u32 weight, const Score value) {
+        const std::vector<u32>& positions = m_weightPositions[weight];
+        const size_t count = positions.size() + m_nonlinearPositions.size();
+        const size_t blocksCount = (count + ERR_BLOCK_SIZE - 1) / ERR_BLOCK_SIZE;
+        const auto positionAt = [&](const size_t i) {
+            return i < positions.size() ? positions[i] : m_nonlinearPositions[i - positions.size()];
+        };
+
+        scores::Weights::set(weight, value);
+        m_probeEvals.resize(count);
+
+        std::vector<double> blockDeltas(blocksCount, 0.0);
+        std::atomic<size_t> nextBlock = 0;
+        m_pool->run([&](const u32) {
+            PawnHashTable::reset(); // The pawn structure weights are cached in the table
+
+            for (size_t block; (block = nextBlock.fetch_add(1, std::memory_order_relaxed)) < blocksCount;) {
+                const size_t end = std::min(count, (block + 1) * ERR_BLOCK_SIZE);
+                double blockDelta = 0.0;
+
+                for (size_t i = block * ERR_BLOCK_SIZE; i < end; i++) {
+                    const u32 index = positionAt(i);
+                    const PackedPosition& pos = m_positions[index];
+                    const Value staticEval = whiteEval(pos);
+
+                    m_probeEvals[i] = staticEval;
+                    blockDelta += squaredError(staticEval, pos.gameResult()) - squaredError(m_evals[index], pos.gameResult());
+                }
+
+                blockDeltas[block] = blockDelta;
+            }
+        });
+
+        m_probeSquaredErrorsSum = m_squaredErrorsSum;
+        for (const double blockDelta : blockDeltas) {
+            m_probeSquaredErrorsSum += blockDelta;
+        }
+
+        return sqrt(std::max(m_probeSquaredErrorsSum, 0.0) / m_positionsCount);
+    }
+
+    void Tuning::acceptProbe(const u32 weight) {
+        const std::vector<u32>& positions = m_weightPositions[weight];
+        for (size_t i = 0; i < m_probeEvals.size(); i++) {
+            m_evals[i < positions.size() ? positions[i] : m_nonlinearPositions[i - positions.size()]] = m_probeEvals[i];
+        }
+
+        m_squaredErrorsSum = m_probeSquaredErrorsSum;
     }
 
     double Tuning::computeErr() {
-        double result = 0.0;
-        size_t n = 0;
+        const size_t n = m_positionsCount;
+        const size_t blocksCount = (n + ERR_BLOCK_SIZE - 1) / ERR_BLOCK_SIZE;
+        std::vector<double> blockErrors(blocksCount, 0.0);
+        std::atomic<size_t> nextBlock = 0;
+
+        m_pool->run([&](const u32) {
+            PawnHashTable::reset(); // The pawn weights might have changed since the last call
 
-        PawnHashTable::reset();
+            for (size_t block; (block = nextBlock.fetch_add(1, std::memory_order_relaxed)) < blocksCount;) {
+                const size_t end = std::min(n, (block + 1) * ERR_BLOCK_SIZE);
+                double blockError = 0.0;
 
-        for (Position& pos : m_positions) {
-            ++n;
-            Value staticEval = eval(pos.board);
-            staticEval = pos.board.side() == Color::WHITE ? staticEval : -staticEval; // Always consider from white POV
+                for (size_t i = block * ERR_BLOCK_SIZE; i < end; i++) {
+                    const PackedPosition& pos = m_positions[i];
+                    const Value staticEval = whiteEval(pos);
 
-            // The expected result probability  
-            const double resultProbability = 1.0 / (1.0 + exp(-staticEval / 190.0));
-            const double error = resultProbability - pos.result;
+                    // The expected result probability  
+                    const double resultProbability = winningProbability(staticEval);
+                    const double error = resultProbability - pos.gameResult();
 
-            result += error * error;
+                    blockError += error * error;
+                }
+
+                blockErrors[block] = blockError;
+            }
+        });
+
+        double result = 0.0;
+        for (const double blockError : blockErrors) {
+            result += blockError;
         }
 
         result /= n;
         return sqrt(result);
     }
+
+    void Tuning::setThreadsCount(const u32 threadsCount) {
+        if (threadsCount != m_pool->threadsCount()) {
+            m_pool = std::make_unique<ThreadPool>(std::max<u32>(threadsCount, 1));
+        }
+    }
 }
\ No newline at end of file
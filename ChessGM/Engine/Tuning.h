@@ -17,39 +17,102 @@
 */
 
 #pragma once
+#include <memory>
 #include "Chess/Board.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/MappedFile.h"
+#include "PackedPosition.h"
 
 /*
 *	Tuning(.h/.cpp) contains the functions to tune the evaluation function' weights.
 * 
-*	Currently it has no automated tuning.
+*	There are 2 ways of tuning:
+*		1) Local search (optimizeScores) over the given weights. The positions are indexed by the weights
+*		   their evaluation depends on, so each probe re-evaluates only the positions affected by the weight
+*		   and updates the sum of squared errors incrementally.
+*		2) Gradient descent (optimizeWeights) over all the weights from scores::Weights. The evaluation
+*		   of each position is traced once as the coefficients of the weights, and then Adam
+*		   uses the analytic gradient of the error without any evaluation calls.
+* 
+*	The positions are stored as PackedPosition's, either memory mapped from a file of packed positions
+*	or converted from the text file, and each one is unpacked into a board only to be evaluated.
 */
 
 namespace engine {
 	class Tuning final {
 	public:
-		// A single position from a file
-		struct Position {
-			Board board;
-			float result; // Either of 0.0, 0.5, or 1.0
+		// A position traced for the gradient tuning, its coefficients are stored in m_coefficients
+		struct TracedPosition {
+			u32 firstCoefficient;
+			u32 coefficientsCount;
+			float phase;
+			float offset; // The evaluation from white's POV minus the sum of the initial weights
+			float result;
+			bool isLinear;
 		};
 
+		// The positions are evaluated in blocks of that size, the partial sums are added in the order of blocks,
+		// so that the error does not depend on the threads count
+		constexpr inline static size_t ERR_BLOCK_SIZE = 4096;
+
 	private:
-		std::vector<Position> m_positions;
+		const PackedPosition* m_positions = nullptr; // Either mapped from a file or m_loadedPositions
+		size_t m_positionsCount = 0;
+		MappedFile m_positionsFile;
+		std::vector<PackedPosition> m_loadedPositions;
+		std::unique_ptr<ThreadPool> m_pool = std::make_unique<ThreadPool>(1);
+
+		std::vector<TracedPosition> m_traced;
+		std::vector<std::pair<u16, i16>> m_coefficients;
+
+		// The local search state: the positions that depend on each weight and the cached evaluations
+		std::vector<std::vector<u32>> m_weightPositions;
+		std::vector<u32> m_nonlinearPositions; // Might depend on any weight
+		std::vector<Value> m_evals; // From white's POV
+		std::vector<Value> m_probeEvals; // The evaluations of the affected positions in the last probe
+		double m_squaredErrorsSum = 0.0;
+		double m_probeSquaredErrorsSum = 0.0;
 
 	public:
 		// Extracts a set of positions from the given pgn file
 		// <pgnFileName> has no supposed extension, so it must be given explicitly
-		// It works not with a true pgn, but rather with a pgn where moves were translated into long algebraic form
+		// The positions are packed if <positionsFileName> has PackedPositions::EXTENSION, otherwise they are written as text
 		static void extractPositions(const std::string& pgnFileName, const std::string& positionsFileName = "test_suit.fen");
 
-		// Loads an epd file with: fen, res (result)
+		// Converts the text file of positions (see loadPositions) into a file of packed positions
+		static bool convertPositions(const std::string& textFileName, const std::string& packedFileName);
+
+		// Maps a file of packed positions or loads an epd file with: fen, res (result), len (plies till the end)
 		void loadPositions(const std::string& fileName);
 
-		// Tries to optimize the given scores by minimizing the error with coordinate descent
-		void optimizeScores(const std::vector<Value*>& scores, u32 iterationsCount);
+		CM_PURE size_t positionsCount() const noexcept {
+			return m_positionsCount;
+		}
+
+		// Tries to optimize the given weights (indices in scores::Weights) by minimizing the error with coordinate descent,
+		// returns the final error
+		double optimizeScores(const std::vector<u32>& weights, u32 iterationsCount);
+
+		// Tunes all the weights from scores::Weights with Adam on the traced evaluations and sets the result
+		void optimizeWeights(u32 epochsCount, double learningRate = 1.0);
 
 		// Computes the mean error with the current evaluation function
 		double computeErr();
+
+		// Sets the number of threads used by computeErr
+		void setThreadsCount(u32 threadsCount);
+
+	private:
+		// Fills m_traced and m_coefficients for the loaded positions
+		void tracePositions(const std::vector<double>& weights);
+
+		// Traces the positions and fills the local search state
+		void buildWeightsIndex();
+
+		// Sets the weight and re-evaluates the positions that depend on it, returns the resulting error
+		double probeWeight(u32 weight, Score value);
+
+		// Keeps the value of the last probe
+		void acceptProbe(u32 weight);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Watchdog.h"
+#include <chrono>
+#include <algorithm>
+
+namespace engine {
+	std::vector<Watchdog::Alarm> Watchdog::s_alarms;
+	bool Watchdog::s_areAlarmsChanged = false;
+	std::mutex Watchdog::s_mutex;
+	std::condition_variable_any Watchdog::s_wakeUp;
+	std::jthread Watchdog::s_thread;
+
+	void Watchdog::init() {
+		s_thread = std::jthread(run);
+	}
+
+	void Watchdog::destroy() {
+		s_thread.request_stop();
+		if (s_thread.joinable()) {
+			s_thread.join();
+		}
+
+		s_alarms.clear();
+	}
+
+	void Watchdog::set(std::atomic_bool& flag, const time_t deadline) {
+		{
+			std::lock_guard lock(s_mutex);
+			std::erase_if(s_alarms, [&flag](const Alarm& alarm) { return alarm.flag == &flag; });
+			if (deadline != INT64_MAX) {
+				s_alarms.push_back(Alarm { &flag, deadline });
+			}
+
+			s_areAlarmsChanged = true;
+		}
+
+		s_wakeUp.notify_one();
+	}
+
+	void Watchdog::clear(std::atomic_bool& flag) {
+		set(flag, INT64_MAX);
+	}
+
+	void Watchdog::run(std::stop_token stopToken) {
+		using namespace std::chrono;
+
+		std::unique_lock lock(s_mutex);
+		while (!stopToken.stop_requested()) {
+			const time_t now = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+
+			// Raising the flags whose time has come
+			time_t nextDeadline = INT64_MAX;
+			std::erase_if(s_alarms, [now, &nextDeadline](const Alarm& alarm) {
+				if (alarm.deadline <= now) {
+					alarm.flag->store(true, std::memory_order_relaxed);
+					return true;
+				}
+
+				nextDeadline = std::min(nextDeadline, alarm.deadline);
+				return false;
+			});
+
+			// Sleeping till the next deadline or a change of the alarms
+			s_areAlarmsChanged = false;
+			if (nextDeadline == INT64_MAX) {
+				s_wakeUp.wait(lock, stopToken, [] { return s_areAlarmsChanged; });
+			} else {
+				s_wakeUp.wait_until(lock, stopToken, steady_clock::time_point(milliseconds(nextDeadline)), [] { return s_areAlarmsChanged; });
+			}
+		}
+	}
+}
@@ -0,0 +1,62 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "Utils/Types.h"
+
+/*
+*	Watchdog(.h/.cpp) contains a timer thread that stops the searches at their hard time limits.
+* 
+*	Each search sets an alarm for its stop flag, and the watchdog raises the flag once the time comes,
+*	so the search does not have to read the clock and just checks the flag as it always does.
+*	The deadlines are in the milliseconds of the steady clock, as in Limits.
+*/
+
+namespace engine {
+	class Watchdog final {
+	private:
+		struct Alarm final {
+			std::atomic_bool* flag;
+			time_t deadline;
+		};
+
+		static std::vector<Alarm> s_alarms;
+		static bool s_areAlarmsChanged;
+		static std::mutex s_mutex;
+		static std::condition_variable_any s_wakeUp;
+		static std::jthread s_thread; // Stopped and joined on destruction as well, so it is fine to exit() anywhere
+
+	public:
+		static void init();
+		static void destroy();
+
+		// Sets the flag at the deadline, replacing the previous alarm of the flag
+		// INT64_MAX as the deadline just removes the alarm
+		static void set(std::atomic_bool& flag, const time_t deadline);
+		static void clear(std::atomic_bool& flag);
+
+	private:
+		static void run(std::stop_token stopToken);
+	};
+}
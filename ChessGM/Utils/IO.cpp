@@ -18,11 +18,10 @@
 
 #include "IO.h"
 #include <cassert>
-#include <queue>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
-#include <conio.h>
 #else
 #include <term.h>
 #include <unistd.h>
@@ -32,7 +31,9 @@
 
 #include "ChessGMInfo.h"
 #include "StringUtils.h"
+#include "SpscQueue.h"
 #include "Engine/TranspositionTable.h"
+#include "Engine/Search.h"
 
 ///  GLOBAL VARIABLES  ///
 
@@ -51,8 +52,18 @@ HANDLE g_handle = 0;
 
 bool g_isPipe = false;
 
-// The commands that were read but not processed right away
-std::queue<std::pair<std::string, std::vector<std::string>>> g_queuedCommands;
+// A line read by the input thread
+struct QueuedCommand final {
+	std::string line;
+	bool isUrgent = false;
+	bool isHandled = false; // The urgent command was handled during the search, so it is just dropped
+};
+
+// The commands read by the input thread and not taken by the engine yet
+SpscQueue<QueuedCommand, 256> g_queuedCommands;
+bool g_isInputThreadStarted = false;
+
+std::atomic<u32> io::g_urgentCommands = 0;
 
 
 ///  FUNCTIONS   ///
@@ -83,13 +94,22 @@ void initForXboard() {
 	io::g_out << "feature ping=1, setboard=1, playother=0, san=0, usermove=1, time=1, draw=1, reuse=1, analyze=1, myname=\""
 		<< ENGINE_NAME << " " << ENGINE_VERSION << " by " << AUTHOR_NAME << "\"" << std::endl
 		<< "feature variants=\"normal\"" << std::endl
-		<< "feature ics=1, name=1, pause=1, colors=0, nps=1, done=1" << std::endl;
+		<< "feature egt=\"syzygy\"" << std::endl
+		<< "feature option=\"OwnBook -check 0\"" << std::endl
+		<< "feature option=\"BookFile -file \"" << std::endl
+		<< "feature ics=1, name=1, pause=1, colors=0, nps=1, smp=1, done=1" << std::endl;
 }
 
 void initForUCI() {
 	io::g_out << "id name " << ENGINE_NAME << " " << ENGINE_VERSION << std::endl
 		<< "id author " << AUTHOR_NAME << std::endl
-		<< "option name Hash type spin default " << (engine::TranspositionTable::DEFAULT_TABLE_SIZE >> 20) << " min 1 max 4096" << std::endl;
+		<< "option name Hash type spin default " << (engine::TranspositionTable::DEFAULT_TABLE_SIZE >> 20) << " min 1 max 4096" << std::endl
+		<< "option name Threads type spin default 1 min 1 max " << engine::MAX_THREADS_COUNT << std::endl
+		<< "option name Ponder type check default false" << std::endl
+		<< "option name SyzygyPath type string default <empty>" << std::endl
+		<< "option name BitbasePath type string default <empty>" << std::endl
+		<< "option name OwnBook type check default false" << std::endl
+		<< "option name BookFile type string default <empty>" << std::endl;
 	io::g_out << "uciok" << std::endl;
 }
 
@@ -161,14 +181,95 @@ void io::init() {
 	}
 }
 
-void io::pushCommand(std::string cmd, std::vector<std::string> args) {
-	g_queuedCommands.push(std::make_pair<std::string, std::vector<std::string>>(std::move(cmd), std::move(args)));
+// Splits the line into the command and the arguments
+std::string parseCommand(const std::string& line, std::vector<std::string>& args) {
+	size_t i = 0;
+
+	args.clear();
+
+	// Command
+	while (i < line.size() && !isspace(line[i])) i++;
+	std::string cmd = line.substr(0, i);
+
+	// Arguments
+	size_t from = i; // The character after the previous whitespace
+	while (i < line.size()) {
+		// Skipping whitespaces
+		while (i < line.size() && isspace(line[i])) from = ++i;
+		while (i < line.size() && !isspace(line[i])) ++i;
+
+		if (i != from) {
+			args.emplace_back(line.substr(from, i - from));
+		}
+	}
+
+	return cmd;
+}
+
+void readInput(bool (*isUrgent)(std::string_view cmd)) {
+	QueuedCommand command;
+	while (std::getline(std::cin, command.line)) {
+		command.isUrgent = isUrgent(std::string_view(command.line).substr(0, command.line.find_first_of(" \t\r")));
+
+		// Counted before it is pushed, so that the counter never goes below the number of urgent commands in the queue
+		if (command.isUrgent) {
+			io::g_urgentCommands.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		g_queuedCommands.push(std::move(command));
+		command = QueuedCommand();
+	}
+
+	// The input is closed, so the engine quits once it is done with the commands it got
+	g_queuedCommands.push(QueuedCommand { "quit" });
+}
+
+// Removes the urgent commands that were handled during the search, so that they do not fill the queue
+void dropHandledCommands() {
+	g_queuedCommands.removeIf([](const QueuedCommand& command) { return command.isHandled; });
+}
+
+void io::startInputThread(bool (*isUrgent)(std::string_view cmd)) {
+	g_isInputThreadStarted = true;
+
+	// It is blocked in reading most of the time, so it is never joined
+	std::thread(readInput, isUrgent).detach();
+}
+
+bool io::isInputThreadStarted() {
+	return g_isInputThreadStarted;
 }
 
 bool io::hasCommandsInQueue() {
+	dropHandledCommands();
 	return !g_queuedCommands.empty();
 }
 
+bool io::checkUrgentCommands(bool (*check)(const std::string& cmd, const std::vector<std::string>& args)) {
+	bool isAnyLeft = false;
+	std::vector<std::string> args;
+
+	g_queuedCommands.forEach([&](QueuedCommand& command) {
+		if (!command.isUrgent || command.isHandled) {
+			return;
+		}
+
+		const std::string cmd = parseCommand(command.line, args);
+		if (check(cmd, args)) {
+			Output::logInput(command.line);
+			command.isHandled = true;
+			g_urgentCommands.fetch_sub(1, std::memory_order_relaxed);
+		} else {
+			isAnyLeft = true;
+		}
+	});
+
+	// Otherwise a long search answering many commands (e.g. isready) would block the input thread in a full queue
+	dropHandledCommands();
+
+	return isAnyLeft;
+}
+
 std::string_view io::getLine() {
 	std::getline(std::cin, g_cmd);
 	Output::logInput(g_cmd);
@@ -176,47 +277,34 @@ std::string_view io::getLine() {
 	return g_cmd;
 }
 
-std::string io::getCommand(std::vector<std::string>& args, const bool lookInQueue) {
-	if (lookInQueue && !g_queuedCommands.empty()) { // We have some unhandled commands
-		auto [cmd, _args] = std::move(g_queuedCommands.front());
-		g_queuedCommands.pop();
-
-		args = std::move(_args);
-		return cmd;
-	}
-
-	if (g_mode == IOMode::CONSOLE) {
-		std::cout << ">>> ";
-	}
+std::string io::getCommand(std::vector<std::string>& args) {
+	if (!g_isInputThreadStarted) {
+		if (g_mode == IOMode::CONSOLE) {
+			std::cout << ">>> ";
+		}
 
-	getLine();
-	size_t i = 0;
+		getLine();
+	} else {
+		dropHandledCommands();
+		if (g_mode == IOMode::CONSOLE && g_queuedCommands.empty()) {
+			std::cout << ">>> ";
+		}
 
-	args.clear();
+		g_queuedCommands.wait();
 
-	// Command
-	while (i < g_cmd.size() && !isspace(g_cmd[i])) i++;
-	std::string cmd = g_cmd.substr(0, i);
-	g_allArguments = "";
+		QueuedCommand& command = g_queuedCommands.front();
+		if (command.isUrgent) {
+			g_urgentCommands.fetch_sub(1, std::memory_order_relaxed);
+		}
 
-	// Check if the command has no arguments
-	if (i >= g_cmd.size()) {
-		return cmd;
+		g_cmd = std::move(command.line);
+		g_queuedCommands.pop();
+		Output::logInput(g_cmd);
 	}
 
-	// Arguments
-	size_t from = i; // The character after the previous whitespace
-	while (i < g_cmd.size()) {
-		// Skipping whitespaces
-		while (i < g_cmd.size() && isspace(g_cmd[i])) from = ++i;
-		while (i < g_cmd.size() && !isspace(g_cmd[i])) ++i;
+	std::string cmd = parseCommand(g_cmd, args);
+	g_allArguments = cmd.size() < g_cmd.size() ? g_cmd.substr(cmd.size() + 1) : "";
 
-		if (i != from) {
-			args.emplace_back(g_cmd.substr(from, i - from));
-		}
-	}
-
-	g_allArguments = g_cmd.substr(cmd.size() + 1);
 	return cmd;
 }
 
@@ -233,32 +321,3 @@ u32 io::getXboardVersion() {
 
 	return g_xboardVersion;
 }
-
-bool io::hasInput() {
-#ifdef _WIN32
-	if (g_isPipe) {
-		DWORD charsNumber = 0;
-		return PeekNamedPipe(g_handle, nullptr, 0, nullptr, &charsNumber, nullptr) ? bool(charsNumber) : true;
-	} else {
-		return bool(_kbhit());
-	}
-#else // Found it somewhere once since I am not familiar with linux system functions
-	static fd_set input_fd_set;
-	static fd_set except_fd_set;
-
-	FD_ZERO(&input_fd_set);
-	FD_ZERO(&except_fd_set);
-	FD_SET(0, &input_fd_set);
-	FD_SET(1, &except_fd_set);
-
-	static timeval timeout;
-	static int max_fd = 2;
-
-	timeout.tv_sec = timeout.tv_usec = 0;
-	if (select(max_fd, &input_fd_set, NULL, &except_fd_set, &timeout) <= 0) {
-		return false;
-	}
-
-	return FD_ISSET(0, &input_fd_set);
-#endif
-}
\ No newline at end of file
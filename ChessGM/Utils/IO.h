@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <atomic>
 #include <fstream>
 
 #include "ConsoleColor.h"
@@ -30,6 +31,10 @@
 * 
 *	It initializes I/O, requests the working mode (own console / XBoard / UCI), and then just
 *	provides some simple interface for using I/O.
+* 
+*	Once the engine runs, the input is read by a dedicated thread that puts the commands into a lock-free
+*	queue for the engine. The commands that must be seen during the search (stop, isready...) are marked
+*	as urgent and counted in an atomic, so that the search only has to load it once in a while.
 */
 
 namespace io {
@@ -74,23 +79,36 @@ namespace io {
 
 	void init();
 
-	// Pushes a command into the queue
-	void pushCommand(std::string cmd, std::vector<std::string> args);
+	// Starts the thread that reads the input, after that the commands are only taken from the queue
+	// isUrgent is called by that thread for each command to tell if it must be seen by the search right away
+	void startInputThread(bool (*isUrgent)(std::string_view cmd));
+
+	// After the input thread is started, stdin must not be read by anything else
+	bool isInputThreadStarted();
+
 	bool hasCommandsInQueue();
 
+	// The number of urgent commands in the queue that are not handled yet
+	extern std::atomic<u32> g_urgentCommands;
+
+	CM_PURE inline bool hasUrgentCommands() noexcept {
+		return g_urgentCommands.load(std::memory_order_relaxed) != 0;
+	}
+
+	// Called by the engine thread during a search, calls check(cmd, args) for each urgent command in the queue
+	// If check returns true, the command is handled and removed from the queue, otherwise it is left there
+	// Returns true if any urgent command is left, so the search must stop to let it be handled
+	bool checkUrgentCommands(bool (*check)(const std::string& cmd, const std::vector<std::string>& args));
+
 	std::string_view getLine();
 
 	// Requests a command from console and parses it
 	// Returns the command and puts its arguments into <args>
-	// If lookInQueue is true, then it first checks if there are any commands in the queue
-	// It can return then the first command in queue, otherwise it processes input
-	std::string getCommand(std::vector<std::string>& args, const bool lookInQueue = true);
+	// Once the input thread is started, it waits for the next command in the queue
+	std::string getCommand(std::vector<std::string>& args);
 
 	// Returns the arguments as a single string
 	std::string_view getAllArguments() noexcept;
 	IOMode getMode();
 	u32 getXboardVersion();
-
-	// Checks if there is any input available
-	bool hasInput();
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+
+#ifdef _WIN32
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif // _WIN32
+	}
+
+	return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) {
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_data = static_cast<const u8*>(data);
+	m_size = size_t(size.QuadPart);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) == -1 || info.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+#ifdef MADV_RANDOM
+	madvise(data, size_t(info.st_size), MADV_RANDOM);
+#endif // MADV_RANDOM
+
+	m_data = static_cast<const u8*>(data);
+	m_size = size_t(info.st_size);
+#endif // _WIN32
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (!m_data) {
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	munmap(const_cast<u8*>(m_data), m_size);
+#endif // _WIN32
+
+	m_data = nullptr;
+	m_size = 0;
+}
@@ -0,0 +1,65 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <string>
+
+#include "Types.h"
+
+/*
+*	MappedFile(.h/.cpp) contains a read-only memory mapped file.
+* 
+*	It is used for the large data files (tablebases and so on) that must not be read
+*	into memory as a whole, so that the OS loads only the pages that are accessed.
+*/
+
+class MappedFile final {
+private:
+	const u8* m_data = nullptr;
+	size_t m_size = 0;
+
+#ifdef _WIN32
+	void* m_mapping = nullptr;
+#endif // _WIN32
+
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	~MappedFile();
+
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// Maps the whole file, returns false if the file cannot be opened or mapped
+	bool open(const std::string& path);
+	void close();
+
+	CM_PURE bool isOpen() const noexcept {
+		return m_data != nullptr;
+	}
+
+	CM_PURE const u8* data() const noexcept {
+		return m_data;
+	}
+
+	CM_PURE size_t size() const noexcept {
+		return m_size;
+	}
+};
@@ -0,0 +1,111 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Profiler.h"
+#include <mutex>
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+
+#include "IO.h"
+
+namespace profiler {
+	constexpr const char* ZONE_NAMES[ZONES_COUNT] = {
+		"movegen", "makeMove", "unmakeMove", "eval", "pawn scan", "SEE", 
+		"TT probe", "TT store", "move scoring", "move picking", "checkInput"
+	};
+
+	thread_local ZoneStats g_zoneStats[ZONES_COUNT];
+	thread_local bool g_isThreadRegistered = false;
+
+	std::mutex s_threadsMutex;
+	std::vector<ZoneStats*> s_threads; // The counters of the running threads
+	ZoneStats s_finishedThreads[ZONES_COUNT]; // The counters of the exited threads summed up
+
+	// Lives as long as the thread does, its counters are moved to s_finishedThreads on exit
+	struct ThreadRegistration final {
+		ThreadRegistration() {
+			std::lock_guard lock(s_threadsMutex);
+			s_threads.push_back(g_zoneStats);
+		}
+
+		~ThreadRegistration() {
+			std::lock_guard lock(s_threadsMutex);
+			for (u8 zone = 0; zone < ZONES_COUNT; zone++) {
+				s_finishedThreads[zone].cycles += g_zoneStats[zone].cycles;
+				s_finishedThreads[zone].calls += g_zoneStats[zone].calls;
+			}
+
+			s_threads.erase(std::find(s_threads.begin(), s_threads.end(), g_zoneStats));
+		}
+	};
+
+	void registerThread() {
+		thread_local ThreadRegistration registration;
+		g_isThreadRegistered = true;
+	}
+
+	void printZones(const ZoneStats* zones) {
+		for (u8 zone = 0; zone < ZONES_COUNT; zone++) {
+			if (!zones[zone].calls) {
+				continue;
+			}
+
+			io::g_out << '\t' << std::left << std::setw(14) << ZONE_NAMES[zone] << std::right
+				<< io::Color::Blue << std::setw(14) << zones[zone].calls << io::Color::White << " calls"
+				<< io::Color::Blue << std::setw(16) << zones[zone].cycles << io::Color::White << " cycles"
+				<< io::Color::Blue << std::setw(10) << zones[zone].cycles / zones[zone].calls << io::Color::White << " per call" << std::endl;
+		}
+	}
+
+	void print() {
+		if (!PROFILER_ENABLED) {
+			io::g_out << io::Color::Red << "The profiler is not compiled in, rebuild with ENABLE_PROFILER defined" << std::endl;
+			return;
+		}
+
+		std::lock_guard lock(s_threadsMutex);
+
+		// The counters of the other threads are read while they may be running, so the numbers are approximate then
+		ZoneStats total[ZONES_COUNT];
+		std::copy(std::begin(s_finishedThreads), std::end(s_finishedThreads), total);
+
+		for (size_t i = 0; i < s_threads.size(); i++) {
+			io::g_out << "Thread " << i << ":" << std::endl;
+			printZones(s_threads[i]);
+
+			for (u8 zone = 0; zone < ZONES_COUNT; zone++) {
+				total[zone].cycles += s_threads[i][zone].cycles;
+				total[zone].calls += s_threads[i][zone].calls;
+			}
+		}
+
+		io::g_out << "Total:" << std::endl;
+		printZones(total);
+	}
+
+	void reset() {
+		std::lock_guard lock(s_threadsMutex);
+
+		std::fill(std::begin(s_finishedThreads), std::end(s_finishedThreads), ZoneStats());
+		for (ZoneStats* zones : s_threads) {
+			std::fill(zones, zones + ZONES_COUNT, ZoneStats());
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "Types.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/*
+*	Profiler(.h/.cpp) contains the instrumented zones for profiling the hot paths.
+* 
+*	A zone is a scope marked with PROFILE_ZONE(ZONE) that adds the cycles spent in it (by the time stamp
+*	counter) and the call to the counters of the current thread. The zones are inclusive, so e.g. the
+*	pawn structure scan is counted in the evaluation as well. The counters of all the threads are printed
+*	by the console command "profile".
+* 
+*	The zones are only compiled in if ENABLE_PROFILER is defined, in the compiler flags or below.
+*	Otherwise PROFILE_ZONE expands to nothing.
+*/
+
+// #define ENABLE_PROFILER
+
+namespace profiler {
+	enum Zone : u8 {
+		MOVE_GENERATION = 0,
+		MAKE_MOVE,
+		UNMAKE_MOVE,
+		EVAL,
+		PAWN_SCAN,
+		SEE,
+		TT_PROBE,
+		TT_STORE,
+		MOVE_SCORING,
+		MOVE_PICKING,
+		CHECK_INPUT,
+
+		ZONES_COUNT
+	};
+
+	struct ZoneStats final {
+		u64 cycles;
+		u64 calls;
+	};
+
+#ifdef ENABLE_PROFILER
+	constexpr bool PROFILER_ENABLED = true;
+#else
+	constexpr bool PROFILER_ENABLED = false;
+#endif
+
+	extern thread_local ZoneStats g_zoneStats[ZONES_COUNT];
+	extern thread_local bool g_isThreadRegistered;
+
+	// Makes the counters of the current thread visible to print()
+	void registerThread();
+
+	// Prints the counters of each thread that used the zones and their totals
+	void print();
+
+	// Resets the counters of all the threads
+	void reset();
+
+	CM_PURE inline u64 readTimestamp() noexcept {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else // Nanoseconds instead of cycles
+		return u64(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	class ScopedZone final {
+	private:
+		u64 m_start;
+		Zone m_zone;
+
+	public:
+		INLINE explicit ScopedZone(const Zone zone) noexcept : m_zone(zone) {
+			if (!g_isThreadRegistered) {
+				registerThread();
+			}
+
+			m_start = readTimestamp();
+		}
+
+		INLINE ~ScopedZone() noexcept {
+			g_zoneStats[m_zone].cycles += readTimestamp() - m_start;
+			++g_zoneStats[m_zone].calls;
+		}
+	};
+}
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_ZONE(zone) const profiler::ScopedZone _profilerZone(profiler::zone)
+#else
+#define PROFILE_ZONE(zone)
+#endif
@@ -0,0 +1,124 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <atomic>
+#include <utility>
+
+#include "Types.h"
+
+/*
+*	SpscQueue.h contains a lock-free queue for a single producer and a single consumer.
+* 
+*	It is a ring buffer with the head (the next item to pop, only moved by the consumer) and the tail
+*	(the next slot to push to, only moved by the producer), so each side writes just its own counter.
+*	The waiting of an empty or full queue is done with the atomic wait/notify of C++20.
+* 
+*	The consumer may also look through, change and remove the items it has not popped yet, as the producer
+*	does not touch them till they are popped.
+*/
+
+template<class T, u32 Capacity>
+class SpscQueue final {
+	static_assert((Capacity & (Capacity - 1)) == 0, "The capacity must be a power of 2");
+
+private:
+	T m_items[Capacity];
+
+	alignas(64) std::atomic<u32> m_head = 0;
+	alignas(64) std::atomic<u32> m_tail = 0;
+
+public:
+	///  PRODUCER  ///
+
+	// Waits while the queue is full
+	void push(T item) {
+		const u32 tail = m_tail.load(std::memory_order_relaxed);
+		for (u32 head = m_head.load(std::memory_order_acquire); tail - head == Capacity; head = m_head.load(std::memory_order_acquire)) {
+			m_head.wait(head, std::memory_order_acquire);
+		}
+
+		m_items[tail & (Capacity - 1)] = std::move(item);
+		m_tail.store(tail + 1, std::memory_order_release);
+		m_tail.notify_one();
+	}
+
+
+	///  CONSUMER  ///
+
+	CM_PURE bool empty() const noexcept {
+		return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+	}
+
+	// Waits while the queue is empty
+	void wait() const noexcept {
+		const u32 head = m_head.load(std::memory_order_relaxed);
+		for (u32 tail = m_tail.load(std::memory_order_acquire); tail == head; tail = m_tail.load(std::memory_order_acquire)) {
+			m_tail.wait(tail, std::memory_order_acquire);
+		}
+	}
+
+	// The queue must not be empty
+	CM_PURE T& front() noexcept {
+		return m_items[m_head.load(std::memory_order_relaxed) & (Capacity - 1)];
+	}
+
+	// The queue must not be empty
+	void pop() {
+		const u32 head = m_head.load(std::memory_order_relaxed);
+		m_items[head & (Capacity - 1)] = T();
+
+		m_head.store(head + 1, std::memory_order_release);
+		m_head.notify_one();
+	}
+
+	// Calls func(item) for each item in the queue from the front
+	template<class Func>
+	void forEach(Func&& func) {
+		const u32 tail = m_tail.load(std::memory_order_acquire);
+		for (u32 i = m_head.load(std::memory_order_relaxed); i != tail; i++) {
+			func(m_items[i & (Capacity - 1)]);
+		}
+	}
+
+	// Removes the items for which pred(item) is true, the others keep their order
+	// The kept items are moved towards the tail, so the freed slots are given to the producer at once
+	template<class Pred>
+	void removeIf(Pred&& pred) {
+		const u32 head = m_head.load(std::memory_order_relaxed);
+		const u32 tail = m_tail.load(std::memory_order_acquire);
+
+		u32 newHead = tail;
+		for (u32 i = tail; i-- != head; ) {
+			if (!pred(m_items[i & (Capacity - 1)]) && --newHead != i) {
+				m_items[newHead & (Capacity - 1)] = std::move(m_items[i & (Capacity - 1)]);
+			}
+		}
+
+		if (newHead == head) {
+			return;
+		}
+
+		for (u32 i = head; i != newHead; i++) {
+			m_items[i & (Capacity - 1)] = T();
+		}
+
+		m_head.store(newHead, std::memory_order_release);
+		m_head.notify_one();
+	}
+};
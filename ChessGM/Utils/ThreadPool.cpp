@@ -0,0 +1,80 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(const u32 threadsCount) {
+	for (u32 i = 1; i < threadsCount; i++) {
+		m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_wakeUp.notify_all();
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::run(const std::function<void(u32)>& task) {
+	{
+		std::lock_guard lock(m_mutex);
+		m_task = &task;
+		m_working = u32(m_threads.size());
+		++m_generation;
+	}
+
+	m_wakeUp.notify_all();
+	task(0);
+
+	std::unique_lock lock(m_mutex);
+	m_finished.wait(lock, [this]() { return m_working == 0; });
+	m_task = nullptr;
+}
+
+void ThreadPool::workerLoop(const u32 threadId) {
+	u64 generation = 0;
+	while (true) {
+		const std::function<void(u32)>* task;
+		{
+			std::unique_lock lock(m_mutex);
+			m_wakeUp.wait(lock, [&]() { return m_stop || m_generation != generation; });
+			if (m_stop) {
+				return;
+			}
+
+			generation = m_generation;
+			task = m_task;
+		}
+
+		(*task)(threadId);
+
+		{
+			std::lock_guard lock(m_mutex);
+			--m_working;
+		}
+
+		m_finished.notify_one();
+	}
+}
@@ -0,0 +1,66 @@
+/*
+*	ChessGM, a free UCI / Xboard chess engine
+*	Copyright (C) 2023 Ilyin Yegor
+*
+*	ChessGM is free software : you can redistribute it and /or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	ChessGM is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with ChessGM. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+#include "Types.h"
+
+/*
+*	ThreadPool(.h/.cpp) contains a pool of persistent worker threads.
+* 
+*	It is meant for the tasks that are run many times in a row (e.g. computing the evaluation
+*	error while tuning), so that the threads are not created anew for each run.
+*	The calling thread takes part in each run as the thread 0.
+*/
+
+class ThreadPool final {
+private:
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	std::condition_variable m_finished;
+
+	const std::function<void(u32)>* m_task = nullptr;
+	u64 m_generation = 0;
+	u32 m_working = 0;
+	bool m_stop = false;
+
+public:
+	// threadsCount includes the calling thread, so ThreadPool(1) has no workers at all
+	explicit ThreadPool(u32 threadsCount);
+	ThreadPool(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Runs task(threadId) on each of the threads and returns once all of them are done
+	void run(const std::function<void(u32)>& task);
+
+	CM_PURE u32 threadsCount() const noexcept {
+		return u32(m_threads.size()) + 1;
+	}
+
+private:
+	void workerLoop(u32 threadId);
+};
@@ -22,12 +22,21 @@
 #include "Engine/Engine.h"
 #include "Engine/TranspositionTable.h"
 #include "Engine/PawnHashTable.h"
+#include "Engine/KPKBitbase.h"
+#include "Engine/Watchdog.h"
+#include "Engine/Bench.h"
+#include "Engine/Microbench.h"
+#include "Engine/EpdTest.h"
+#include "Engine/BatchAnalysis.h"
+#include "Engine/GameReview.h"
 
 /*
 *	main.cpp contains the main function.
 * 
 *	It does some general initialization, requests the work mode
 *	and starts the engine.
+*	Running it as "ChessGM bench [depth] [threads] [hash]" only runs the bench and exits,
+*	and "ChessGM microbench [csv file] [samples]" does the same for the microbenchmarks.
 * 
 *	Bizzare ideas (just some notes):
 *		1) Dynamic square's "importance" (center, king zone, piece concentration, etc)
@@ -66,17 +75,35 @@
 *	Bugs: -
 */
 
-int main() {
+int main(int argc, char** argv) {
 	BitBoard::init();
 	scores::initScores();
 	engine::TranspositionTable::init();
 	engine::PawnHashTable::init();
+	engine::KPKBitbase::init();
+	engine::Watchdog::init();
 	io::Output::init();
-	io::init();
 
-	engine::run(io::getMode());
+	if (argc > 1 && std::string_view(argv[1]) == "bench") {
+		engine::Bench::print(engine::Bench::parseSettings(std::vector<std::string>(argv + 2, argv + argc)));
+	} else if (argc > 1 && std::string_view(argv[1]) == "smp_bench") {
+		engine::Bench::printScaling(std::vector<std::string>(argv + 2, argv + argc));
+	} else if (argc > 1 && std::string_view(argv[1]) == "microbench") {
+		engine::Microbench::print(std::vector<std::string>(argv + 2, argv + argc));
+	} else if (argc > 2 && std::string_view(argv[1]) == "epdtest") {
+		engine::EpdTest::print(std::vector<std::string>(argv + 2, argv + argc));
+	} else if (argc > 2 && std::string_view(argv[1]) == "batch") {
+		engine::BatchAnalysis::print(std::vector<std::string>(argv + 2, argv + argc));
+	} else if (argc > 2 && std::string_view(argv[1]) == "review") {
+		engine::GameReview::print(std::vector<std::string>(argv + 2, argv + argc));
+	} else {
+		io::init();
+
+		engine::run(io::getMode());
+	}
 	
 	io::Output::destroy();
+	engine::Watchdog::destroy();
 	engine::TranspositionTable::destroy();
 	return 0;
 }
\ No newline at end of file